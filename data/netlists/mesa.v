@@ -0,0 +1,18 @@
+// Os circuitos da mesa (veja Netlist_BuildDemoCircuits()) em Verilog
+// estrutural, com o AND e o OR em um submódulo:
+//   ./main --netlist data/netlists/mesa.v
+module and_or(input a, input b, output y_and, output y_or);
+  and g1 (y_and, a, b);
+  or  g2 (y_or, a, b);
+endmodule
+
+module mesa(in, lamp);
+  input  [5:0] in;  // fio, NOT, AND (2) e OR (2), do bit 5 ao 0
+  output [3:0] lamp;
+  wire unused_or, unused_and;
+
+  assign lamp[3] = in[5];
+  not g_not (lamp[2], in[4]);
+  and_or u_and (.a(in[3]), .b(in[2]), .y_and(lamp[1]), .y_or(unused_or));
+  and_or u_or  (in[1], in[0], unused_and, lamp[0]);
+endmodule
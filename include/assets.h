@@ -0,0 +1,14 @@
+#ifndef _ASSETS_H
+#define _ASSETS_H
+
+#include "globals.h"
+
+// Registro de assets (modelos ".obj") da cena. Os modelos são apenas
+// registrados na inicialização, e carregados sob demanda na primeira vez que
+// algum objeto deles é referenciado. Arquivos registrados mais de uma vez (mesmo
+// caminho) ou com conteúdo idêntico (mesmo hash) são carregados uma única vez.
+void Assets_RegisterModel(const char* filename, const char* object_name); // Registra o objeto "object_name" contido em "filename", sem carregá-lo
+SceneObject& Assets_GetObject(const char* object_name); // Retorna o objeto, carregando seu modelo caso necessário
+void Assets_ReportUsage(); // Imprime quantas vezes cada asset foi registrado e os assets que nunca foram utilizados
+
+#endif // _ASSETS_H
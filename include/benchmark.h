@@ -0,0 +1,51 @@
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include <glm/vec3.hpp>
+
+// Modo de benchmark: "main --benchmark roteiro.txt".
+//
+// O roteiro define um caminho de câmera determinístico, dividido em
+// segmentos com um número fixo de quadros, e em quais quadros as entradas
+// dos circuitos são trocadas. Durante o benchmark a entrada do usuário é
+// ignorada e o vsync é desligado. Ao final, os tempos de cada quadro são
+// gravados em "<saída>.csv" e o resumo (média, p50, p95, p99 e máximo, além
+// das chamadas OpenGL e das zonas do profiler) em "<saída>.json".
+//
+// Formato do roteiro (uma instrução por linha, '#' inicia comentário):
+//
+//   size   <largura> <altura>                 tamanho da janela (padrão 1280 720)
+//   warmup <quadros>                          quadros iniciais fora das estatísticas (padrão 30)
+//   output <prefixo>                          arquivos de saída (padrão "benchmark")
+//   bezier <quadros>                          curva de Bézier da introdução
+//   orbit  <quadros> <theta0> <theta1> <phi> <distância>
+//                                             câmera look-at girando de theta0 a theta1
+//   free   <quadros> <theta> <phi> <x0> <z0> <x1> <z1>
+//                                             câmera livre andando de (x0,z0) a (x1,z1)
+//   toggle <quadro> <entrada>                 troca uma entrada: wire, not, and1, and2, or1, or2
+//
+// Os segmentos são executados na ordem do arquivo; o quadro de "toggle" é
+// contado desde o início do benchmark (incluindo o aquecimento).
+#define BENCHMARK_BEZIER 0
+#define BENCHMARK_ORBIT  1
+#define BENCHMARK_FREE   2
+
+// Estado da câmera em um quadro do benchmark.
+struct BenchmarkCamera
+{
+    int       mode;      // BENCHMARK_BEZIER, BENCHMARK_ORBIT ou BENCHMARK_FREE
+    float     bezier_t;  // Parâmetro da curva de Bézier, em [0,1]
+    float     theta;     // Ângulos e distância da câmera (g_CameraTheta, ...)
+    float     phi;
+    float     distance;
+    glm::vec3 movement;  // Deslocamento da câmera livre
+};
+
+bool Benchmark_Load(const char* filename); // Lê o roteiro; false em caso de erro (já impresso)
+bool Benchmark_IsRunning();
+void Benchmark_WindowSize(int* width, int* height);
+void Benchmark_BeginFrame(BenchmarkCamera* camera); // Câmera do quadro atual; aplica as trocas de entradas agendadas
+bool Benchmark_EndFrame(); // Após glfwSwapBuffers(); retorna false quando o roteiro termina
+void Benchmark_WriteReport(); // Grava os arquivos de saída
+
+#endif // _BENCHMARK_H
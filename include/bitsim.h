@@ -0,0 +1,72 @@
+#ifndef _BITSIM_H
+#define _BITSIM_H
+
+#include "netlist.h"
+
+// Simulação bit-paralela: avalia o mesmo netlist para 64 ou 256 vetores de
+// entrada independentes de uma só vez, para tabelas-verdade exaustivas e
+// testes com vetores aleatórios.
+//
+// Cada net guarda um bit por vetor ("lane"): um uint64_t para 64 vetores, ou
+// quatro para 256. Cada porta vira então uma única operação bit a bit (AND,
+// OR ou XOR, seguida de uma inversão opcional) sobre palavras inteiras, e as
+// portas são avaliadas em ordem de nível (veja Netlist_Levelize()), sem
+// filas de eventos. Com 256 vetores, se o processador suporta AVX2 (testado
+// em tempo de execução), cada operação usa um registrador de 256 bits.
+//
+// A simulação não altera Netlist::net_value.
+#define BITSIM_AND 0
+#define BITSIM_OR  1
+#define BITSIM_XOR 2
+
+struct BitSimulator
+{
+    const Netlist* netlist;
+    int  width;  // Vetores simulados: 64 ou 256
+    int  words;  // uint64_t por net: width / 64
+    bool avx2;   // Avalia com AVX2 (só com width == 256)
+
+    // Portas na ordem de avaliação, com as listas de entrada copiadas na
+    // mesma ordem para que a avaliação percorra memória sequencial.
+    std::vector<uint8_t>  op;          // BITSIM_AND, BITSIM_OR ou BITSIM_XOR
+    std::vector<uint8_t>  invert;      // 1 se a saída é invertida (NOT, NAND, NOR, XNOR)
+    std::vector<uint32_t> output;      // Net dirigida pela porta
+    std::vector<uint32_t> input_begin; // CSR: entradas da porta "i" em "inputs"
+    std::vector<uint32_t> inputs;
+
+    std::vector<uint64_t> values; // "words" palavras por net
+
+    // Estatísticas acumuladas por BitSim_Run()
+    uint64_t runs;
+    double   seconds;
+};
+
+bool BitSim_HasAVX2();
+
+// Prepara a simulação de "width" (64 ou 256) vetores. Retorna false se o
+// netlist tem laços (erro já impresso).
+bool BitSim_Init(BitSimulator* sim, const Netlist* netlist, int width);
+
+// Bits da entrada "input" (índice em Netlist::inputs), um por vetor:
+// "words" palavras, o vetor "k" no bit k % 64 da palavra k / 64.
+void BitSim_SetInput(BitSimulator* sim, int input, const uint64_t* lanes);
+
+// Enumera a tabela-verdade: o vetor "k" recebe as entradas dadas pelos bits
+// do número "first + k" (a entrada "i" é o bit "i"). Com N entradas, 2^N
+// vetores cobrem todas as combinações, a partir de first = 0 e avançando
+// "width" por execução.
+void BitSim_SetCountingInputs(BitSimulator* sim, uint64_t first);
+
+void BitSim_Run(BitSimulator* sim);
+
+inline const uint64_t* BitSim_GetNet(const BitSimulator* sim, uint32_t net) { return sim->values.data() + (size_t)net * sim->words; }
+inline bool BitSim_GetLane(const BitSimulator* sim, uint32_t net, int lane) { return (BitSim_GetNet(sim, net)[lane / 64] >> (lane % 64)) & 1; }
+
+// Mede a vazão em avaliações de portas por segundo (cada operação sobre uma
+// palavra conta uma avaliação por vetor) com 64 e 256 vetores aleatórios, e
+// confere a simulação com os valores atuais de Netlist::net_value, que
+// devem ser o resultado de uma simulação completa. Utilizada por
+// Simulator_Benchmark().
+void BitSim_Benchmark(const Netlist* netlist);
+
+#endif // _BITSIM_H
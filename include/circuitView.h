@@ -0,0 +1,72 @@
+#ifndef _CIRCUIT_VIEW_H
+#define _CIRCUIT_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "netlist.h"
+#include "simulator.h"
+
+// Estado de desenho dos circuitos da mesa: o que cada lâmpada e cada display
+// mostra, guardado separadamente dos valores das nets.
+//
+// Cada atributo da cena (uma lâmpada, ligada a uma saída primária, ou o
+// dígito de um display, ligado a uma entrada primária) é associado à sua net.
+// A cada quadro, CircuitView_Update() percorre somente as nets que a
+// simulação marcou como alteradas (Simulator::dirty) e, por elas, os
+// atributos que realmente mudaram de valor, que formam a lista "changed".
+// Quem desenha envia à GPU só esses atributos (veja UpdateCircuitUniforms()
+// em "objects.cpp"): um clique custa proporcionalmente ao que mudou, e não
+// ao tamanho do circuito nem ao número de lâmpadas.
+#define CIRCUITVIEW_LAMP  0 // Índice em Netlist::outputs (CIRCUIT_*_LAMP)
+#define CIRCUITVIEW_DIGIT 1 // Índice em Netlist::inputs (CIRCUIT_*_IN*)
+
+#define CIRCUITVIEW_NONE 0xFFFFFFFFu
+
+struct CircuitViewAttribute
+{
+    uint32_t net;
+    uint32_t next;    // Próximo atributo ligado à mesma net, ou CIRCUITVIEW_NONE
+    uint8_t  kind;    // CIRCUITVIEW_LAMP ou CIRCUITVIEW_DIGIT
+    uint8_t  index;   // CIRCUIT_*_LAMP ou CIRCUIT_*_IN*
+    uint8_t  value;   // Valor mostrado
+    uint8_t  queued;  // 1 se o atributo já está em "changed"
+};
+
+struct CircuitView
+{
+    std::vector<CircuitViewAttribute> attributes;
+    std::vector<uint32_t> net_attribute; // Primeiro atributo ligado a cada net, ou CIRCUITVIEW_NONE
+    std::vector<uint32_t> changed;       // Atributos a enviar à GPU
+
+    uint32_t lamp[CIRCUIT_NUM_LAMPS];    // Atributo de cada lâmpada, ou CIRCUITVIEW_NONE
+    uint32_t digit[CIRCUIT_NUM_INPUTS];  // Atributo de cada display, ou CIRCUITVIEW_NONE
+
+    // Estatísticas acumuladas por CircuitView_Update()
+    uint64_t dirty_nets;         // Nets alteradas lidas da simulação
+    uint64_t changed_attributes; // Atributos que mudaram de valor
+};
+
+// Liga as lâmpadas e displays às nets de "netlist" (já simulado; veja
+// Simulator_Init()) e lê seus valores. Todos os atributos ficam em "changed".
+void CircuitView_Init(CircuitView* view, const Netlist* netlist);
+
+// Lê as nets alteradas desde a última chamada e esvazia Simulator::dirty.
+// Retorna o tamanho de "changed".
+size_t CircuitView_Update(CircuitView* view, Simulator* sim);
+
+void CircuitView_MarkAllChanged(CircuitView* view); // Ex: o programa de GPU foi recriado
+void CircuitView_ClearChanged(CircuitView* view); // Após enviar "changed" à GPU
+
+// Valor mostrado por uma lâmpada ou display; os inexistentes valem 0.
+inline bool CircuitView_LampOn(const CircuitView* view, int lamp)
+{
+    return view->lamp[lamp] != CIRCUITVIEW_NONE && view->attributes[view->lamp[lamp]].value;
+}
+inline bool CircuitView_DigitOn(const CircuitView* view, int input)
+{
+    return view->digit[input] != CIRCUITVIEW_NONE && view->attributes[view->digit[input]].value;
+}
+
+#endif // _CIRCUIT_VIEW_H
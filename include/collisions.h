@@ -10,7 +10,7 @@ glm::vec4 SphereCollisionResolution(glm::vec3 point, Sphere sphere);
 glm::vec3 AABBAndSphereResolution(AABB aabb, Sphere sphere);
 bool PointIntersectsSphere(glm::vec3 point, Sphere sphere);
 AABB FindGroupBbox(std::vector<AABB> objects);
-AABB GetWorldAABB(SceneObject obj, glm::mat4 model);
+AABB GetWorldAABB(const SceneObject& obj, const glm::mat4& model);
 glm::vec3 MouseRayCasting(glm::mat4 projectionMatrix, glm::mat4 viewMatrix);
 
 #endif // _COLLISIONS_H
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef _COMPILEDSIM_H
+#define _COMPILEDSIM_H
+
+#include "netlist.h"
+#include "simulator.h"
+
+// Simulação por código compilado: o netlist é traduzido uma única vez para
+// uma sequência linear de instruções, executada inteira a cada
+// CompiledSim_Run(), sem filas de eventos.
+//
+// A compilação ordena as portas por nível (veja Netlist_Levelize()) e
+// renumera as nets na mesma ordem: primeiro as entradas primárias, depois as
+// nets sem porta (constantes 0, clocks e saídas de registradores) e então as
+// saídas das portas, nível a nível.
+// Assim a instrução "i" escreve as nets em ordem crescente e lê nets já
+// calculadas, em geral próximas. Cada instrução tem um opcode e até dois
+// operandos; portas com mais entradas viram uma cadeia de instruções que
+// acumula o resultado na própria net de saída.
+//
+// O interpretador usa "threaded code": ao fim de cada instrução, salta
+// direto para o código da próxima por uma tabela de endereços de rótulos
+// (extensão "labels as values" do GCC e do Clang), sem voltar a um switch
+// central. Em outros compiladores, usa um switch.
+//
+// Como sempre avalia todas as portas, é mais rápida que a simulação dirigida
+// por eventos (veja "simulator.h") quando muitas nets mudam por passo;
+// CompiledSim_Benchmark() mede o ponto em que as duas se igualam.
+#define COMPILEDSIM_BUF   0
+#define COMPILEDSIM_NOT   1
+#define COMPILEDSIM_AND   2
+#define COMPILEDSIM_OR    3
+#define COMPILEDSIM_NAND  4
+#define COMPILEDSIM_NOR   5
+#define COMPILEDSIM_XOR   6
+#define COMPILEDSIM_XNOR  7
+#define COMPILEDSIM_HALT  8
+
+struct CompiledOp
+{
+    uint32_t opcode; // COMPILEDSIM_*
+    uint32_t out;    // Nets, na numeração compilada
+    uint32_t a;
+    uint32_t b;      // Não utilizado por BUF e NOT
+};
+
+struct CompiledSim
+{
+    const Netlist* netlist;
+
+    std::vector<CompiledOp> code;      // Terminada por COMPILEDSIM_HALT
+    std::vector<uint32_t>   net_index; // Net do netlist -> net compilada
+    std::vector<uint8_t>    values;    // Valor de cada net compilada
+
+    // Estatísticas acumuladas por CompiledSim_Run()
+    uint64_t runs;
+    double   seconds;
+};
+
+bool CompiledSim_Compile(CompiledSim* sim, const Netlist* netlist); // false se há laços (erro já impresso)
+void CompiledSim_SetInput(CompiledSim* sim, int input, bool value); // Índice em Netlist::inputs
+void CompiledSim_Run(CompiledSim* sim);
+void CompiledSim_Execute(CompiledSim* sim); // Como CompiledSim_Run(), sem as estatísticas (para laços curtos; veja "cyclesim.h")
+
+inline bool CompiledSim_GetNet(const CompiledSim* sim, uint32_t net) { return sim->values[sim->net_index[net]] != 0; }
+
+// Compara a simulação compilada com a dirigida por eventos "sim", que deve
+// estar estável sobre "netlist", trocando um número crescente de entradas
+// aleatórias por passo, e imprime o tempo por passo de cada uma e a
+// atividade (eventos por passo dividido pelo número de nets; passa de 100%
+// quando nets mudam mais de uma vez no mesmo passo) a partir da qual a
+// compilada é mais rápida. Utilizada por Simulator_Benchmark().
+void CompiledSim_Benchmark(Netlist* netlist, Simulator* sim);
+
+#endif // _COMPILEDSIM_H
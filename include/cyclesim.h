@@ -0,0 +1,71 @@
+#ifndef _CYCLESIM_H
+#define _CYCLESIM_H
+
+#include "compiledsim.h"
+#include "netlist.h"
+#include "simulator.h"
+
+// Simulação por ciclos de circuitos sequenciais (veja os registradores em
+// "netlist.h"). Em vez de propagar eventos, cada borda dos clocks executa a
+// lógica combinacional inteira uma única vez, em ordem de nível, como código
+// compilado (veja "compiledsim.h"), e os registradores são atualizados em
+// bloco entre as execuções:
+//
+//   borda de subida:  os flip-flops da borda amostram "d"; então os clocks
+//                     vão a 1 e as saídas dos flip-flops mudam todas juntas,
+//                     e a lógica é executada;
+//   borda de descida: idem, com os flip-flops da borda de descida.
+//
+// Depois de cada execução, os latches transparentes copiam "d" para "q" e,
+// se algum mudou, a lógica é executada de novo, até tantas vezes quanto
+// latches (além disso, há um laço através dos latches e o ciclo é
+// interrompido).
+//
+// Em circuitos só com flip-flops da borda de subida em que nenhuma porta lê
+// um clock (o caso comum: contadores, registradores de deslocamento e
+// máquinas de estados síncronas), a borda de descida não muda nenhuma outra
+// net e não é executada: um ciclo é uma única passada pela lógica.
+//
+// O estado após cada ciclo é o mesmo de Simulator_Cycle(), que serve de
+// referência em CycleSim_Benchmark(), exceto depois de um ciclo interrompido
+// (as duas simulações param em pontos diferentes da oscilação).
+struct CycleSim
+{
+    CompiledSim compiled; // Lógica combinacional; valores na numeração compilada
+
+    // Clocks e registradores, na numeração compilada
+    std::vector<uint32_t> clocks;
+    std::vector<uint32_t> rising_d, rising_q;   // Flip-flops da borda de subida
+    std::vector<uint32_t> falling_d, falling_q; // Flip-flops da borda de descida
+    std::vector<uint32_t> latch_d, latch_enable, latch_q;
+    std::vector<uint8_t>  latch_active;         // Valor do enable que torna o latch transparente
+    std::vector<uint8_t>  sample;               // Valores de "d" amostrados na borda
+    bool evaluate_falling; // A borda de descida pode mudar alguma net além dos clocks
+    bool inputs_changed;   // Entradas alteradas desde a última execução da lógica
+
+    // Estatísticas acumuladas por CycleSim_Run()
+    uint64_t cycles;
+    uint64_t evaluations; // Execuções da lógica combinacional
+    double   seconds;
+    bool     oscillating; // Algum ciclo foi interrompido por um laço através de latches
+};
+
+// Compila "netlist" e parte das entradas atuais, com os clocks em 0 e os
+// registradores com o valor inicial. Retorna false se o netlist tem um laço
+// combinacional (erro já impresso).
+bool CycleSim_Init(CycleSim* sim, const Netlist* netlist);
+void CycleSim_SetInput(CycleSim* sim, int input, bool value); // Índice em Netlist::inputs; vale a partir do próximo ciclo
+void CycleSim_Run(CycleSim* sim, uint64_t cycles);
+
+inline bool CycleSim_GetNet(const CycleSim* sim, uint32_t net) { return CompiledSim_GetNet(&sim->compiled, net); }
+
+// Confere os primeiros ciclos de "netlist", net a net, contra a simulação
+// dirigida por eventos "sim" (inicializada sobre "netlist"), executa então
+// "cycles" ciclos com a simulação por ciclos e imprime a vazão das duas em
+// ciclos por segundo e os valores das saídas após exatamente "cycles"
+// ciclos a partir do estado inicial. As entradas ficam constantes. Retorna
+// false se o netlist não compila ou se as duas simulações discordam (erro
+// já impresso). Utilizada pela opção "--cycles" (veja main()).
+bool CycleSim_Benchmark(Netlist* netlist, Simulator* sim, uint64_t cycles);
+
+#endif // _CYCLESIM_H
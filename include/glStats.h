@@ -0,0 +1,43 @@
+#ifndef _GL_STATS_H
+#define _GL_STATS_H
+
+// Estatísticas das chamadas OpenGL feitas em cada quadro.
+//
+// Com a opção GL_STATS do CMake (cmake -DGL_STATS=ON), GLStats_Init()
+// substitui alguns ponteiros de função carregados pela GLAD por versões que
+// contam as chamadas antes de repassá-las ao driver. Sem a opção, nada é
+// substituído e as funções abaixo não fazem nada, então as chamadas OpenGL
+// não têm custo adicional.
+//
+// Os contadores não são atômicos: apenas as chamadas da thread principal
+// devem ser contadas (a thread que recompila shaders não usa as funções
+// instrumentadas).
+struct GLStats
+{
+    unsigned long draw_calls;       // glDraw*
+    unsigned long triangles;        // Triângulos enviados pelas chamadas de desenho
+    unsigned long uniform_uploads;  // glUniform*
+    unsigned long buffer_uploads;   // glBufferData e glBufferSubData
+    unsigned long buffer_bytes;     // Bytes enviados por essas chamadas
+    unsigned long texture_binds;    // glBindTexture
+    unsigned long program_switches; // glUseProgram que troca o programa atual
+    unsigned long vao_binds;        // glBindVertexArray
+};
+
+#ifdef GL_STATS
+
+void GLStats_Init(); // Após gladLoadGLLoader()
+void GLStats_EndFrame(); // Após glfwSwapBuffers(): guarda os contadores do quadro e os zera
+const GLStats& GLStats_LastFrame(); // Contadores do último quadro completo
+inline bool GLStats_Enabled() { return true; }
+
+#else
+
+inline void GLStats_Init() {}
+inline void GLStats_EndFrame() {}
+inline const GLStats& GLStats_LastFrame() { static const GLStats zero = GLStats(); return zero; }
+inline bool GLStats_Enabled() { return false; }
+
+#endif // GL_STATS
+
+#endif // _GL_STATS_H
@@ -17,6 +17,22 @@
 
 #include "utils.h"
 #include "matrices.h"
+#include "objLoader.h"
+#include "trace.h"
+#include "netlist.h"
+#include "simulator.h"
+#include "circuitView.h"
+
+// Buffer de leitura sobre bytes que já estão na memória, sem cópia. Permite
+// que a tinyobjloader interprete um arquivo já lido (veja ObjModel).
+struct MemoryStreamBuffer : std::streambuf
+{
+    MemoryStreamBuffer(const char* data, size_t size)
+    {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+};
 
 // Estrutura que representa um modelo geométrico carregado a partir de um
 // arquivo ".obj". Veja https://en.wikipedia.org/wiki/Wavefront_.obj_file .
@@ -28,8 +44,17 @@ struct ObjModel
 
     // Este construtor lê o modelo de um arquivo utilizando a biblioteca tinyobjloader.
     // Veja: https://github.com/syoyo/tinyobjloader
-    ObjModel(const char* filename, const char* basepath = NULL, bool triangulate = true)
+    // Se "fast" == true, o arquivo é lido com ObjLoader_Load() (veja
+    // "objLoader.h"), mais rápido para modelos grandes, mas que ignora materiais.
+    // Se "data" != NULL, o conteúdo do arquivo já está na memória ("size"
+    // bytes) e é interpretado de lá, sem ler o arquivo de novo; "filename"
+    // ainda localiza os arquivos MTL.
+    ObjModel(const char* filename, const char* basepath = NULL, bool triangulate = true, bool fast = false,
+             const char* data = NULL, size_t size = 0)
     {
+        TRACE_SCOPE("ObjModel");
+        Trace_AddFileRead(filename);
+
         printf("Carregando objetos do arquivo \"%s\"...\n", filename);
 
         // Se basepath == NULL, então setamos basepath como o dirname do
@@ -49,7 +74,18 @@ struct ObjModel
 
         std::string warn;
         std::string err;
-        bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, basepath, triangulate);
+        bool ret;
+        if ( fast )
+            ret = ObjLoader_Load(filename, &attrib, &shapes, &err);
+        else if ( data != NULL )
+        {
+            MemoryStreamBuffer buffer(data, size);
+            std::istream stream(&buffer);
+            tinyobj::MaterialFileReader materialReader(basepath ? basepath : "");
+            ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream, &materialReader, triangulate);
+        }
+        else
+            ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, basepath, triangulate);
 
         if (!err.empty())
             fprintf(stderr, "\n%s\n", err.c_str());
@@ -76,6 +112,10 @@ struct ObjModel
     }
 };
 
+// Número máximo de níveis de detalhe (LOD) de um objeto, incluindo a malha
+// original (nível 0). Veja BuildTrianglesAndAddToVirtualScene().
+#define MAX_LODS 4
+
 // Definimos uma estrutura que armazenará dados necessários para renderizar
 // cada objeto da cena virtual.
 struct SceneObject
@@ -87,6 +127,9 @@ struct SceneObject
     GLuint       vertex_array_object_id; // ID do VAO onde estão armazenados os atributos do modelo
     glm::vec3    bbox_min; // Axis-Aligned Bounding Box do objeto
     glm::vec3    bbox_max;
+    int          num_lods; // Número de níveis de detalhe. O nível 0 é a malha original (first_index, num_indices)
+    size_t       lod_first_index[MAX_LODS]; // Primeiro índice de cada nível de detalhe
+    size_t       lod_num_indices[MAX_LODS]; // Número de índices de cada nível de detalhe
 };
 
 /**
@@ -174,6 +217,9 @@ extern bool g_UsePerspectiveProjection;
 // Variável que controla se o texto informativo será mostrado na tela.
 extern bool g_ShowInfoText;
 
+// Variável que controla se o resumo do profiler de CPU será mostrado na tela.
+extern bool g_ShowProfiler;
+
 // Variáveis que definem um programa de GPU (shaders). Veja função LoadShadersFromFiles().
 extern GLuint g_GpuProgramID;
 extern GLint g_model_uniform;
@@ -182,6 +228,13 @@ extern GLint g_projection_uniform;
 extern GLint g_object_id_uniform;
 extern GLint g_bbox_min_uniform;
 extern GLint g_bbox_max_uniform;
+// Matrizes "view" e "projection" do quadro atual, utilizadas para a escolha do
+// nível de detalhe dos objetos. Veja a função SelectLOD().
+extern glm::mat4 g_ViewMatrix;
+extern glm::mat4 g_ProjectionMatrix;
+
+extern GLint g_texture_layer_uniform; // Camada das texturas GL_TEXTURE_2D_ARRAY
+extern GLint g_lamp_uniform[CIRCUIT_NUM_LAMPS]; // u_wireLampOn, u_notLampOn... pelo índice CIRCUIT_*_LAMP
 
 // Número de texturas carregadas pela função LoadTextureImage()
 extern GLuint g_NumLoadedTextures;
@@ -191,13 +244,11 @@ extern GLuint g_NumLoadedTextures;
 // de tempo. Utilizadas no callback CursorPosCallback() abaixo.
 extern double g_LastCursorPosX, g_LastCursorPosY;
 
-// Variáveis que mudam o dígito de cada display
-extern bool andIsInput1Digit0;
-extern bool andIsInput2Digit0;
-extern bool wireIsInputDigit0;
-extern bool notIsInputDigit0;
-extern bool orIsInput1Digit0;
-extern bool orIsInput2Digit0;
+// Circuitos da mesa. As entradas (CIRCUIT_*_IN*) definem o dígito de cada
+// display. Veja "netlist.h".
+extern Netlist g_Circuits;
+extern Simulator g_CircuitSim; // Simulação de g_Circuits; veja "simulator.h"
+extern CircuitView g_CircuitView; // Lâmpadas e displays de g_Circuits; veja "circuitView.h"
 
 // Variáveis de estado para as teclas de movimentação da câmera
 extern bool W_key_pressed;
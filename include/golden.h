@@ -0,0 +1,52 @@
+#ifndef _GOLDEN_H
+#define _GOLDEN_H
+
+#include "benchmark.h"
+
+// Teste de regressão por imagens de referência: "main --golden roteiro.txt".
+//
+// Cada "shot" do roteiro fixa uma pose de câmera e o estado das entradas dos
+// circuitos, renderiza alguns quadros (para que o LOD se estabilize), lê o
+// framebuffer e o compara com a imagem de referência "<referências>/<nome>.png".
+// A comparação é perceptual: a diferença de cada pixel é medida no espaço de
+// cores YIQ, que pondera luminância e crominância como o olho humano, e o
+// shot falha se a fração de pixels acima do limiar passa do máximo permitido.
+// Nas falhas são gravadas a imagem obtida e uma imagem de diferenças (pixels
+// diferentes em vermelho sobre a referência em tons de cinza). O programa
+// termina com código de saída diferente de zero se algum shot falhar.
+//
+// Com "--golden-update", as imagens obtidas substituem as referências.
+// Texturas que não fazem parte do repositório (grandes demais) podem ser
+// trocadas por substitutas pequenas com "texture", para que as referências
+// sejam as mesmas em qualquer máquina.
+// Para resultados reprodutíveis, use "--headless" (veja "window.h").
+//
+// Formato do roteiro (uma instrução por linha, '#' inicia comentário):
+//
+//   size       <largura> <altura>         tamanho da imagem (padrão 640 360)
+//   settle     <quadros>                  quadros renderizados por shot (padrão 3)
+//   tolerance  <limiar> <fração>          limiar por pixel, de 0 a 1, e fração
+//                                         máxima de pixels diferentes nos shots seguintes
+//                                         (padrão 0.1 0.001)
+//   references <diretório>                imagens de referência (padrão: diretório do roteiro)
+//   output     <prefixo>                  imagens das falhas, "<prefixo>_<nome>_actual.png"
+//                                         e "<prefixo>_<nome>_diff.png" (padrão "golden")
+//   texture    <arquivo> <substituta>     carrega a imagem <substituta> (relativa ao
+//                                         diretório do roteiro) no lugar da textura
+//                                         <arquivo>, com o caminho exato usado em main()
+//   inputs     <wire> <not> <and1> <and2> <or1> <or2>
+//                                         estado (0 ou 1) das entradas nos shots seguintes
+//   shot <nome> bezier <t>                ponto da curva de Bézier da introdução
+//   shot <nome> orbit  <theta> <phi> <distância>
+//                                         câmera look-at
+//   shot <nome> free   <theta> <phi> <x> <z>
+//                                         câmera livre deslocada de (x,z)
+bool Golden_Load(const char* filename, bool update); // Lê o roteiro; false em caso de erro (já impresso)
+bool Golden_IsRunning();
+void Golden_WindowSize(int* width, int* height);
+const char* Golden_TexturePath(const char* filename); // Substituta de "filename" no roteiro, ou o próprio "filename"
+void Golden_BeginFrame(BenchmarkCamera* camera); // Câmera do quadro atual; aplica as entradas do shot
+bool Golden_EndFrame(); // Antes da troca de buffers; retorna false quando o roteiro termina
+bool Golden_Finish(); // Imprime o resumo; false se algum shot falhou
+
+#endif // _GOLDEN_H
@@ -0,0 +1,23 @@
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#include <cstddef>
+
+// Arquivo mapeado em memória, somente leitura (mmap() ou MapViewOfFile()).
+// O sistema operacional lê as páginas sob demanda, sem cópias para um
+// buffer intermediário. Utilizado pelos leitores de arquivos grandes (veja
+// "objLoader.h" e "netlistLoader.h").
+struct MappedFile
+{
+    const char* data; // NULL se o arquivo está vazio
+    size_t      size;
+#ifdef _WIN32
+    void*       file;    // HANDLE
+    void*       mapping; // HANDLE
+#endif
+};
+
+bool MappedFile_Open(const char* filename, MappedFile* mapped); // false se o arquivo não pôde ser aberto
+void MappedFile_Close(MappedFile* mapped);
+
+#endif // _MAPPED_FILE_H
@@ -0,0 +1,30 @@
+#ifndef _MESH_SIMPLIFY_H
+#define _MESH_SIMPLIFY_H
+
+#include <vector>
+#include <cstddef>
+
+// Simplificação de malhas de triângulos por colapso de arestas guiado por
+// quádricas de erro (Garland & Heckbert, "Surface Simplification Using Quadric
+// Error Metrics", SIGGRAPH 1997). Cada colapso move um vértice para a posição
+// de um de seus vizinhos (half-edge collapse), de modo que as malhas
+// simplificadas referenciam somente vértices da malha original.
+//
+// "positions" contém 3 floats (x,y,z) por vértice e "triangles" contém 3
+// índices de vértices por triângulo. Para cada alvo em "targets" (número de
+// triângulos, em ordem decrescente) é gerado um nível de detalhe (LOD) em
+// "lods[i]", com 3 índices de vértices por triângulo, e em "sources[i]" o
+// índice do triângulo original do qual cada triângulo restante se originou.
+// Vértices de borda não são movidos, para evitar que a silhueta seja erodida.
+// Se o erro de um colapso ultrapassar "max_error" (distância ao quadrado), a
+// simplificação é interrompida e os alvos restantes recebem a malha atual.
+void SimplifyMeshChain(
+    const std::vector<float>&    positions,
+    const std::vector<unsigned>& triangles,
+    const std::vector<size_t>&   targets,
+    double                       max_error,
+    std::vector< std::vector<unsigned> >* lods,
+    std::vector< std::vector<unsigned> >* sources
+);
+
+#endif // _MESH_SIMPLIFY_H
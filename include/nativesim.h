@@ -0,0 +1,67 @@
+#ifndef _NATIVESIM_H
+#define _NATIVESIM_H
+
+#include <string>
+
+#include "netlist.h"
+#include "compiledsim.h"
+
+// Simulação por código nativo: o netlist é traduzido para C++, compilado
+// pelo compilador do sistema em tempo de execução e carregado com dlopen().
+//
+// O código gerado parte da mesma ordem por níveis e numeração de nets da
+// simulação compilada (veja "compiledsim.h"): cada instrução vira uma linha
+// "v[saída] = v[a] & v[b];" sobre palavras de 64 bits, então, como na
+// simulação bit-paralela (veja "bitsim.h"), cada execução avalia 64 vetores
+// de entrada. A sequência é dividida em blocos de até NATIVESIM_BLOCK_SIZE
+// instruções, cada um uma função sem desvios, chamados em ordem por
+// "netlist_eval()": o tempo de compilação cresce mais que linearmente com o
+// tamanho das funções, e a chamada a cada 128 portas tem custo desprezível.
+// Não há despacho de instruções.
+//
+// As bibliotecas ficam em "native_cache/netlist_<hash>.so", onde o hash
+// cobre as instruções geradas e o número de nets compiladas, a versão do
+// gerador e o comando de compilação; um netlist já compilado é apenas carregado (a compilação leva
+// alguns segundos a cada 10 mil portas). O compilador é o da variável de
+// ambiente CXX, ou "c++".
+//
+// Somente em sistemas POSIX (dlopen); no Windows NativeSim_Build() falha.
+#define NATIVESIM_BLOCK_SIZE 128
+
+// Acima deste número de portas, Simulator_Benchmark() só mede o código
+// nativo com a opção "--sim-native": a compilação levaria minutos.
+#define NATIVESIM_BENCHMARK_MAX_GATES 20000
+
+typedef void (*NativeSimFunction)(uint64_t* values);
+
+struct NativeSim
+{
+    CompiledSim compiled; // Ordem das portas e numeração das nets
+
+    void*             library;
+    NativeSimFunction run;
+    std::string       library_path;
+    bool              cached;          // Biblioteca encontrada no cache
+    double            build_seconds;   // Geração, compilação e carregamento
+
+    std::vector<uint64_t> values; // Um bit por vetor, na numeração compilada
+
+    // Estatísticas acumuladas por NativeSim_Run()
+    uint64_t runs;
+    double   seconds;
+};
+
+bool NativeSim_Build(NativeSim* sim, const Netlist* netlist); // false em caso de erro (já impresso)
+void NativeSim_Release(NativeSim* sim);                       // Descarrega a biblioteca
+void NativeSim_SetInput(NativeSim* sim, int input, uint64_t lanes); // Índice em Netlist::inputs; um bit por vetor
+void NativeSim_Run(NativeSim* sim);
+
+inline uint64_t NativeSim_GetNet(const NativeSim* sim, uint32_t net) { return sim->values[sim->compiled.net_index[net]]; }
+
+// Compila o netlist (ou o carrega do cache), confere o código nativo com a
+// simulação bit-paralela em vetores aleatórios e imprime a vazão das duas e
+// do interpretador da simulação compilada, em avaliações de portas por
+// segundo. Utilizada por Simulator_Benchmark().
+void NativeSim_Benchmark(const Netlist* netlist);
+
+#endif // _NATIVESIM_H
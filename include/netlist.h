@@ -0,0 +1,161 @@
+#ifndef _NETLIST_H
+#define _NETLIST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Representação de circuitos digitais (netlist): portas lógicas ligadas por
+// fios (nets).
+//
+// Os dados ficam em vetores contíguos, um por campo (struct-of-arrays), e
+// portas e nets são identificadas por índices de 32 bits. As listas de
+// tamanho variável (nets de entrada de cada porta e portas que leem cada
+// net, o "fan-out") são guardadas no formato CSR: um vetor com todos os
+// elementos e um vetor de deslocamentos, com uma posição a mais que o número
+// de portas (ou nets), tal que os elementos de "i" vão de begin[i] até
+// begin[i+1]. Assim a simulação percorre memória sequencial, sem ponteiros.
+//
+// Um netlist é construído com Netlist_AddInput(), Netlist_AddNet(),
+// Netlist_AddGate(), Netlist_AddRegister(), Netlist_AddClock() e
+// Netlist_AddOutput(), e depois Netlist_Finalize() monta as listas de
+// fan-out. Após Netlist_Finalize() a estrutura não muda; só os valores das
+// nets (net_value) são alterados.
+//
+// Elementos sequenciais (registradores) ficam fora das portas: a saída "q"
+// de um registrador não tem porta que a dirige (net_driver é NETLIST_NONE),
+// como uma entrada primária. Assim a lógica combinacional continua sem laços
+// e pode ser ordenada por nível (Netlist_Levelize()) mesmo em contadores e
+// máquinas de estados, cujos laços passam pelos registradores. Os clocks são
+// nets sem porta alternadas pela simulação a cada ciclo (veja
+// Simulator_Cycle() e "cyclesim.h"); todos estão em fase.
+#define GATE_BUF  0
+#define GATE_NOT  1
+#define GATE_AND  2
+#define GATE_OR   3
+#define GATE_NAND 4
+#define GATE_NOR  5
+#define GATE_XOR  6
+#define GATE_XNOR 7
+
+#define REG_DFF_RISING  0 // Flip-flop D: "q" recebe "d" na borda de subida de "clock"
+#define REG_DFF_FALLING 1 // Flip-flop D: idem, na borda de descida
+#define REG_LATCH_HIGH  2 // Latch D: "q" segue "d" enquanto o enable ("clock") é 1
+#define REG_LATCH_LOW   3 // Latch D: idem, enquanto o enable é 0
+
+#define NETLIST_NONE 0xFFFFFFFFu // Índice inválido (ex: net sem porta que a dirige)
+
+struct Netlist
+{
+    // Portas
+    std::vector<uint8_t>  gate_type;        // GATE_*
+    std::vector<uint32_t> gate_output;      // Net dirigida pela porta
+    std::vector<uint32_t> gate_input_begin; // CSR: pinos de entrada da porta "i" em gate_inputs
+    std::vector<uint32_t> gate_inputs;      // Nets ligadas aos pinos de entrada
+
+    // Nets
+    std::vector<uint8_t>     net_value;        // 0 ou 1
+    std::vector<uint32_t>    net_driver;       // Porta que dirige a net, ou NETLIST_NONE
+    std::vector<uint32_t>    net_fanout_begin; // CSR: portas que leem a net "i" em net_fanout
+    std::vector<uint32_t>    net_fanout;
+    std::vector<uint32_t>    net_name_offset;  // Nome da net "i": string terminada em '\0' em net_names
+    std::vector<char>        net_names;        // Tabela com os nomes de todas as nets
+
+    // Registradores
+    std::vector<uint8_t>  reg_type;  // REG_*
+    std::vector<uint32_t> reg_d;     // Net de dados
+    std::vector<uint32_t> reg_clock; // Clock (flip-flops, deve estar em "clocks") ou enable (latches)
+    std::vector<uint32_t> reg_q;     // Net de saída
+    std::vector<uint8_t>  reg_init;  // Valor de "q" no início da simulação
+
+    // Entradas e saídas primárias (índices de nets), na ordem em que foram adicionadas
+    std::vector<uint32_t> inputs;
+    std::vector<uint32_t> outputs;
+    std::vector<uint32_t> clocks; // Podem ser também entradas primárias
+};
+
+uint32_t Netlist_AddNet(Netlist* netlist, const char* name);
+uint32_t Netlist_AddInput(Netlist* netlist, const char* name); // Nova net, que é uma entrada primária
+void     Netlist_AddOutput(Netlist* netlist, uint32_t net);
+uint32_t Netlist_AddGate(Netlist* netlist, int type, const uint32_t* inputs, int num_inputs, uint32_t output);
+uint32_t Netlist_AddRegister(Netlist* netlist, int type, uint32_t d, uint32_t clock, uint32_t q, bool init);
+void     Netlist_AddClock(Netlist* netlist, uint32_t net); // Ignora nets que já são clocks
+bool     Netlist_Finalize(Netlist* netlist); // Monta o fan-out; false se o netlist é inválido (erro já impresso)
+uint32_t Netlist_FindNet(const Netlist* netlist, const char* name); // NETLIST_NONE se não existe
+
+// Ordena as portas por nível: o nível de uma porta é 1 + o maior nível das
+// portas que dirigem suas entradas (0 se só lê entradas primárias), então
+// avaliar as portas em "order" garante que as entradas de cada uma já foram
+// calculadas. Se "level_begin" não é NULL, recebe os deslocamentos de cada
+// nível em "order" (CSR). Retorna false se o netlist tem um laço
+// combinacional (erro já impresso).
+bool     Netlist_Levelize(const Netlist* netlist, std::vector<uint32_t>* order, std::vector<uint32_t>* level_begin);
+
+inline uint32_t Netlist_NumGates(const Netlist* netlist) { return (uint32_t)netlist->gate_type.size(); }
+inline uint32_t Netlist_NumNets(const Netlist* netlist)  { return (uint32_t)netlist->net_value.size(); }
+inline uint32_t Netlist_NumRegisters(const Netlist* netlist) { return (uint32_t)netlist->reg_type.size(); }
+inline bool     Netlist_IsLatch(int reg_type) { return reg_type == REG_LATCH_HIGH || reg_type == REG_LATCH_LOW; }
+inline const char* Netlist_NetName(const Netlist* netlist, uint32_t net) { return netlist->net_names.data() + netlist->net_name_offset[net]; }
+
+// Valor da saída da porta "gate" a partir dos valores atuais de suas nets
+// de entrada. Utilizada pelos simuladores (veja "simulator.h").
+inline uint8_t Netlist_EvaluateGate(const Netlist* netlist, uint32_t gate)
+{
+    const uint32_t* in    = netlist->gate_inputs.data() + netlist->gate_input_begin[gate];
+    const uint32_t* end   = netlist->gate_inputs.data() + netlist->gate_input_begin[gate + 1];
+    const uint8_t*  value = netlist->net_value.data();
+
+    uint8_t result;
+    switch ( netlist->gate_type[gate] )
+    {
+        case GATE_BUF:  return value[in[0]];
+        case GATE_NOT:  return value[in[0]] ^ 1;
+        case GATE_AND:
+        case GATE_NAND:
+            result = 1;
+            for (; in != end; ++in)
+                result &= value[*in];
+            return netlist->gate_type[gate] == GATE_AND ? result : result ^ 1;
+        case GATE_OR:
+        case GATE_NOR:
+            result = 0;
+            for (; in != end; ++in)
+                result |= value[*in];
+            return netlist->gate_type[gate] == GATE_OR ? result : result ^ 1;
+        case GATE_XOR:
+        case GATE_XNOR:
+            result = 0;
+            for (; in != end; ++in)
+                result ^= value[*in];
+            return netlist->gate_type[gate] == GATE_XOR ? result : result ^ 1;
+    }
+    return 0;
+}
+
+// Valor das entradas e saídas primárias, pelo índice em "inputs" e "outputs".
+// Índices inexistentes (netlists com menos entradas ou saídas que os
+// circuitos da mesa) valem 0, e alterá-los não tem efeito.
+bool Netlist_GetInput(const Netlist* netlist, int input);
+void Netlist_SetInput(Netlist* netlist, int input, bool value); // Não propaga; veja Simulator_SetInput()
+bool Netlist_GetOutput(const Netlist* netlist, int output);
+
+// Circuitos de demonstração da mesa (fio, NOT, AND e OR), em um único
+// netlist. Os índices abaixo são posições em Netlist::inputs e
+// Netlist::outputs; os nomes das nets são "wire.in", "and.in1", "or.lamp"...
+#define CIRCUIT_WIRE_IN    0
+#define CIRCUIT_NOT_IN     1
+#define CIRCUIT_AND_IN1    2
+#define CIRCUIT_AND_IN2    3
+#define CIRCUIT_OR_IN1     4
+#define CIRCUIT_OR_IN2     5
+#define CIRCUIT_NUM_INPUTS 6
+
+#define CIRCUIT_WIRE_LAMP  0
+#define CIRCUIT_NOT_LAMP   1
+#define CIRCUIT_AND_LAMP   2
+#define CIRCUIT_OR_LAMP    3
+#define CIRCUIT_NUM_LAMPS  4
+
+void Netlist_BuildDemoCircuits(Netlist* netlist);
+
+#endif // _NETLIST_H
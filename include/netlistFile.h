@@ -0,0 +1,120 @@
+#ifndef _NETLIST_FILE_H
+#define _NETLIST_FILE_H
+
+#include <cstdint>
+
+#include "mappedFile.h"
+#include "netlist.h"
+#include "netlistLoader.h"
+
+// Formato binário de netlists (".nlb"), para circuitos grandes demais para
+// serem lidos de texto a cada execução. Os arquivos são gerados pelo
+// conversor "netlistconv" a partir de BLIF ou Verilog (veja
+// "netlistLoader.h"):
+//
+//     netlistconv circuito.blif circuito.nlb
+//
+// O arquivo é um cabeçalho (NetlistFileHeader) seguido dos vetores de um
+// Netlist já finalizado, exatamente como ficam na memória (veja "netlist.h"):
+// tipos, saídas e entradas (CSR) das portas, porta que dirige cada net,
+// fan-out (CSR), a tabela de nomes, as entradas e saídas primárias, os
+// registradores e os clocks. Cada
+// seção começa em um múltiplo de 8 bytes e é preenchida com zeros até o
+// próximo, então o arquivo mapeado em memória pode ser usado diretamente,
+// sem nenhuma decodificação: NetlistFile_Open() confere o cabeçalho e as
+// seções e aponta os campos de NetlistFile para o mapeamento.
+//
+// Os números são gravados na ordem de bytes de quem gerou o arquivo; um
+// arquivo de outra arquitetura é recusado (veja NetlistFileHeader::endian).
+// NetlistFile_Open() sempre confere os índices das seções (deslocamentos
+// CSR crescentes, nets, portas e nomes dentro dos limites, número de
+// entradas das portas), então nem um arquivo corrompido faz os simuladores
+// lerem fora dos vetores. O checksum cobre tudo depois do cabeçalho e
+// detecta também corrupções que mantêm os índices válidos; como lê o arquivo
+// inteiro, só é conferido quando pedido (netlistconv confere o arquivo que
+// acabou de gravar).
+#define NETLISTFILE_MAGIC   "NETLIST"  // 8 bytes, com o '\0'
+#define NETLISTFILE_VERSION 2u         // Incrementar quando o formato mudar (2: registradores e clocks)
+#define NETLISTFILE_ENDIAN  0x01020304u
+
+// Seções, na ordem em que aparecem no arquivo
+#define NETLISTFILE_GATE_TYPE        0  // uint8_t[num_gates]
+#define NETLISTFILE_GATE_OUTPUT      1  // uint32_t[num_gates]
+#define NETLISTFILE_GATE_INPUT_BEGIN 2  // uint32_t[num_gates + 1]
+#define NETLISTFILE_GATE_INPUTS      3  // uint32_t[gate_input_begin[num_gates]]
+#define NETLISTFILE_NET_DRIVER       4  // uint32_t[num_nets]
+#define NETLISTFILE_NET_FANOUT_BEGIN 5  // uint32_t[num_nets + 1]
+#define NETLISTFILE_NET_FANOUT       6  // uint32_t[net_fanout_begin[num_nets]]
+#define NETLISTFILE_NET_NAME_OFFSET  7  // uint32_t[num_nets]
+#define NETLISTFILE_NET_NAMES        8  // char[], strings terminadas em '\0'
+#define NETLISTFILE_INPUTS           9  // uint32_t[]
+#define NETLISTFILE_OUTPUTS          10 // uint32_t[]
+#define NETLISTFILE_REG_TYPE         11 // uint8_t[num_registers]
+#define NETLISTFILE_REG_D            12 // uint32_t[num_registers]
+#define NETLISTFILE_REG_CLOCK        13 // uint32_t[num_registers]
+#define NETLISTFILE_REG_Q            14 // uint32_t[num_registers]
+#define NETLISTFILE_REG_INIT         15 // uint8_t[num_registers]
+#define NETLISTFILE_CLOCKS           16 // uint32_t[]
+#define NETLISTFILE_NUM_SECTIONS     17
+
+struct NetlistFileHeader
+{
+    char     magic[8];  // NETLISTFILE_MAGIC
+    uint32_t version;   // NETLISTFILE_VERSION
+    uint32_t endian;    // NETLISTFILE_ENDIAN, lido na ordem de bytes de quem gravou
+    uint32_t num_gates;
+    uint32_t num_nets;
+    uint64_t checksum;  // De todos os bytes depois do cabeçalho
+    uint64_t section_offset[NETLISTFILE_NUM_SECTIONS]; // Desde o início do arquivo
+    uint64_t section_size[NETLISTFILE_NUM_SECTIONS];   // Em bytes, sem o preenchimento
+};
+
+// Netlist mapeado em memória, somente leitura. Os ponteiros apontam para o
+// mapeamento e valem até NetlistFile_Close().
+struct NetlistFile
+{
+    MappedFile               file;
+    const NetlistFileHeader* header;
+
+    uint32_t num_gates;
+    uint32_t num_nets;
+    uint32_t num_inputs;
+    uint32_t num_outputs;
+    uint32_t num_registers;
+    uint32_t num_clocks;
+
+    const uint8_t*  gate_type;
+    const uint32_t* gate_output;
+    const uint32_t* gate_input_begin;
+    const uint32_t* gate_inputs;
+    const uint32_t* net_driver;
+    const uint32_t* net_fanout_begin;
+    const uint32_t* net_fanout;
+    const uint32_t* net_name_offset;
+    const char*     net_names;
+    const uint32_t* inputs;
+    const uint32_t* outputs;
+    const uint8_t*  reg_type;
+    const uint32_t* reg_d;
+    const uint32_t* reg_clock;
+    const uint32_t* reg_q;
+    const uint8_t*  reg_init;
+    const uint32_t* clocks;
+};
+
+// Grava "netlist", que deve estar finalizado (Netlist_Finalize()).
+bool NetlistFile_Write(const char* filename, const Netlist* netlist);
+
+// Mapeia o arquivo e confere o cabeçalho, os tamanhos e os índices das
+// seções e, se "verify" é true, o checksum. Retorna false em caso de erro
+// (já impresso).
+bool NetlistFile_Open(const char* filename, NetlistFile* nf, bool verify);
+void NetlistFile_Close(NetlistFile* nf);
+
+// Lê o arquivo para um Netlist vazio: cada vetor é copiado de uma vez do
+// mapeamento, sem Netlist_Finalize() nem nenhuma decodificação. O checksum
+// só é conferido se "verify" é true. Chamada por NetlistLoader_Load() para
+// arquivos ".nlb" (sem o checksum).
+bool NetlistFile_Load(const char* filename, Netlist* netlist, NetlistLoadStats* stats, bool verify);
+
+#endif // _NETLIST_FILE_H
@@ -0,0 +1,50 @@
+#ifndef _NETLIST_LOADER_H
+#define _NETLIST_LOADER_H
+
+#include <cstddef>
+
+#include "netlist.h"
+
+// Leitores de netlists em arquivo, para circuitos além dos da mesa (veja
+// "--netlist" em main()). O arquivo é mapeado em memória (veja
+// "mappedFile.h") e lido em uma única passada, sem cópias de linhas; o
+// resultado é acrescentado a um Netlist vazio e finalizado
+// (Netlist_Finalize()).
+//
+// BLIF (".blif"): ".model", ".inputs", ".outputs", ".names" e ".end", com
+// continuação de linha por '\' e comentários com '#'. Cada ".names" (uma
+// soma de produtos) vira uma única porta quando corresponde a BUF, NOT,
+// AND, NAND, OR, NOR, XOR ou XNOR, ou então a uma porta AND por produto e
+// uma OR (NOR, para a cobertura do 0) que os combina. ".latch" vira um
+// registrador (veja "netlist.h"): tipos "re" e "fe" (flip-flops, cujo
+// controle passa a ser um clock), "ah" e "al" (latches transparentes) ou,
+// sem tipo, um flip-flop do clock global "$clock"; ".clock" declara clocks.
+// Somente o primeiro ".model" é lido; ".subckt" e ".gate" não são
+// suportados.
+//
+// Verilog estrutural (".v"): módulos com portas "input", "output" e "wire"
+// (escalares ou vetores "[msb:lsb]"), primitivas and, or, nand, nor, xor,
+// xnor (com qualquer número de entradas), not e buf, "assign" de um sinal
+// ou de sua negação ("~"), constantes 1'b0 e 1'b1, seleção de bit ("x[3]"),
+// concatenação ("{a, b}") e instâncias de outros módulos, com conexões por
+// posição ou por nome (".porta(sinal)"). A hierarquia é achatada a partir do
+// módulo que nenhum outro instancia (o último, se houver vários); as nets
+// internas de uma instância recebem o nome "instância.net". Somente lógica
+// combinacional: blocos "always" (registradores) não são suportados.
+//
+// As constantes 0 e 1 são a net "$const0", sem porta (sempre 0), e sua
+// negação "$const1".
+struct NetlistLoadStats
+{
+    size_t bytes;
+    double seconds;
+};
+
+// Escolhe o formato pela extensão do arquivo: ".blif", ".v" ou o formato
+// binário ".nlb" (veja "netlistFile.h"). Retorna false em caso de erro (já
+// impresso, com o número da linha).
+bool NetlistLoader_Load(const char* filename, Netlist* netlist, NetlistLoadStats* stats);
+bool NetlistLoader_LoadBLIF(const char* filename, Netlist* netlist, NetlistLoadStats* stats);
+bool NetlistLoader_LoadVerilog(const char* filename, Netlist* netlist, NetlistLoadStats* stats);
+
+#endif // _NETLIST_LOADER_H
@@ -0,0 +1,25 @@
+#ifndef _OBJ_LOADER_H
+#define _OBJ_LOADER_H
+
+#include <string>
+#include <vector>
+
+#include <tiny_obj_loader.h>
+
+// Leitor alternativo de arquivos ".obj", para modelos grandes. O arquivo é
+// mapeado em memória e dividido em pedaços alinhados em quebras de linha, os
+// quais são interpretados em paralelo; os resultados são então concatenados
+// nas mesmas estruturas da tinyobjloader utilizadas por ObjModel.
+//
+// São suportados os comandos "v", "vt", "vn", "f" (com índices negativos), "o"
+// e "g". Quadriláteros são divididos na diagonal mais curta, como na
+// tinyobjloader; polígonos maiores são triangulados em leque, o que supõe que
+// sejam convexos. Materiais ("mtllib", "usemtl") e demais comandos são
+// ignorados. Retorna false e preenche "err" em caso de erro.
+bool ObjLoader_Load(const char* filename, tinyobj::attrib_t* attrib, std::vector<tinyobj::shape_t>* shapes, std::string* err);
+
+// Compara a vazão (MB/s) de ObjLoader_Load() com tinyobj::LoadObj() para um
+// arquivo, imprimindo o resultado no terminal.
+void ObjLoader_Benchmark(const char* filename);
+
+#endif // _OBJ_LOADER_H
@@ -3,18 +3,31 @@
 
 #include "globals.h"
 
+// Arquivos dos shaders da cena. Veja LoadShadersFromFiles().
+#define SHADER_VERTEX_FILENAME   "../../src/shader_vertex.glsl"
+#define SHADER_FRAGMENT_FILENAME "../../src/shader_fragment.glsl"
+
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
 void BuildTrianglesAndAddToVirtualScene(ObjModel*); // Constrói representação de um ObjModel como malha de triângulos para renderização
 void ComputeNormals(ObjModel* model); // Computa normais de um ObjModel, caso não existam.
 void LoadShadersFromFiles(); // Carrega os shaders de vértice e fragmento, criando um programa de GPU
+GLuint CreateGpuProgramFromFiles(); // Compila os shaders da cena, retornando o programa ou 0 em caso de erro
+void InstallGpuProgram(GLuint program_id); // Passa a utilizar "program_id" como programa de GPU da cena
+void UpdateCircuitUniforms(); // Envia as lâmpadas dos circuitos que mudaram para o fragment shader
 void LoadTextureImage(const char* filename); // Função que carrega imagens de textura
+void LoadTextureArray(const char** filenames, int count); // Carrega várias imagens como camadas de uma GL_TEXTURE_2D_ARRAY
 void DrawVirtualObject(const char* object_name); // Desenha um objeto armazenado em g_VirtualScene
+void DrawVirtualObjectLOD(const char* object_name, int lod); // Desenha um nível de detalhe de um objeto armazenado em g_VirtualScene
+int SelectLOD(const char* object_name, const glm::mat4& model, int current_lod); // Escolhe o nível de detalhe pelo tamanho projetado do objeto na tela
 GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
 void LoadShader(const char* filename, GLuint shader_id); // Função utilizada pelas duas acima
+std::string ReadShaderFile(const char* filename); // Lê o código GLSL de um arquivo
+bool TryReadShaderFile(const char* filename, std::string* source); // Idem, retornando false em caso de erro
+void CompileShaderSource(const std::string& source, const char* filename, GLuint shader_id); // Compila código GLSL já em memória
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Cria um programa de GPU
 void PrintObjModelInfo(ObjModel*); // Função para debugging
-void buildModel(const char* filename); // Função para carregar um modelo 3DF
+void buildModel(const char* filename, const char* data = NULL, size_t size = 0); // Função para carregar um modelo 3DF ("data": conteúdo já lido, veja ObjModel)
 void reLoadShaders(); // Função para recarregar os shaders
 #endif // _OBJECTS_H
\ No newline at end of file
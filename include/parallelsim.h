@@ -0,0 +1,77 @@
+#ifndef _PARALLELSIM_H
+#define _PARALLELSIM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "netlist.h"
+
+// Simulação completa do netlist (como Simulator_Init()) em várias threads.
+//
+// As portas são ordenadas por nível (veja Netlist_Levelize()): as portas de
+// um mesmo nível só leem nets de níveis anteriores, então podem ser
+// avaliadas em qualquer ordem e em paralelo. Cada nível é dividido em
+// pedaços de PARALLELSIM_CHUNK portas, distribuídos entre as filas das
+// threads; cada thread consome a própria fila e, quando ela esvazia, rouba
+// pedaços do fim das filas das outras ("work stealing"), o que equilibra
+// níveis com portas de custos diferentes. Um nível só começa quando todos os
+// pedaços do anterior terminaram (barreira por nível), e cada net é escrita
+// por uma única porta, então o resultado não depende da divisão entre as
+// threads nem da ordem de execução.
+//
+// Níveis com menos de 2 * PARALLELSIM_CHUNK portas são avaliados pela
+// thread que chamou ParallelSim_Run(), sem sincronização: nesses o custo da
+// barreira superaria o ganho.
+//
+// As threads auxiliares esperam (bloqueadas) entre execuções e, durante uma
+// execução, aguardam trabalho ativamente, cedendo o processador.
+#define PARALLELSIM_CHUNK 256
+
+// Fila de pedaços de uma thread: índice, em "order", da primeira porta do
+// pedaço. O dono retira do início; as outras threads, do fim.
+struct ParallelSimQueue
+{
+    std::mutex           mutex;
+    std::deque<uint32_t> chunks;
+    std::atomic<int>     size; // Consultado sem o mutex, para não disputá-lo com filas vazias
+};
+
+struct ParallelSim
+{
+    Netlist* netlist;
+    int      num_threads; // Incluindo a thread que chama ParallelSim_Run()
+
+    std::vector<uint32_t> order;       // Portas por nível
+    std::vector<uint32_t> level_begin; // CSR: portas do nível "l" em "order"
+
+    std::vector<std::thread>      threads; // num_threads - 1 auxiliares
+    std::deque<ParallelSimQueue>  queues;  // Uma por thread; a 0 é a de ParallelSim_Run()
+    std::atomic<uint32_t>         level_end; // Fim, em "order", do nível atual
+    std::atomic<int>              remaining; // Pedaços do nível atual ainda não concluídos
+    std::atomic<bool>             running;   // Há uma execução em andamento
+    bool                          quit;
+    std::mutex                    mutex;     // Para esperar por "running" ou "quit"
+    std::condition_variable       wake;
+    std::atomic<uint64_t>         steals;    // Pedaços retirados da fila de outra thread
+
+    // Estatísticas acumuladas por ParallelSim_Run()
+    uint64_t runs;
+    double   seconds;
+};
+
+// Prepara a simulação com "num_threads" threads (0: uma por núcleo) e inicia
+// as threads auxiliares. Retorna false se o netlist tem laços (erro já impresso).
+bool ParallelSim_Init(ParallelSim* sim, Netlist* netlist, int num_threads);
+void ParallelSim_Shutdown(ParallelSim* sim); // Termina as threads auxiliares
+void ParallelSim_Run(ParallelSim* sim);       // Avalia todas as portas, atualizando Netlist::net_value
+
+// Simula uma cópia de "netlist", cujos valores devem ser o resultado de uma
+// simulação completa, com 1, 2, 4... até "max_threads" threads (0: uma por
+// núcleo), confere o resultado e imprime o tempo por execução e o ganho
+// sobre uma thread. Utilizada por Simulator_Benchmark().
+void ParallelSim_Benchmark(const Netlist* netlist, int max_threads);
+
+#endif // _PARALLELSIM_H
@@ -0,0 +1,73 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include <cstdint>
+
+// Profiler de CPU dos quadros.
+//
+// Cada PROFILE_ZONE() mede, com resolução de nanossegundos, o intervalo entre
+// sua criação e o fim do escopo (ou a chamada de End()). Ao terminar, a zona
+// é escrita no buffer circular da thread atual: cada thread escreve apenas no
+// seu buffer, sem locks, e os eventos mais antigos são sobrescritos. Assim
+// guardamos os últimos segundos de execução, que podem ser resumidos na tela
+// (média, p99 e máximo de cada zona) ou exportados no formato trace_event do
+// Chrome para encontrar os quadros lentos que a média de fps esconde.
+//
+// Os nomes das zonas devem ser strings literais: apenas o ponteiro é guardado.
+#define PROFILER_BUFFER_EVENTS (1 << 17) // Eventos por thread (potência de 2)
+#define PROFILER_STATS_SECONDS 1.0       // Janela das estatísticas mostradas na tela
+#define PROFILER_DUMP_SECONDS  5.0       // Duração do trace gravado pela tecla F4
+#define GPU_PROFILER_FRAMES    4         // Quadros de atraso na leitura das medições de GPU
+#define GPU_PROFILER_MAX_ZONES 16        // Zonas de GPU por quadro
+
+struct ProfileZone
+{
+    ProfileZone(const char* name);
+    ~ProfileZone() { if ( name ) End(); }
+    void End(); // Termina a zona antes do fim do escopo
+
+    const char* name;
+    uint64_t    start_ns;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+
+// Estatísticas de uma zona nos últimos "seconds" segundos.
+struct ProfileZoneStats
+{
+    const char* name;
+    int         count;
+    double      mean_ms;
+    double      p99_ms;
+    double      max_ms;
+};
+
+// Zonas de GPU.
+//
+// GPU_PROFILE_ZONE() envia ao OpenGL uma consulta GL_TIMESTAMP no início e
+// outra no fim da zona, medindo o tempo que a GPU leva para executar os
+// comandos enviados entre elas (zonas podem ser aninhadas). Os resultados só
+// são lidos GPU_PROFILER_FRAMES quadros depois, quando a GPU já os terminou,
+// para que a CPU nunca espere pela GPU. As zonas lidas entram no buffer
+// circular "GPU", mostrado na tela e exportado junto com as zonas de CPU.
+struct GpuProfileZone
+{
+    GpuProfileZone(const char* name);
+    ~GpuProfileZone() { if ( index >= 0 ) End(); }
+    void End();
+
+    int index; // Zona no quadro atual, ou -1 se as consultas estão desativadas
+};
+
+#define GPU_PROFILE_ZONE(name) GpuProfileZone PROFILE_CONCAT(gpu_profile_zone_, __LINE__)(name)
+
+void Profiler_SetThreadName(const char* name); // Nome da thread atual no trace
+int  Profiler_GetZoneStats(ProfileZoneStats* stats, int max_zones, double seconds); // Zonas da thread atual, na ordem em que começam
+int  Profiler_GetGpuZoneStats(ProfileZoneStats* stats, int max_zones, double seconds); // Zonas de GPU, na ordem em que começam
+bool Profiler_Dump(const char* filename, double seconds); // Grava os últimos "seconds" segundos de todas as threads
+void Profiler_GpuInit(); // Após a criação do contexto OpenGL
+void Profiler_GpuFrameBegin(); // No início de cada quadro: lê as medições de quadros anteriores
+
+#endif // _PROFILER_H
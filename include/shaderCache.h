@@ -0,0 +1,23 @@
+#ifndef _SHADER_CACHE_H
+#define _SHADER_CACHE_H
+
+#include <string>
+#include <glad/glad.h>
+
+// Cache em disco de programas de GPU já linkados (glGetProgramBinary).
+//
+// Cada programa é salvo em "shader_cache/<nome>.bin", junto de um hash do
+// código dos shaders e das strings de fabricante, renderizador e versão do
+// driver. Em execuções seguintes, se o hash coincidir, o programa é carregado
+// com glProgramBinary(), evitando a compilação. Se o driver rejeitar o binário
+// (ex: foi atualizado), o programa é compilado normalmente e o cache refeito.
+//
+// Requer OpenGL 4.1 ou a extensão GL_ARB_get_program_binary; caso contrário,
+// os programas são sempre compilados.
+void ShaderCache_Init(GLADloadproc load); // Chamada após gladLoadGLLoader(), com o mesmo loader
+void ShaderCache_MarkRetrievable(GLuint program_id); // Pede ao driver que mantenha o binário do programa (antes do glLinkProgram)
+GLuint ShaderCache_CreateProgram(const char* name,
+                                 const char* vertex_label,   const std::string& vertex_source,
+                                 const char* fragment_label, const std::string& fragment_source); // Cria programa de GPU, usando o cache se possível
+
+#endif // _SHADER_CACHE_H
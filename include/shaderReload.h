@@ -0,0 +1,21 @@
+#ifndef _SHADER_RELOAD_H
+#define _SHADER_RELOAD_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Recarregamento dos shaders da cena em segundo plano.
+//
+// Uma thread observa os arquivos "src/*.glsl" (inotify no Linux; nos demais
+// sistemas, a data de modificação é verificada periodicamente) e, a cada
+// alteração, outra thread compila e linka o novo programa em um contexto
+// OpenGL compartilhado com a janela principal. O novo programa só substitui o
+// atual, em ShaderReload_Poll(), depois de linkado com sucesso; se houver
+// erro, o programa anterior continua em uso. Assim a renderização não é
+// interrompida enquanto o driver compila os shaders.
+void ShaderReload_Init(GLFWwindow* window); // Cria o contexto compartilhado e inicia as threads
+void ShaderReload_Request(); // Pede uma recompilação (ex: tecla R), sem bloquear
+void ShaderReload_Poll(); // Chamada uma vez por quadro: instala o novo programa, se pronto
+void ShaderReload_Shutdown(); // Encerra as threads, antes de glfwTerminate()
+
+#endif // _SHADER_RELOAD_H
@@ -0,0 +1,87 @@
+#ifndef _SIMULATOR_H
+#define _SIMULATOR_H
+
+#include "netlist.h"
+
+// Simulação lógica dirigida por eventos sobre um netlist (veja "netlist.h").
+//
+// Alterar uma entrada coloca sua net na fila de mudanças; Simulator_Run()
+// então propaga as mudanças em "ondas" (atraso unitário): cada porta do
+// fan-out das nets que mudaram é avaliada uma única vez por onda, com os
+// valores do fim da onda anterior, e as saídas que mudaram formam a fila da
+// próxima onda. A simulação termina quando a fila fica vazia. Só as portas
+// afetadas por uma mudança são avaliadas.
+//
+// Em um circuito sem laços, nenhuma net muda depois de tantas ondas quanto
+// portas no caminho mais longo. Se a fila ainda não está vazia após
+// Netlist_NumGates() + 1 ondas, o circuito tem um laço que oscila (ex: um
+// número ímpar de inversores em anel): a simulação é interrompida e as nets
+// que ainda mudam são listadas.
+//
+// As filas têm capacidade para todas as nets e portas desde
+// Simulator_Init(); a simulação não aloca memória.
+//
+// Registradores (veja "netlist.h"): Simulator_Cycle() executa um ciclo dos
+// clocks, uma borda de subida e uma de descida (Simulator_ClockEdge()). Em
+// cada borda, todos os flip-flops daquela borda amostram "d" de uma vez e só
+// então suas saídas e os clocks mudam, e as mudanças são propagadas como as
+// de entradas. Os latches transparentes copiam "d" para "q" sempre que a
+// lógica estabiliza, e a propagação continua até que nenhum mude (se ainda
+// mudam após tantas passadas quanto latches, há um laço através de latches e
+// a simulação é interrompida como em uma oscilação). Para simular muitos
+// ciclos, veja a simulação por ciclos em "cyclesim.h".
+//
+// Toda net cujo valor muda (entradas, clocks e saídas de portas e de
+// registradores) é acrescentada, uma única vez, a "dirty", até que
+// Simulator_ClearDirty() seja chamada. Quem mostra os valores das nets (veja
+// "circuitView.h") lê somente essas nets, e não o circuito inteiro, a cada
+// quadro.
+struct Simulator
+{
+    Netlist* netlist;
+
+    std::vector<uint32_t> changed;      // Nets que mudaram na onda atual
+    std::vector<uint32_t> next_changed; // Nets que mudaram na onda seguinte
+    std::vector<uint32_t> gates;        // Portas a avaliar na onda atual
+    std::vector<uint8_t>  gate_queued;  // 1 se a porta já está em "gates"
+    std::vector<uint8_t>  net_queued;   // 1 se a net já está em "changed" (entradas alteradas entre execuções)
+    std::vector<uint8_t>  new_value;    // Saída avaliada de cada porta de "gates"
+    std::vector<uint32_t> dirty;        // Nets que mudaram desde Simulator_ClearDirty()
+    std::vector<uint8_t>  net_dirty;    // 1 se a net já está em "dirty"
+
+    // Registradores, separados por tipo
+    std::vector<uint32_t> rising_flops;  // Flip-flops da borda de subida
+    std::vector<uint32_t> falling_flops; // Flip-flops da borda de descida
+    std::vector<uint32_t> latches;
+    std::vector<uint8_t>  sample;        // Valores de "d" amostrados na borda
+
+    // Estatísticas acumuladas por Simulator_Run()
+    uint64_t events;      // Mudanças de valor de nets processadas
+    uint64_t evaluations; // Avaliações de portas
+    uint64_t waves;
+    uint64_t cycles;      // Ciclos de clock (bordas de descida)
+    double   seconds;
+    bool     oscillating; // A última execução foi interrompida por oscilação
+};
+
+void     Simulator_Init(Simulator* sim, Netlist* netlist); // Avalia todas as portas uma vez, a partir das entradas atuais e dos valores iniciais dos registradores; "dirty" fica vazia
+void     Simulator_SetInput(Simulator* sim, int input, bool value); // Índice em Netlist::inputs; um clock muda por Simulator_ClockEdge()
+void     Simulator_ToggleInput(Simulator* sim, int input);
+uint64_t Simulator_Run(Simulator* sim); // Propaga as mudanças pendentes; retorna o número de eventos
+void     Simulator_ClockEdge(Simulator* sim, bool level); // Propaga as mudanças pendentes e leva os clocks a "level"
+void     Simulator_Cycle(Simulator* sim); // Bordas de subida e de descida
+bool     Simulator_HasPendingEvents(const Simulator* sim);
+void     Simulator_ClearDirty(Simulator* sim); // Esvazia "dirty", em tempo proporcional ao seu tamanho
+
+// Gera um netlist aleatório sem laços com "num_gates" portas, alterna
+// entradas aleatórias e imprime a vazão da simulação, em eventos por segundo,
+// seguida da vazão da simulação bit-paralela (veja BitSim_Benchmark()), da
+// comparação com a simulação compilada (veja CompiledSim_Benchmark()) e com
+// o código nativo (veja NativeSim_Benchmark(); só até
+// NATIVESIM_BENCHMARK_MAX_GATES portas, a não ser que "native" seja true) e
+// do ganho da simulação paralela com até "max_threads" threads (veja
+// ParallelSim_Benchmark()). Utilizado pela opção "--sim-benchmark" (veja
+// main()).
+void Simulator_Benchmark(uint32_t num_gates, int max_threads, bool native);
+
+#endif // _SIMULATOR_H
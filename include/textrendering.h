@@ -23,5 +23,6 @@ void TextRendering_ShowMouseCoords(GLFWwindow* window);
 void TextRendering_ShowProjection(GLFWwindow* window);
 void TextRendering_ShowFramesPerSecond(GLFWwindow* window);
 void TextRendering_ShowRayCast(GLFWwindow* window);
+void TextRendering_ShowProfiler(GLFWwindow* window);
 
 #endif // _TEXT_RENDERING_H
\ No newline at end of file
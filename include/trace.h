@@ -0,0 +1,34 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+// Linha do tempo da inicialização do programa, exportada no formato
+// "trace_event" do Chrome (abra o arquivo em chrome://tracing ou em
+// https://ui.perfetto.dev). Ativada pela opção "--trace-startup" de main().
+//
+// Cada TRACE_SCOPE() gera um evento com o tempo de relógio (início e duração)
+// e o tempo de CPU gasto pela thread no escopo. Dentro de um escopo,
+// Trace_AddArg() acumula valores (ex: bytes lidos, triângulos construídos) no
+// escopo mais interno aberto na thread atual. Quando o trace está desativado,
+// cada escopo custa apenas a leitura de uma variável.
+void Trace_Begin(const char* filename); // Ativa o trace; os eventos serão escritos em "filename"
+void Trace_End(); // Escreve o arquivo e desativa o trace
+bool Trace_IsEnabled();
+void Trace_SetThreadName(const char* name); // Nome da thread atual mostrado no trace
+void Trace_AddArg(const char* key, double value); // Soma "value" ao argumento "key" do escopo atual
+void Trace_AddArg(const char* key, const char* value); // Define um argumento textual do escopo atual
+void Trace_AddFileRead(const char* filename); // Soma o tamanho do arquivo a "bytes_read" do escopo atual
+
+struct TraceScope
+{
+    TraceScope(const char* name);
+    ~TraceScope();
+
+    bool   active;
+    int    index; // Posição do evento no vetor de eventos
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+#endif // _TRACE_H
@@ -2,6 +2,7 @@
 #define _UTILS_H
 
 #include <cstdio>
+#include <cstddef>
 #include <glad/glad.h>
 
 static GLenum glCheckError_(const char *file, int line)
@@ -28,4 +29,7 @@ static GLenum glCheckError_(const char *file, int line)
 }
 #define glCheckError() glCheckError_(__FILE__, __LINE__)
 
+// Retorna o pico de memória residente (RSS) do processo até o momento, em bytes.
+size_t GetPeakResidentMemory();
+
 #endif // _UTILS_H
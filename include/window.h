@@ -13,4 +13,23 @@ void createWindow(GLFWwindow* window);
 void setCallbacks(GLFWwindow* window);
 void printGPUinfo();
 
+// Modo sem janela ("main --headless"), para máquinas sem monitor nem GPU.
+//
+// Com a opção HEADLESS do CMake (cmake -DHEADLESS=ON, somente Linux), um
+// contexto OpenGL 3.3 core é criado com EGL sem superfície (no Mesa, sem GPU,
+// a renderização é feita em software pelo llvmpipe) e a cena é desenhada em
+// um framebuffer object (FBO) do tamanho pedido. A GLFW não é inicializada:
+// as funções abaixo substituem as chamadas glfw* que o loop de renderização
+// faz sobre a janela, e repassam para a GLFW quando há uma janela de verdade.
+void createHeadlessContext(int width, int height); // No lugar de initializeGLFW() ... setCallbacks()
+bool isHeadless();
+double getTime(); // glfwGetTime(), ou segundos desde createHeadlessContext()
+void getWindowSize(GLFWwindow* window, int* width, int* height);
+void getFramebufferSize(GLFWwindow* window, int* width, int* height);
+bool windowShouldClose(GLFWwindow* window);
+void setWindowShouldClose(GLFWwindow* window);
+void swapBuffers(GLFWwindow* window); // Sem janela, espera a GPU terminar o quadro (glFinish)
+void pollEvents();
+void terminateWindow(); // No lugar de glfwTerminate()
+
 #endif // _WINDOW_H
\ No newline at end of file
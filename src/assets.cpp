@@ -0,0 +1,169 @@
+#include "assets.h"
+#include "objects.h"
+#include "window.h"
+#include "mappedFile.h"
+
+#include <vector>
+#include <cstdint>
+
+// Informações de um arquivo de modelo registrado com Assets_RegisterModel().
+struct Asset
+{
+    std::string              path;         // Caminho do arquivo ".obj"
+    std::vector<std::string> objects;      // Objetos registrados que pertencem a este arquivo
+    bool                     loaded;       // O modelo já foi carregado para a GPU?
+    uint64_t                 content_hash; // Hash FNV-1a do conteúdo do arquivo (válido se loaded == true)
+    size_t                   bytes;        // Tamanho do arquivo em bytes (válido se loaded == true)
+    int                      alias_of;     // Índice do asset de conteúdo idêntico já carregado, ou -1
+    unsigned long            ref_count;    // Número de registros (Assets_RegisterModel()) que apontam para este arquivo
+    double                   load_seconds; // Tempo de carregamento (leitura, normais e envio para a GPU)
+};
+
+static std::vector<Asset>            g_Assets;
+static std::map<std::string, size_t> g_AssetByPath;   // Caminho -> índice em g_Assets
+static std::map<std::string, size_t> g_AssetByObject; // Nome do objeto -> índice em g_Assets
+static std::map<uint64_t, size_t>    g_AssetByHash;   // Hash do conteúdo -> índice em g_Assets
+
+// Calcula o hash FNV-1a (64 bits) de um bloco de memória.
+static uint64_t HashBytes(const char* data, size_t size)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Carrega um asset registrado. Se já existe um asset carregado com o mesmo
+// conteúdo, seus objetos já estão em g_VirtualScene e nada é reconstruído.
+// O arquivo é mapeado em memória uma única vez: o hash e o modelo são
+// calculados a partir dos mesmos bytes.
+static void LoadAsset(size_t index)
+{
+    Asset& asset = g_Assets[index];
+
+    MappedFile file;
+    if ( !MappedFile_Open(asset.path.c_str(), &file) )
+    {
+        fprintf(stderr, "ERROR: Cannot open model file \"%s\".\n", asset.path.c_str());
+        std::exit(EXIT_FAILURE);
+    }
+    asset.content_hash = HashBytes(file.data, file.size);
+    asset.bytes = file.size;
+    asset.loaded = true;
+
+    std::map<uint64_t, size_t>::iterator same = g_AssetByHash.find(asset.content_hash);
+    if ( same != g_AssetByHash.end() )
+    {
+        asset.alias_of = (int)same->second;
+        printf("Modelo \"%s\" tem conteúdo idêntico a \"%s\"; reutilizando.\n",
+               asset.path.c_str(), g_Assets[same->second].path.c_str());
+        MappedFile_Close(&file);
+        return;
+    }
+
+    g_AssetByHash[asset.content_hash] = index;
+
+    double start = getTime();
+    buildModel(asset.path.c_str(), file.data, file.size);
+    asset.load_seconds = getTime() - start;
+    MappedFile_Close(&file);
+}
+
+void Assets_RegisterModel(const char* filename, const char* object_name)
+{
+    size_t index;
+
+    std::map<std::string, size_t>::iterator it = g_AssetByPath.find(filename);
+    if ( it != g_AssetByPath.end() )
+    {
+        index = it->second;
+    }
+    else
+    {
+        Asset asset;
+        asset.path = filename;
+        asset.loaded = false;
+        asset.content_hash = 0;
+        asset.bytes = 0;
+        asset.alias_of = -1;
+        asset.ref_count = 0;
+        asset.load_seconds = 0.0;
+
+        index = g_Assets.size();
+        g_Assets.push_back(asset);
+        g_AssetByPath[filename] = index;
+    }
+    g_Assets[index].ref_count += 1;
+
+    std::map<std::string, size_t>::iterator owner = g_AssetByObject.find(object_name);
+    if ( owner != g_AssetByObject.end() )
+    {
+        if ( owner->second != index )
+            fprintf(stderr, "WARNING: Objeto \"%s\" registrado em \"%s\" e \"%s\"; mantendo o primeiro.\n",
+                    object_name, g_Assets[owner->second].path.c_str(), filename);
+        return;
+    }
+
+    g_AssetByObject[object_name] = index;
+    g_Assets[index].objects.push_back(object_name);
+}
+
+SceneObject& Assets_GetObject(const char* object_name)
+{
+    std::map<std::string, size_t>::iterator it = g_AssetByObject.find(object_name);
+
+    // Objetos que não foram registrados (ex: modelo passado por linha de
+    // comando) são buscados diretamente na cena virtual.
+    if ( it == g_AssetByObject.end() )
+        return g_VirtualScene[object_name];
+
+    Asset& asset = g_Assets[it->second];
+    if ( !asset.loaded )
+    {
+        LoadAsset(it->second);
+
+        if ( g_VirtualScene.find(object_name) == g_VirtualScene.end() )
+        {
+            fprintf(stderr, "ERROR: Objeto \"%s\" não encontrado no arquivo \"%s\".\n", object_name, asset.path.c_str());
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    return g_VirtualScene[object_name];
+}
+
+void Assets_ReportUsage()
+{
+    size_t loaded_bytes = 0;
+    size_t unused = 0;
+    double load_seconds = 0.0;
+
+    printf("Assets registrados:\n");
+    for (size_t i = 0; i < g_Assets.size(); ++i)
+    {
+        const Asset& asset = g_Assets[i];
+
+        if ( !asset.loaded )
+        {
+            printf("  %-50s não utilizado (nunca carregado)\n", asset.path.c_str());
+            unused += 1;
+        }
+        else if ( asset.alias_of >= 0 )
+        {
+            printf("  %-50s %lu referências (conteúdo idêntico a \"%s\")\n",
+                   asset.path.c_str(), asset.ref_count, g_Assets[asset.alias_of].path.c_str());
+        }
+        else
+        {
+            printf("  %-50s %lu referências, %lu KB, %.1f ms\n",
+                   asset.path.c_str(), asset.ref_count, (unsigned long)(asset.bytes / 1024), 1000.0 * asset.load_seconds);
+            loaded_bytes += asset.bytes;
+            load_seconds += asset.load_seconds;
+        }
+    }
+    printf("%lu assets registrados, %lu não utilizados, %lu KB carregados em %.1f ms.\n",
+           (unsigned long)g_Assets.size(), (unsigned long)unused, (unsigned long)(loaded_bytes / 1024), 1000.0 * load_seconds);
+}
@@ -0,0 +1,328 @@
+#include "benchmark.h"
+#include "objects.h"
+#include "glStats.h"
+#include "profiler.h"
+#include "window.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Segmento do caminho de câmera. Os parâmetros seguem a ordem do roteiro.
+struct BenchmarkSegment
+{
+    int   mode;
+    int   frames;
+    float params[6];
+};
+
+struct BenchmarkToggle
+{
+    int frame;
+    int input; // CIRCUIT_*_IN*
+};
+
+struct BenchmarkFrameRecord
+{
+    double        ms;
+    unsigned long draw_calls;
+    unsigned long triangles;
+};
+
+static bool                              g_BenchmarkRunning = false;
+static std::string                       g_BenchmarkScript;
+static std::string                       g_BenchmarkOutput = "benchmark";
+static int                               g_BenchmarkWidth = 1280;
+static int                               g_BenchmarkHeight = 720;
+static int                               g_BenchmarkWarmup = 30;
+static int                               g_BenchmarkTotalFrames = 0;
+static std::vector<BenchmarkSegment>     g_BenchmarkSegments;
+static std::vector<BenchmarkToggle>      g_BenchmarkToggles;
+static std::vector<BenchmarkFrameRecord> g_BenchmarkFrames;
+static int                               g_BenchmarkFrame = 0;  // Quadro atual
+static double                            g_BenchmarkLastTime = 0.0;
+
+static int InputByName(const char* name)
+{
+    if ( strcmp(name, "wire") == 0 ) return CIRCUIT_WIRE_IN;
+    if ( strcmp(name, "not")  == 0 ) return CIRCUIT_NOT_IN;
+    if ( strcmp(name, "and1") == 0 ) return CIRCUIT_AND_IN1;
+    if ( strcmp(name, "and2") == 0 ) return CIRCUIT_AND_IN2;
+    if ( strcmp(name, "or1")  == 0 ) return CIRCUIT_OR_IN1;
+    if ( strcmp(name, "or2")  == 0 ) return CIRCUIT_OR_IN2;
+    return -1;
+}
+
+bool Benchmark_Load(const char* filename)
+{
+    FILE* file = fopen(filename, "r");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot open benchmark script \"%s\".\n", filename);
+        return false;
+    }
+
+    g_BenchmarkScript = filename;
+
+    char line[512];
+    int line_number = 0;
+    bool ok = true;
+    while ( ok && fgets(line, sizeof(line), file) )
+    {
+        line_number += 1;
+
+        char* comment = strchr(line, '#');
+        if ( comment )
+            *comment = '\0';
+
+        char command[32];
+        if ( sscanf(line, "%31s", command) != 1 )
+            continue; // Linha vazia
+
+        BenchmarkSegment segment = BenchmarkSegment();
+        char name[256];
+        int frame;
+        float* p = segment.params;
+
+        if ( strcmp(command, "size") == 0 )
+            ok = sscanf(line, "%*s %d %d", &g_BenchmarkWidth, &g_BenchmarkHeight) == 2 && g_BenchmarkWidth > 0 && g_BenchmarkHeight > 0;
+        else if ( strcmp(command, "warmup") == 0 )
+            ok = sscanf(line, "%*s %d", &g_BenchmarkWarmup) == 1 && g_BenchmarkWarmup >= 0;
+        else if ( strcmp(command, "output") == 0 )
+        {
+            ok = sscanf(line, "%*s %255s", name) == 1;
+            g_BenchmarkOutput = name;
+        }
+        else if ( strcmp(command, "bezier") == 0 )
+        {
+            segment.mode = BENCHMARK_BEZIER;
+            ok = sscanf(line, "%*s %d", &segment.frames) == 1 && segment.frames > 0;
+            g_BenchmarkSegments.push_back(segment);
+        }
+        else if ( strcmp(command, "orbit") == 0 )
+        {
+            segment.mode = BENCHMARK_ORBIT;
+            ok = sscanf(line, "%*s %d %f %f %f %f", &segment.frames, &p[0], &p[1], &p[2], &p[3]) == 5 && segment.frames > 0;
+            g_BenchmarkSegments.push_back(segment);
+        }
+        else if ( strcmp(command, "free") == 0 )
+        {
+            segment.mode = BENCHMARK_FREE;
+            ok = sscanf(line, "%*s %d %f %f %f %f %f %f", &segment.frames, &p[0], &p[1], &p[2], &p[3], &p[4], &p[5]) == 7 && segment.frames > 0;
+            g_BenchmarkSegments.push_back(segment);
+        }
+        else if ( strcmp(command, "toggle") == 0 )
+        {
+            BenchmarkToggle toggle;
+            ok = sscanf(line, "%*s %d %255s", &frame, name) == 2 && frame >= 0;
+            toggle.frame = frame;
+            toggle.input = ok ? InputByName(name) : -1;
+            ok = ok && toggle.input >= 0;
+            g_BenchmarkToggles.push_back(toggle);
+        }
+        else
+            ok = false;
+
+        if ( !ok )
+            fprintf(stderr, "ERROR: %s:%d: invalid benchmark command.\n", filename, line_number);
+    }
+    fclose(file);
+
+    if ( ok && g_BenchmarkSegments.empty() )
+    {
+        fprintf(stderr, "ERROR: %s: benchmark script has no camera segments.\n", filename);
+        ok = false;
+    }
+    if ( !ok )
+        return false;
+
+    for (size_t i = 0; i < g_BenchmarkSegments.size(); ++i)
+        g_BenchmarkTotalFrames += g_BenchmarkSegments[i].frames;
+    g_BenchmarkWarmup = std::min(g_BenchmarkWarmup, g_BenchmarkTotalFrames - 1);
+    g_BenchmarkFrames.reserve(g_BenchmarkTotalFrames);
+
+    printf("Benchmark \"%s\": %d quadros (%d de aquecimento), janela %dx%d.\n",
+           filename, g_BenchmarkTotalFrames, g_BenchmarkWarmup, g_BenchmarkWidth, g_BenchmarkHeight);
+
+    g_BenchmarkRunning = true;
+    return true;
+}
+
+bool Benchmark_IsRunning()
+{
+    return g_BenchmarkRunning;
+}
+
+void Benchmark_WindowSize(int* width, int* height)
+{
+    *width = g_BenchmarkWidth;
+    *height = g_BenchmarkHeight;
+}
+
+void Benchmark_BeginFrame(BenchmarkCamera* camera)
+{
+    if ( g_BenchmarkFrame == 0 )
+        g_BenchmarkLastTime = getTime();
+
+    // Segmento atual e posição (de 0 a 1) dentro dele
+    int first = 0;
+    size_t s = 0;
+    while ( s + 1 < g_BenchmarkSegments.size() && g_BenchmarkFrame >= first + g_BenchmarkSegments[s].frames )
+        first += g_BenchmarkSegments[s++].frames;
+
+    const BenchmarkSegment& segment = g_BenchmarkSegments[s];
+    float u = segment.frames > 1 ? (float)(g_BenchmarkFrame - first) / (segment.frames - 1) : 1.0f;
+    const float* p = segment.params;
+
+    *camera = BenchmarkCamera();
+    camera->mode = segment.mode;
+    switch ( segment.mode )
+    {
+        case BENCHMARK_BEZIER:
+            camera->bezier_t = u;
+            break;
+        case BENCHMARK_ORBIT:
+            camera->theta    = p[0] + u * (p[1] - p[0]);
+            camera->phi      = p[2];
+            camera->distance = p[3];
+            break;
+        case BENCHMARK_FREE:
+            camera->theta    = p[0];
+            camera->phi      = p[1];
+            camera->distance = 3.5f; // Mesma distância definida pela tecla C
+            camera->movement = glm::vec3(p[2] + u * (p[4] - p[2]), 0.0f, p[3] + u * (p[5] - p[3]));
+            break;
+    }
+
+    for (size_t i = 0; i < g_BenchmarkToggles.size(); ++i)
+        if ( g_BenchmarkToggles[i].frame == g_BenchmarkFrame )
+            Simulator_ToggleInput(&g_CircuitSim, g_BenchmarkToggles[i].input);
+}
+
+bool Benchmark_EndFrame()
+{
+    double now = getTime();
+
+    const GLStats& gl = GLStats_LastFrame();
+    BenchmarkFrameRecord record;
+    record.ms = 1000.0 * (now - g_BenchmarkLastTime);
+    record.draw_calls = gl.draw_calls;
+    record.triangles = gl.triangles;
+    g_BenchmarkFrames.push_back(record);
+
+    g_BenchmarkLastTime = now;
+    g_BenchmarkFrame += 1;
+    return g_BenchmarkFrame < g_BenchmarkTotalFrames;
+}
+
+// Percentil pelo método "nearest rank" de um vetor ordenado.
+static double Percentile(const std::vector<double>& sorted, double p)
+{
+    size_t rank = (size_t)(p / 100.0 * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max((size_t)1, rank)) - 1];
+}
+
+// Escreve "s" como string JSON (caminhos no Windows contêm '\\').
+static void WriteJsonString(FILE* file, const char* s)
+{
+    fputc('"', file);
+    for (; *s; ++s)
+    {
+        if ( *s == '"' || *s == '\\' )
+            fputc('\\', file);
+        if ( (unsigned char)*s >= 0x20 )
+            fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+static void WriteZones(FILE* file, const char* key, const ProfileZoneStats* stats, int count)
+{
+    fprintf(file, "  \"%s\": [", key);
+    for (int i = 0; i < count; ++i)
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"count\": %d, \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f}",
+                i > 0 ? "," : "", stats[i].name, stats[i].count, stats[i].mean_ms, stats[i].p99_ms, stats[i].max_ms);
+    fprintf(file, "%s]", count > 0 ? "\n  " : "");
+}
+
+void Benchmark_WriteReport()
+{
+    std::string csv_filename = g_BenchmarkOutput + ".csv";
+    FILE* csv = fopen(csv_filename.c_str(), "w");
+    if ( csv == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write \"%s\".\n", csv_filename.c_str());
+        return;
+    }
+    fprintf(csv, "frame,warmup,ms,draw_calls,triangles\n");
+    for (size_t i = 0; i < g_BenchmarkFrames.size(); ++i)
+        fprintf(csv, "%lu,%d,%.4f,%lu,%lu\n", (unsigned long)i, (int)i < g_BenchmarkWarmup,
+                g_BenchmarkFrames[i].ms, g_BenchmarkFrames[i].draw_calls, g_BenchmarkFrames[i].triangles);
+    fclose(csv);
+
+    // Estatísticas apenas dos quadros após o aquecimento
+    std::vector<double> ms;
+    double sum_ms = 0.0, sum_draws = 0.0, sum_triangles = 0.0;
+    unsigned long max_draws = 0;
+    for (size_t i = g_BenchmarkWarmup; i < g_BenchmarkFrames.size(); ++i)
+    {
+        ms.push_back(g_BenchmarkFrames[i].ms);
+        sum_ms += g_BenchmarkFrames[i].ms;
+        sum_draws += g_BenchmarkFrames[i].draw_calls;
+        sum_triangles += g_BenchmarkFrames[i].triangles;
+        max_draws = std::max(max_draws, g_BenchmarkFrames[i].draw_calls);
+    }
+    if ( ms.empty() )
+    {
+        fprintf(stderr, "WARNING: Benchmark terminou antes do fim do aquecimento.\n");
+        return;
+    }
+    std::sort(ms.begin(), ms.end());
+    double n = (double)ms.size();
+
+    // Zonas do profiler durante os quadros medidos
+    ProfileZoneStats cpu[16], gpu[16];
+    int num_cpu = Profiler_GetZoneStats(cpu, 16, sum_ms / 1000.0);
+    int num_gpu = Profiler_GetGpuZoneStats(gpu, 16, sum_ms / 1000.0);
+
+    std::string json_filename = g_BenchmarkOutput + ".json";
+    FILE* json = fopen(json_filename.c_str(), "w");
+    if ( json == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write \"%s\".\n", json_filename.c_str());
+        return;
+    }
+    fprintf(json, "{\n");
+    fprintf(json, "  \"script\": ");
+    WriteJsonString(json, g_BenchmarkScript.c_str());
+    fprintf(json, ",\n  \"renderer\": ");
+    WriteJsonString(json, (const char*)glGetString(GL_RENDERER));
+    fprintf(json, ",\n  \"gl_version\": ");
+    WriteJsonString(json, (const char*)glGetString(GL_VERSION));
+    fprintf(json, ",\n");
+    fprintf(json, "  \"width\": %d,\n  \"height\": %d,\n", g_BenchmarkWidth, g_BenchmarkHeight);
+    fprintf(json, "  \"frames\": %lu,\n  \"warmup_frames\": %d,\n", (unsigned long)ms.size(), g_BenchmarkWarmup);
+    fprintf(json, "  \"frame_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+            sum_ms / n, Percentile(ms, 50), Percentile(ms, 95), Percentile(ms, 99), ms.back());
+    fprintf(json, "  \"fps\": %.2f,\n", 1000.0 * n / sum_ms);
+    if ( GLStats_Enabled() )
+        fprintf(json, "  \"draw_calls\": {\"mean\": %.1f, \"max\": %lu},\n  \"triangles\": {\"mean\": %.1f},\n",
+                sum_draws / n, max_draws, sum_triangles / n);
+    else
+        fprintf(json, "  \"draw_calls\": null,\n  \"triangles\": null,\n");
+    WriteZones(json, "cpu_zones", cpu, num_cpu);
+    fprintf(json, ",\n");
+    WriteZones(json, "gpu_zones", gpu, num_gpu);
+    fprintf(json, "\n}\n");
+    fclose(json);
+
+    printf("Benchmark: %lu quadros, média %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, máximo %.3f ms.\n",
+           (unsigned long)ms.size(), sum_ms / n, Percentile(ms, 50), Percentile(ms, 95), Percentile(ms, 99), ms.back());
+    if ( GLStats_Enabled() )
+        printf("Benchmark: %.1f chamadas de desenho e %.0f triângulos por quadro.\n", sum_draws / n, sum_triangles / n);
+    else
+        printf("Benchmark: compile com -DGL_STATS=ON para contar as chamadas de desenho.\n");
+    printf("Resultados gravados em \"%s\" e \"%s\".\n", csv_filename.c_str(), json_filename.c_str());
+}
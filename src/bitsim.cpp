@@ -0,0 +1,281 @@
+#include "bitsim.h"
+
+#include <cstdio>
+#include <chrono>
+
+// O caminho AVX2 é compilado com o atributo "target" do GCC/Clang, então o
+// restante do programa não depende de -mavx2 e roda em qualquer processador
+// x86-64; BitSim_HasAVX2() decide em tempo de execução.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BITSIM_AVX2
+#endif
+
+bool BitSim_HasAVX2()
+{
+#ifdef BITSIM_AVX2
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+bool BitSim_Init(BitSimulator* sim, const Netlist* netlist, int width)
+{
+    if ( width != 64 && width != 256 )
+    {
+        fprintf(stderr, "ERROR: Bit-parallel simulation supports 64 or 256 vectors, not %d.\n", width);
+        return false;
+    }
+
+    std::vector<uint32_t> order;
+    if ( !Netlist_Levelize(netlist, &order, NULL) )
+        return false;
+
+    sim->netlist = netlist;
+    sim->width = width;
+    sim->words = width / 64;
+    sim->avx2 = width == 256 && BitSim_HasAVX2();
+    sim->runs = 0;
+    sim->seconds = 0.0;
+
+    // Todas as portas viram "operação + inversão": BUF e NOT são um AND de
+    // uma única entrada.
+    sim->op.resize(order.size());
+    sim->invert.resize(order.size());
+    sim->output.resize(order.size());
+    sim->input_begin.assign(1, 0);
+    sim->input_begin.reserve(order.size() + 1);
+    sim->inputs.clear();
+    sim->inputs.reserve(netlist->gate_inputs.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        uint32_t gate = order[i];
+        switch ( netlist->gate_type[gate] )
+        {
+            case GATE_BUF:  sim->op[i] = BITSIM_AND; sim->invert[i] = 0; break;
+            case GATE_NOT:  sim->op[i] = BITSIM_AND; sim->invert[i] = 1; break;
+            case GATE_AND:  sim->op[i] = BITSIM_AND; sim->invert[i] = 0; break;
+            case GATE_NAND: sim->op[i] = BITSIM_AND; sim->invert[i] = 1; break;
+            case GATE_OR:   sim->op[i] = BITSIM_OR;  sim->invert[i] = 0; break;
+            case GATE_NOR:  sim->op[i] = BITSIM_OR;  sim->invert[i] = 1; break;
+            case GATE_XOR:  sim->op[i] = BITSIM_XOR; sim->invert[i] = 0; break;
+            case GATE_XNOR: sim->op[i] = BITSIM_XOR; sim->invert[i] = 1; break;
+        }
+        sim->output[i] = netlist->gate_output[gate];
+        sim->inputs.insert(sim->inputs.end(),
+                           netlist->gate_inputs.begin() + netlist->gate_input_begin[gate],
+                           netlist->gate_inputs.begin() + netlist->gate_input_begin[gate + 1]);
+        sim->input_begin.push_back((uint32_t)sim->inputs.size());
+    }
+
+    sim->values.assign((size_t)Netlist_NumNets(netlist) * sim->words, 0);
+    return true;
+}
+
+void BitSim_SetInput(BitSimulator* sim, int input, const uint64_t* lanes)
+{
+    uint64_t* value = sim->values.data() + (size_t)sim->netlist->inputs[input] * sim->words;
+    for (int w = 0; w < sim->words; ++w)
+        value[w] = lanes[w];
+}
+
+void BitSim_SetCountingInputs(BitSimulator* sim, uint64_t first)
+{
+    for (size_t i = 0; i < sim->netlist->inputs.size(); ++i)
+    {
+        uint64_t* value = sim->values.data() + (size_t)sim->netlist->inputs[i] * sim->words;
+        for (int w = 0; w < sim->words; ++w)
+            value[w] = 0;
+        if ( i >= 64 )
+            continue; // Só as 64 primeiras entradas variam
+
+        for (int k = 0; k < sim->width; ++k)
+            value[k / 64] |= (((first + k) >> i) & 1) << (k % 64);
+    }
+}
+
+// Avaliação portável, com W palavras de 64 bits por net.
+template <int W>
+static void RunWords(BitSimulator* sim)
+{
+    uint64_t* values = sim->values.data();
+    const uint8_t* op = sim->op.data();
+    const uint8_t* invert = sim->invert.data();
+    const uint32_t* output = sim->output.data();
+    const uint32_t* begin = sim->input_begin.data();
+    const uint32_t* inputs = sim->inputs.data();
+
+    size_t num_gates = sim->op.size();
+    for (size_t g = 0; g < num_gates; ++g)
+    {
+        const uint32_t* in = inputs + begin[g];
+        const uint32_t* end = inputs + begin[g + 1];
+
+        uint64_t r[W];
+        const uint64_t* a = values + (size_t)W * *in++;
+        for (int w = 0; w < W; ++w)
+            r[w] = a[w];
+
+        switch ( op[g] )
+        {
+            case BITSIM_AND:
+                for (; in != end; ++in)
+                    for (int w = 0; w < W; ++w)
+                        r[w] &= values[(size_t)W * *in + w];
+                break;
+            case BITSIM_OR:
+                for (; in != end; ++in)
+                    for (int w = 0; w < W; ++w)
+                        r[w] |= values[(size_t)W * *in + w];
+                break;
+            case BITSIM_XOR:
+                for (; in != end; ++in)
+                    for (int w = 0; w < W; ++w)
+                        r[w] ^= values[(size_t)W * *in + w];
+                break;
+        }
+
+        uint64_t mask = invert[g] ? ~(uint64_t)0 : 0;
+        uint64_t* out = values + (size_t)W * output[g];
+        for (int w = 0; w < W; ++w)
+            out[w] = r[w] ^ mask;
+    }
+}
+
+#ifdef BITSIM_AVX2
+// Mesma avaliação de RunWords<4>(), com uma net por registrador de 256 bits.
+__attribute__((target("avx2")))
+static void RunAVX2(BitSimulator* sim)
+{
+    __m256i* values = (__m256i*)sim->values.data();
+    const uint8_t* op = sim->op.data();
+    const uint8_t* invert = sim->invert.data();
+    const uint32_t* output = sim->output.data();
+    const uint32_t* begin = sim->input_begin.data();
+    const uint32_t* inputs = sim->inputs.data();
+    const __m256i ones = _mm256_set1_epi64x(-1);
+
+    size_t num_gates = sim->op.size();
+    for (size_t g = 0; g < num_gates; ++g)
+    {
+        const uint32_t* in = inputs + begin[g];
+        const uint32_t* end = inputs + begin[g + 1];
+
+        __m256i r = _mm256_loadu_si256(values + *in++);
+        switch ( op[g] )
+        {
+            case BITSIM_AND:
+                for (; in != end; ++in)
+                    r = _mm256_and_si256(r, _mm256_loadu_si256(values + *in));
+                break;
+            case BITSIM_OR:
+                for (; in != end; ++in)
+                    r = _mm256_or_si256(r, _mm256_loadu_si256(values + *in));
+                break;
+            case BITSIM_XOR:
+                for (; in != end; ++in)
+                    r = _mm256_xor_si256(r, _mm256_loadu_si256(values + *in));
+                break;
+        }
+
+        if ( invert[g] )
+            r = _mm256_xor_si256(r, ones);
+        _mm256_storeu_si256(values + output[g], r);
+    }
+}
+#endif
+
+void BitSim_Run(BitSimulator* sim)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+#ifdef BITSIM_AVX2
+    if ( sim->avx2 )
+        RunAVX2(sim);
+    else
+#endif
+    if ( sim->words == 4 )
+        RunWords<4>(sim);
+    else
+        RunWords<1>(sim);
+
+    sim->runs += 1;
+    sim->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Gerador pseudoaleatório (xorshift) dos vetores de entrada.
+static uint64_t NextRandom64(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// Executa a simulação com vetores aleatórios até somar ao menos "min_seconds"
+// e imprime a vazão. Antes, confere com Netlist::net_value: todos os vetores
+// recebem as entradas atuais do netlist e devem reproduzir o valor de todas
+// as nets.
+static bool BenchmarkWidth(const Netlist* netlist, int width, bool avx2, const char* label, double min_seconds)
+{
+    BitSimulator sim;
+    if ( !BitSim_Init(&sim, netlist, width) )
+        return false;
+    sim.avx2 = sim.avx2 && avx2;
+
+    uint64_t lanes[4];
+    for (size_t i = 0; i < netlist->inputs.size(); ++i)
+    {
+        for (int w = 0; w < sim.words; ++w)
+            lanes[w] = Netlist_GetInput(netlist, (int)i) ? ~(uint64_t)0 : 0;
+        BitSim_SetInput(&sim, (int)i, lanes);
+    }
+    BitSim_Run(&sim);
+    for (uint32_t n = 0; n < Netlist_NumNets(netlist); ++n)
+    {
+        for (int k = 0; k < width; ++k)
+        {
+            if ( BitSim_GetLane(&sim, n, k) != (netlist->net_value[n] != 0) )
+            {
+                fprintf(stderr, "ERROR: Bit-parallel simulation (%s) disagrees with the event-driven simulation on net \"%s\".\n",
+                        label, Netlist_NetName(netlist, n));
+                return false;
+            }
+        }
+    }
+
+    uint64_t seed = 88172645463325252ull;
+    sim.runs = 0;
+    sim.seconds = 0.0;
+    while ( sim.seconds < min_seconds )
+    {
+        for (size_t i = 0; i < netlist->inputs.size(); ++i)
+        {
+            for (int w = 0; w < sim.words; ++w)
+                lanes[w] = NextRandom64(&seed);
+            BitSim_SetInput(&sim, (int)i, lanes);
+        }
+        BitSim_Run(&sim);
+    }
+
+    double evaluations = (double)sim.runs * Netlist_NumGates(netlist) * width;
+    printf("  %-18s  %8.3f ms  %6.1f M avaliações/s (tempo por execução, %llu execuções)\n", label,
+           1000.0 * sim.seconds / sim.runs, evaluations / sim.seconds / 1e6, (unsigned long long)sim.runs);
+    return true;
+}
+
+void BitSim_Benchmark(const Netlist* netlist)
+{
+    const double min_seconds = 0.5;
+    if ( !BenchmarkWidth(netlist, 64, false, "bit-paralelo 64", min_seconds) )
+        return;
+    if ( !BenchmarkWidth(netlist, 256, false, "bit-paralelo 256", min_seconds) )
+        return;
+    if ( BitSim_HasAVX2() )
+        BenchmarkWidth(netlist, 256, true, "bit-paralelo AVX2", min_seconds);
+    else
+        printf("  bit-paralelo AVX2   não suportado por este processador\n");
+}
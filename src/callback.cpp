@@ -1,4 +1,6 @@
 #include "callback.h"
+#include "shaderReload.h"
+#include "profiler.h"
 #include <iostream>
 
 
@@ -107,10 +109,24 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
         g_ShowInfoText = !g_ShowInfoText;
     }
 
+    // Se o usuário apertar a tecla F3, fazemos um "toggle" do resumo do profiler de CPU.
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+    {
+        g_ShowProfiler = !g_ShowProfiler;
+    }
+
+    // Se o usuário apertar a tecla F4, gravamos os últimos segundos do
+    // profiler de CPU em um arquivo, para análise em chrome://tracing.
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        Profiler_Dump("frame_trace.json", PROFILER_DUMP_SECONDS);
+    }
+
     // Se o usuário apertar a tecla R, recarregamos os shaders dos arquivos "shader_fragment.glsl" e "shader_vertex.glsl".
+    // A compilação é feita em segundo plano; veja "shaderReload.h".
     if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
-        reLoadShaders();
+        ShaderReload_Request();
     }
 
     // Movimentação da câmera livre
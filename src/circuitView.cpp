@@ -0,0 +1,85 @@
+#include "circuitView.h"
+
+// Acrescenta um atributo ligado a "net" no início da lista da net. Retorna
+// seu índice, ou CIRCUITVIEW_NONE se a net não existe (netlists com menos
+// entradas ou saídas que os circuitos da mesa).
+static uint32_t AddAttribute(CircuitView* view, const Netlist* netlist, const std::vector<uint32_t>& nets, int kind, int index)
+{
+    if ( index >= (int)nets.size() )
+        return CIRCUITVIEW_NONE;
+
+    CircuitViewAttribute attribute;
+    attribute.net = nets[index];
+    attribute.next = view->net_attribute[attribute.net];
+    attribute.kind = (uint8_t)kind;
+    attribute.index = (uint8_t)index;
+    attribute.value = netlist->net_value[attribute.net];
+    attribute.queued = 0;
+
+    uint32_t id = (uint32_t)view->attributes.size();
+    view->net_attribute[attribute.net] = id;
+    view->attributes.push_back(attribute);
+    return id;
+}
+
+void CircuitView_Init(CircuitView* view, const Netlist* netlist)
+{
+    view->attributes.clear();
+    view->changed.clear();
+    view->net_attribute.assign(Netlist_NumNets(netlist), CIRCUITVIEW_NONE);
+    view->dirty_nets = 0;
+    view->changed_attributes = 0;
+
+    for (int i = 0; i < CIRCUIT_NUM_LAMPS; ++i)
+        view->lamp[i] = AddAttribute(view, netlist, netlist->outputs, CIRCUITVIEW_LAMP, i);
+    for (int i = 0; i < CIRCUIT_NUM_INPUTS; ++i)
+        view->digit[i] = AddAttribute(view, netlist, netlist->inputs, CIRCUITVIEW_DIGIT, i);
+
+    CircuitView_MarkAllChanged(view);
+}
+
+size_t CircuitView_Update(CircuitView* view, Simulator* sim)
+{
+    const uint8_t* value = sim->netlist->net_value.data();
+    CircuitViewAttribute* attributes = view->attributes.data();
+
+    for (size_t i = 0; i < sim->dirty.size(); ++i)
+    {
+        // Uma net pode ter mudado e voltado ao valor anterior no mesmo
+        // quadro: só o valor atual é comparado com o mostrado.
+        uint32_t net = sim->dirty[i];
+        for (uint32_t a = view->net_attribute[net]; a != CIRCUITVIEW_NONE; a = attributes[a].next)
+        {
+            if ( attributes[a].value == value[net] )
+                continue;
+            attributes[a].value = value[net];
+            view->changed_attributes += 1;
+            if ( !attributes[a].queued )
+            {
+                attributes[a].queued = 1;
+                view->changed.push_back(a);
+            }
+        }
+    }
+    view->dirty_nets += sim->dirty.size();
+    Simulator_ClearDirty(sim);
+
+    return view->changed.size();
+}
+
+void CircuitView_MarkAllChanged(CircuitView* view)
+{
+    view->changed.clear();
+    for (uint32_t a = 0; a < (uint32_t)view->attributes.size(); ++a)
+    {
+        view->attributes[a].queued = 1;
+        view->changed.push_back(a);
+    }
+}
+
+void CircuitView_ClearChanged(CircuitView* view)
+{
+    for (size_t i = 0; i < view->changed.size(); ++i)
+        view->attributes[view->changed[i]].queued = 0;
+    view->changed.clear();
+}
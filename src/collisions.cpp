@@ -215,7 +215,7 @@ AABB FindGroupBbox(std::vector<AABB> objects)
  * @param model A matriz modelo que representa as transformações geométricas necessárias para o objeto estar em coordenadas de mundo.
  * @return A AABB do objeto em coordenadas de mundo.
  */
-AABB GetWorldAABB(SceneObject obj, glm::mat4 model)
+AABB GetWorldAABB(const SceneObject& obj, const glm::mat4& model)
 {
 
     // Dada uma matriz model, transforma as coordenadas locais da AABB do objeto para coordenadas de mundo.
@@ -0,0 +1,242 @@
+#include "compiledsim.h"
+
+#include <cstdio>
+#include <chrono>
+
+#if defined(__GNUC__)
+#define COMPILEDSIM_THREADED // Endereços de rótulos ("&&rotulo" e "goto *")
+#endif
+
+// Opcode de uma porta de duas entradas; portas de uma entrada são BUF ou NOT.
+static uint32_t OpcodeForGate(int type)
+{
+    switch ( type )
+    {
+        case GATE_AND:  return COMPILEDSIM_AND;
+        case GATE_OR:   return COMPILEDSIM_OR;
+        case GATE_NAND: return COMPILEDSIM_NAND;
+        case GATE_NOR:  return COMPILEDSIM_NOR;
+        case GATE_XOR:  return COMPILEDSIM_XOR;
+        case GATE_XNOR: return COMPILEDSIM_XNOR;
+    }
+    return COMPILEDSIM_BUF;
+}
+
+// Opcode não invertido correspondente, para as instruções intermediárias de
+// uma cadeia (ex: NAND de 3 entradas = AND, depois NAND com a última).
+static uint32_t PositiveOpcode(uint32_t opcode)
+{
+    switch ( opcode )
+    {
+        case COMPILEDSIM_NAND: return COMPILEDSIM_AND;
+        case COMPILEDSIM_NOR:  return COMPILEDSIM_OR;
+        case COMPILEDSIM_XNOR: return COMPILEDSIM_XOR;
+    }
+    return opcode;
+}
+
+static void Emit(CompiledSim* sim, uint32_t opcode, uint32_t out, uint32_t a, uint32_t b)
+{
+    CompiledOp op;
+    op.opcode = opcode;
+    op.out = out;
+    op.a = a;
+    op.b = b;
+    sim->code.push_back(op);
+}
+
+bool CompiledSim_Compile(CompiledSim* sim, const Netlist* netlist)
+{
+    std::vector<uint32_t> order;
+    if ( !Netlist_Levelize(netlist, &order, NULL) )
+        return false;
+
+    uint32_t num_nets = Netlist_NumNets(netlist);
+    sim->netlist = netlist;
+    sim->runs = 0;
+    sim->seconds = 0.0;
+
+    // Renumeração: entradas, nets sem porta e saídas das portas por nível.
+    uint32_t next = 0;
+    sim->net_index.assign(num_nets, NETLIST_NONE);
+    for (size_t i = 0; i < netlist->inputs.size(); ++i)
+        sim->net_index[netlist->inputs[i]] = next++;
+    for (uint32_t n = 0; n < num_nets; ++n)
+        if ( sim->net_index[n] == NETLIST_NONE && netlist->net_driver[n] == NETLIST_NONE )
+            sim->net_index[n] = next++;
+    for (size_t i = 0; i < order.size(); ++i)
+        sim->net_index[netlist->gate_output[order[i]]] = next++;
+
+    sim->code.clear();
+    sim->code.reserve(netlist->gate_inputs.size() + 1);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        uint32_t gate = order[i];
+        const uint32_t* in = netlist->gate_inputs.data() + netlist->gate_input_begin[gate];
+        uint32_t num_inputs = netlist->gate_input_begin[gate + 1] - netlist->gate_input_begin[gate];
+        uint32_t out = sim->net_index[netlist->gate_output[gate]];
+        int type = netlist->gate_type[gate];
+
+        if ( type == GATE_BUF || type == GATE_NOT || num_inputs == 1 )
+        {
+            // Uma única entrada: AND/OR/XOR equivalem a BUF, NAND/NOR/XNOR a NOT.
+            bool inverted = type == GATE_NOT || type == GATE_NAND || type == GATE_NOR || type == GATE_XNOR;
+            Emit(sim, inverted ? COMPILEDSIM_NOT : COMPILEDSIM_BUF, out, sim->net_index[in[0]], 0);
+            continue;
+        }
+
+        uint32_t opcode = OpcodeForGate(type);
+        uint32_t acc = sim->net_index[in[0]];
+        for (uint32_t k = 1; k < num_inputs; ++k)
+        {
+            Emit(sim, k + 1 == num_inputs ? opcode : PositiveOpcode(opcode), out, acc, sim->net_index[in[k]]);
+            acc = out;
+        }
+    }
+    Emit(sim, COMPILEDSIM_HALT, 0, 0, 0);
+
+    sim->values.assign(num_nets, 0);
+    for (size_t i = 0; i < netlist->inputs.size(); ++i)
+        sim->values[sim->net_index[netlist->inputs[i]]] = Netlist_GetInput(netlist, (int)i) ? 1 : 0;
+    return true;
+}
+
+void CompiledSim_SetInput(CompiledSim* sim, int input, bool value)
+{
+    sim->values[sim->net_index[sim->netlist->inputs[input]]] = value ? 1 : 0;
+}
+
+void CompiledSim_Run(CompiledSim* sim)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CompiledSim_Execute(sim);
+    sim->runs += 1;
+    sim->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CompiledSim_Execute(CompiledSim* sim)
+{
+    uint8_t* v = sim->values.data();
+    const CompiledOp* ip = sim->code.data();
+
+#ifdef COMPILEDSIM_THREADED
+    // Na ordem de COMPILEDSIM_*
+    static void* const labels[] = {
+        &&op_buf, &&op_not, &&op_and, &&op_or, &&op_nand, &&op_nor, &&op_xor, &&op_xnor, &&op_halt
+    };
+    #define DISPATCH() goto *labels[ip->opcode]
+    #define NEXT()     do { ++ip; DISPATCH(); } while (0)
+
+    DISPATCH();
+op_buf:  v[ip->out] = v[ip->a];                        NEXT();
+op_not:  v[ip->out] = v[ip->a] ^ 1;                    NEXT();
+op_and:  v[ip->out] = v[ip->a] & v[ip->b];             NEXT();
+op_or:   v[ip->out] = v[ip->a] | v[ip->b];             NEXT();
+op_nand: v[ip->out] = (v[ip->a] & v[ip->b]) ^ 1;       NEXT();
+op_nor:  v[ip->out] = (v[ip->a] | v[ip->b]) ^ 1;       NEXT();
+op_xor:  v[ip->out] = v[ip->a] ^ v[ip->b];             NEXT();
+op_xnor: v[ip->out] = (v[ip->a] ^ v[ip->b]) ^ 1;       NEXT();
+op_halt: return;
+
+    #undef NEXT
+    #undef DISPATCH
+#else
+    for (;; ++ip)
+    {
+        switch ( ip->opcode )
+        {
+            case COMPILEDSIM_BUF:  v[ip->out] = v[ip->a];                  continue;
+            case COMPILEDSIM_NOT:  v[ip->out] = v[ip->a] ^ 1;              continue;
+            case COMPILEDSIM_AND:  v[ip->out] = v[ip->a] & v[ip->b];       continue;
+            case COMPILEDSIM_OR:   v[ip->out] = v[ip->a] | v[ip->b];       continue;
+            case COMPILEDSIM_NAND: v[ip->out] = (v[ip->a] & v[ip->b]) ^ 1; continue;
+            case COMPILEDSIM_NOR:  v[ip->out] = (v[ip->a] | v[ip->b]) ^ 1; continue;
+            case COMPILEDSIM_XOR:  v[ip->out] = v[ip->a] ^ v[ip->b];       continue;
+            case COMPILEDSIM_XNOR: v[ip->out] = (v[ip->a] ^ v[ip->b]) ^ 1; continue;
+        }
+        break; // COMPILEDSIM_HALT
+    }
+#endif
+}
+
+// Gerador pseudoaleatório (xorshift) das entradas trocadas.
+static uint32_t NextRandom(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+void CompiledSim_Benchmark(Netlist* netlist, Simulator* sim)
+{
+    CompiledSim compiled;
+    if ( !CompiledSim_Compile(&compiled, netlist) )
+        return;
+    CompiledSim_Run(&compiled);
+
+    uint32_t num_inputs = (uint32_t)netlist->inputs.size();
+    uint32_t num_nets = Netlist_NumNets(netlist);
+    uint32_t seed = 4242;
+
+    printf("  código compilado: %zu instruções de %zu bytes\n", compiled.code.size(), sizeof(CompiledOp));
+    printf("  %14s  %10s  %12s  %14s\n", "entradas/passo", "atividade", "eventos (ms)", "compilado (ms)");
+
+    double crossover = -1.0;
+    double previous_activity = 0.0;
+    double previous_difference = 0.0;
+    for (uint32_t toggles = 1; ; toggles = toggles * 4 < num_inputs ? toggles * 4 : num_inputs)
+    {
+        // Passos até somar tempo suficiente para uma medida estável.
+        sim->events = 0;
+        sim->seconds = 0.0;
+        compiled.runs = 0;
+        compiled.seconds = 0.0;
+        int steps = 0;
+        while ( steps < 3 || sim->seconds + compiled.seconds < 0.2 )
+        {
+            for (uint32_t t = 0; t < toggles; ++t)
+            {
+                int input = NextRandom(&seed) % num_inputs;
+                Simulator_ToggleInput(sim, input);
+                CompiledSim_SetInput(&compiled, input, Netlist_GetInput(netlist, input));
+            }
+            Simulator_Run(sim);
+            CompiledSim_Run(&compiled);
+            steps += 1;
+        }
+
+        for (uint32_t n = 0; n < num_nets; ++n)
+        {
+            if ( CompiledSim_GetNet(&compiled, n) != (netlist->net_value[n] != 0) )
+            {
+                fprintf(stderr, "ERROR: Compiled simulation disagrees with the event-driven simulation on net \"%s\".\n",
+                        Netlist_NetName(netlist, n));
+                return;
+            }
+        }
+
+        double activity = (double)sim->events / steps / num_nets;
+        double event_ms = 1000.0 * sim->seconds / steps;
+        double compiled_ms = 1000.0 * compiled.seconds / steps;
+        printf("  %14u  %9.4f%%  %12.3f  %14.3f\n", toggles, 100.0 * activity, event_ms, compiled_ms);
+        // Interpola linearmente a diferença de tempo entre as duas últimas
+        // medidas para estimar onde ela se anula.
+        double difference = event_ms - compiled_ms;
+        if ( crossover < 0.0 && difference > 0.0 )
+            crossover = previous_difference < 0.0
+                      ? previous_activity + (activity - previous_activity) * -previous_difference / (difference - previous_difference)
+                      : activity;
+        previous_activity = activity;
+        previous_difference = difference;
+
+        if ( toggles == num_inputs )
+            break;
+    }
+
+    if ( crossover >= 0.0 )
+        printf("  código compilado mais rápido a partir de ~%.2f%% das nets mudando por passo\n", 100.0 * crossover);
+    else
+        printf("  código compilado mais lento em todas as atividades medidas\n");
+}
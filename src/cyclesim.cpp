@@ -0,0 +1,214 @@
+#include "cyclesim.h"
+
+#include <cstdio>
+#include <chrono>
+
+bool CycleSim_Init(CycleSim* sim, const Netlist* netlist)
+{
+    if ( !CompiledSim_Compile(&sim->compiled, netlist) )
+        return false;
+
+    const uint32_t* index = sim->compiled.net_index.data();
+    uint8_t* v = sim->compiled.values.data();
+
+    sim->clocks.clear();
+    sim->rising_d.clear();
+    sim->rising_q.clear();
+    sim->falling_d.clear();
+    sim->falling_q.clear();
+    sim->latch_d.clear();
+    sim->latch_enable.clear();
+    sim->latch_q.clear();
+    sim->latch_active.clear();
+
+    // A borda de descida só precisa ser executada se muda algum registrador
+    // ou se alguma porta lê um clock.
+    sim->evaluate_falling = false;
+    for (size_t i = 0; i < netlist->clocks.size(); ++i)
+    {
+        uint32_t net = netlist->clocks[i];
+        sim->clocks.push_back(index[net]);
+        v[index[net]] = 0;
+        if ( netlist->net_fanout_begin[net + 1] > netlist->net_fanout_begin[net] )
+            sim->evaluate_falling = true;
+    }
+    for (uint32_t r = 0; r < Netlist_NumRegisters(netlist); ++r)
+    {
+        uint32_t d = index[netlist->reg_d[r]];
+        uint32_t q = index[netlist->reg_q[r]];
+        v[q] = netlist->reg_init[r];
+        switch ( netlist->reg_type[r] )
+        {
+            case REG_DFF_RISING:
+                sim->rising_d.push_back(d);
+                sim->rising_q.push_back(q);
+                break;
+            case REG_DFF_FALLING:
+                sim->falling_d.push_back(d);
+                sim->falling_q.push_back(q);
+                break;
+            default:
+                sim->latch_d.push_back(d);
+                sim->latch_enable.push_back(index[netlist->reg_clock[r]]);
+                sim->latch_q.push_back(q);
+                sim->latch_active.push_back(netlist->reg_type[r] == REG_LATCH_HIGH ? 1 : 0);
+                break;
+        }
+    }
+    if ( !sim->falling_q.empty() || !sim->latch_q.empty() )
+        sim->evaluate_falling = true;
+    sim->sample.assign(sim->rising_q.size() > sim->falling_q.size() ? sim->rising_q.size() : sim->falling_q.size(), 0);
+
+    sim->cycles = 0;
+    sim->evaluations = 0;
+    sim->seconds = 0.0;
+    sim->oscillating = false;
+    sim->inputs_changed = true;
+    return true;
+}
+
+void CycleSim_SetInput(CycleSim* sim, int input, bool value)
+{
+    CompiledSim_SetInput(&sim->compiled, input, value);
+    sim->inputs_changed = true;
+}
+
+// Executa a lógica e propaga os latches transparentes até estabilizar.
+static void Settle(CycleSim* sim)
+{
+    CompiledSim_Execute(&sim->compiled);
+    sim->evaluations += 1;
+    sim->inputs_changed = false;
+
+    size_t num_latches = sim->latch_q.size();
+    if ( num_latches == 0 )
+        return;
+    uint8_t* v = sim->compiled.values.data();
+    for (size_t pass = 0; ; ++pass)
+    {
+        bool changed = false;
+        for (size_t i = 0; i < num_latches; ++i)
+        {
+            uint32_t q = sim->latch_q[i];
+            uint32_t d = sim->latch_d[i];
+            if ( v[sim->latch_enable[i]] == sim->latch_active[i] && v[q] != v[d] )
+            {
+                v[q] = v[d];
+                changed = true;
+            }
+        }
+        if ( !changed )
+            return;
+        if ( pass == num_latches )
+        {
+            sim->oscillating = true;
+            return;
+        }
+        CompiledSim_Execute(&sim->compiled);
+        sim->evaluations += 1;
+    }
+}
+
+// Uma borda dos clocks: amostra "d" dos flip-flops da borda, muda os clocks
+// e as saídas em bloco e executa a lógica.
+static void Edge(CycleSim* sim, uint8_t level, const std::vector<uint32_t>& d, const std::vector<uint32_t>& q)
+{
+    uint8_t* v = sim->compiled.values.data();
+    uint8_t* sample = sim->sample.data();
+    size_t num_flops = q.size();
+    for (size_t i = 0; i < num_flops; ++i)
+        sample[i] = v[d[i]];
+    for (size_t i = 0; i < sim->clocks.size(); ++i)
+        v[sim->clocks[i]] = level;
+    for (size_t i = 0; i < num_flops; ++i)
+        v[q[i]] = sample[i];
+    Settle(sim);
+}
+
+void CycleSim_Run(CycleSim* sim, uint64_t cycles)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if ( sim->inputs_changed )
+        Settle(sim);
+    uint8_t* v = sim->compiled.values.data();
+    for (uint64_t c = 0; c < cycles; ++c)
+    {
+        Edge(sim, 1, sim->rising_d, sim->rising_q);
+        if ( sim->evaluate_falling )
+            Edge(sim, 0, sim->falling_d, sim->falling_q);
+        else
+            for (size_t i = 0; i < sim->clocks.size(); ++i)
+                v[sim->clocks[i]] = 0;
+    }
+
+    sim->cycles += cycles;
+    sim->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Primeira net em que as duas simulações discordam, ou NETLIST_NONE.
+static uint32_t FindMismatch(const Netlist* netlist, const CycleSim* sim)
+{
+    for (uint32_t n = 0; n < Netlist_NumNets(netlist); ++n)
+        if ( CycleSim_GetNet(sim, n) != (netlist->net_value[n] != 0) )
+            return n;
+    return NETLIST_NONE;
+}
+
+bool CycleSim_Benchmark(Netlist* netlist, Simulator* sim, uint64_t cycles)
+{
+    CycleSim cycle;
+    if ( !CycleSim_Init(&cycle, netlist) )
+        return false;
+
+    printf("Simulação por ciclos: %u portas, %u registradores, %zu clocks; %s por ciclo.\n",
+           Netlist_NumGates(netlist), Netlist_NumRegisters(netlist), netlist->clocks.size(),
+           cycle.evaluate_falling ? "duas bordas" : "uma borda");
+
+    // Os primeiros ciclos são conferidos contra a simulação dirigida por
+    // eventos, que também dá a vazão de referência.
+    uint64_t check_cycles = cycles < 1000 ? cycles : 1000;
+    CycleSim_Run(&cycle, 0);
+    double event_seconds = 0.0;
+    for (uint64_t c = 0; c <= check_cycles; ++c)
+    {
+        if ( c > 0 )
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            Simulator_Cycle(sim);
+            event_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            CycleSim_Run(&cycle, 1);
+        }
+        if ( cycle.oscillating )
+        {
+            check_cycles = c;
+            break;
+        }
+        uint32_t net = FindMismatch(netlist, &cycle);
+        if ( net != NETLIST_NONE )
+        {
+            fprintf(stderr, "ERROR: Cycle-based simulation disagrees with the event-driven simulation on net \"%s\" after %llu cycles.\n",
+                    Netlist_NetName(netlist, net), (unsigned long long)c);
+            return false;
+        }
+    }
+    if ( check_cycles > 0 )
+        printf("  dirigida por eventos  %llu ciclos conferidos  %10.3f M ciclos/s\n",
+               (unsigned long long)check_cycles, check_cycles / event_seconds / 1e6);
+
+    // A medição parte de novo do estado inicial, para que as saídas
+    // impressas sejam as de exatamente "cycles" ciclos.
+    CycleSim_Init(&cycle, netlist);
+    CycleSim_Run(&cycle, cycles);
+    printf("  por ciclos            %llu ciclos em %.3f s  %10.3f M ciclos/s, %.1f M avaliações de portas/s\n",
+           (unsigned long long)cycles, cycle.seconds, cycles / cycle.seconds / 1e6,
+           (double)cycle.evaluations * Netlist_NumGates(netlist) / cycle.seconds / 1e6);
+    if ( cycle.oscillating )
+        fprintf(stderr, "WARNING: Algum ciclo foi interrompido por um laço através de latches transparentes.\n");
+
+    printf("  saídas:");
+    for (size_t i = 0; i < netlist->outputs.size() && i < 64; ++i)
+        printf(" %s=%d", Netlist_NetName(netlist, netlist->outputs[i]), CycleSim_GetNet(&cycle, netlist->outputs[i]) ? 1 : 0);
+    printf(netlist->outputs.size() > 64 ? " ...\n" : "\n");
+    return true;
+}
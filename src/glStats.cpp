@@ -0,0 +1,144 @@
+#include "glStats.h"
+
+#ifdef GL_STATS
+
+#include <glad/glad.h>
+
+static GLStats g_CurrentFrame = GLStats();
+static GLStats g_LastFrame = GLStats();
+static GLuint  g_CurrentProgram = 0;
+
+// Ponteiros originais carregados pela GLAD.
+static PFNGLDRAWELEMENTSPROC      g_DrawElements;
+static PFNGLDRAWARRAYSPROC        g_DrawArrays;
+static PFNGLUNIFORM1IPROC         g_Uniform1i;
+static PFNGLUNIFORM1FPROC         g_Uniform1f;
+static PFNGLUNIFORM4FPROC         g_Uniform4f;
+static PFNGLUNIFORMMATRIX4FVPROC  g_UniformMatrix4fv;
+static PFNGLBUFFERDATAPROC        g_BufferData;
+static PFNGLBUFFERSUBDATAPROC     g_BufferSubData;
+static PFNGLBINDTEXTUREPROC       g_BindTexture;
+static PFNGLUSEPROGRAMPROC        g_UseProgram;
+static PFNGLBINDVERTEXARRAYPROC   g_BindVertexArray;
+
+static unsigned long Triangles(GLenum mode, GLsizei count)
+{
+    switch ( mode )
+    {
+        case GL_TRIANGLES:      return count / 3;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:   return count > 2 ? count - 2 : 0;
+        default:                return 0;
+    }
+}
+
+static void APIENTRY Stats_DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    g_CurrentFrame.draw_calls += 1;
+    g_CurrentFrame.triangles += Triangles(mode, count);
+    g_DrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY Stats_DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    g_CurrentFrame.draw_calls += 1;
+    g_CurrentFrame.triangles += Triangles(mode, count);
+    g_DrawArrays(mode, first, count);
+}
+
+static void APIENTRY Stats_Uniform1i(GLint location, GLint v0)
+{
+    g_CurrentFrame.uniform_uploads += 1;
+    g_Uniform1i(location, v0);
+}
+
+static void APIENTRY Stats_Uniform1f(GLint location, GLfloat v0)
+{
+    g_CurrentFrame.uniform_uploads += 1;
+    g_Uniform1f(location, v0);
+}
+
+static void APIENTRY Stats_Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    g_CurrentFrame.uniform_uploads += 1;
+    g_Uniform4f(location, v0, v1, v2, v3);
+}
+
+static void APIENTRY Stats_UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    g_CurrentFrame.uniform_uploads += 1;
+    g_UniformMatrix4fv(location, count, transpose, value);
+}
+
+static void APIENTRY Stats_BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    g_CurrentFrame.buffer_uploads += 1;
+    if ( data != NULL )
+        g_CurrentFrame.buffer_bytes += size;
+    g_BufferData(target, size, data, usage);
+}
+
+static void APIENTRY Stats_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    g_CurrentFrame.buffer_uploads += 1;
+    g_CurrentFrame.buffer_bytes += size;
+    g_BufferSubData(target, offset, size, data);
+}
+
+static void APIENTRY Stats_BindTexture(GLenum target, GLuint texture)
+{
+    g_CurrentFrame.texture_binds += 1;
+    g_BindTexture(target, texture);
+}
+
+static void APIENTRY Stats_UseProgram(GLuint program)
+{
+    if ( program != g_CurrentProgram )
+        g_CurrentFrame.program_switches += 1;
+    g_CurrentProgram = program;
+    g_UseProgram(program);
+}
+
+static void APIENTRY Stats_BindVertexArray(GLuint array)
+{
+    g_CurrentFrame.vao_binds += 1;
+    g_BindVertexArray(array);
+}
+
+// Guarda o ponteiro carregado pela GLAD em "original" e o substitui pelo
+// contador, se a função existe.
+template <typename T>
+static void Wrap(T* glad_pointer, T* original, T wrapper)
+{
+    *original = *glad_pointer;
+    if ( *original )
+        *glad_pointer = wrapper;
+}
+
+void GLStats_Init()
+{
+    Wrap(&glad_glDrawElements,     &g_DrawElements,     Stats_DrawElements);
+    Wrap(&glad_glDrawArrays,       &g_DrawArrays,       Stats_DrawArrays);
+    Wrap(&glad_glUniform1i,        &g_Uniform1i,        Stats_Uniform1i);
+    Wrap(&glad_glUniform1f,        &g_Uniform1f,        Stats_Uniform1f);
+    Wrap(&glad_glUniform4f,        &g_Uniform4f,        Stats_Uniform4f);
+    Wrap(&glad_glUniformMatrix4fv, &g_UniformMatrix4fv, Stats_UniformMatrix4fv);
+    Wrap(&glad_glBufferData,       &g_BufferData,       Stats_BufferData);
+    Wrap(&glad_glBufferSubData,    &g_BufferSubData,    Stats_BufferSubData);
+    Wrap(&glad_glBindTexture,      &g_BindTexture,      Stats_BindTexture);
+    Wrap(&glad_glUseProgram,       &g_UseProgram,       Stats_UseProgram);
+    Wrap(&glad_glBindVertexArray,  &g_BindVertexArray,  Stats_BindVertexArray);
+}
+
+void GLStats_EndFrame()
+{
+    g_LastFrame = g_CurrentFrame;
+    g_CurrentFrame = GLStats();
+}
+
+const GLStats& GLStats_LastFrame()
+{
+    return g_LastFrame;
+}
+
+#endif // GL_STATS
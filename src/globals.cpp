@@ -31,6 +31,8 @@ bool g_UsePerspectiveProjection = true;
 
 bool g_ShowInfoText = false;
 
+bool g_ShowProfiler = false;
+
 GLuint g_GpuProgramID = 0;
 GLint g_model_uniform;
 GLint g_view_uniform;
@@ -38,15 +40,17 @@ GLint g_projection_uniform;
 GLint g_object_id_uniform;
 GLint g_bbox_min_uniform;
 GLint g_bbox_max_uniform;
+GLint g_texture_layer_uniform;
+GLint g_lamp_uniform[CIRCUIT_NUM_LAMPS];
+
+glm::mat4 g_ViewMatrix;
+glm::mat4 g_ProjectionMatrix;
 
 GLuint g_NumLoadedTextures = 0;
 
 double g_LastCursorPosX, g_LastCursorPosY;
 glm::vec3 g_rayPoint;
 
-bool andIsInput1Digit0 = true;
-bool andIsInput2Digit0 = true;
-bool wireIsInputDigit0 = true;
-bool notIsInputDigit0 = true;
-bool orIsInput1Digit0 = true;
-bool orIsInput2Digit0 = true;
\ No newline at end of file
+Netlist g_Circuits; // Construído por Netlist_BuildDemoCircuits() no início de main()
+Simulator g_CircuitSim;
+CircuitView g_CircuitView;
\ No newline at end of file
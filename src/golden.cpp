@@ -0,0 +1,457 @@
+#include "golden.h"
+#include "objects.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+// Shot do roteiro. Os parâmetros seguem a ordem do roteiro.
+struct GoldenShot
+{
+    std::string name;
+    int         mode;
+    float       params[4];
+    bool        inputs[CIRCUIT_NUM_INPUTS]; // Na ordem de CIRCUIT_*_IN*
+    float       threshold;
+    float       max_fraction;
+};
+
+static bool                    g_GoldenRunning = false;
+static bool                    g_GoldenUpdate = false;
+static std::string             g_GoldenReferences;
+static std::string             g_GoldenOutput = "golden";
+static int                     g_GoldenWidth = 640;
+static int                     g_GoldenHeight = 360;
+static int                     g_GoldenSettle = 3;
+static std::vector<GoldenShot> g_GoldenShots;
+static std::map<std::string, std::string> g_GoldenTextures; // Textura da cena -> substituta
+static int                     g_GoldenFrame = 0;  // Quadro atual
+static int                     g_GoldenFailures = 0;
+
+bool Golden_Load(const char* filename, bool update)
+{
+    FILE* file = fopen(filename, "r");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot open golden image script \"%s\".\n", filename);
+        return false;
+    }
+
+    // Por padrão, as referências ficam junto do roteiro.
+    g_GoldenReferences = filename;
+    size_t slash = g_GoldenReferences.find_last_of("/\\");
+    g_GoldenReferences = slash == std::string::npos ? "." : g_GoldenReferences.substr(0, slash);
+    std::string directory = g_GoldenReferences;
+
+    // A instrução "inputs" segue a ordem de CIRCUIT_*_IN*.
+    bool inputs[CIRCUIT_NUM_INPUTS];
+    for (int i = 0; i < CIRCUIT_NUM_INPUTS; ++i)
+        inputs[i] = Netlist_GetInput(&g_Circuits, i);
+
+    // Assim como "inputs", "tolerance" vale para os shots seguintes.
+    float threshold = 0.1f;
+    float max_fraction = 0.001f;
+
+    char line[512];
+    int line_number = 0;
+    bool ok = true;
+    while ( ok && fgets(line, sizeof(line), file) )
+    {
+        line_number += 1;
+
+        char* comment = strchr(line, '#');
+        if ( comment )
+            *comment = '\0';
+
+        char command[32];
+        if ( sscanf(line, "%31s", command) != 1 )
+            continue; // Linha vazia
+
+        char name[256];
+        char mode[32];
+
+        if ( strcmp(command, "size") == 0 )
+            ok = sscanf(line, "%*s %d %d", &g_GoldenWidth, &g_GoldenHeight) == 2 && g_GoldenWidth > 0 && g_GoldenHeight > 0;
+        else if ( strcmp(command, "settle") == 0 )
+            ok = sscanf(line, "%*s %d", &g_GoldenSettle) == 1 && g_GoldenSettle > 0;
+        else if ( strcmp(command, "tolerance") == 0 )
+            ok = sscanf(line, "%*s %f %f", &threshold, &max_fraction) == 2
+              && threshold >= 0.0f && max_fraction >= 0.0f;
+        else if ( strcmp(command, "references") == 0 )
+        {
+            ok = sscanf(line, "%*s %255s", name) == 1;
+            g_GoldenReferences = name;
+        }
+        else if ( strcmp(command, "texture") == 0 )
+        {
+            char substitute[256];
+            ok = sscanf(line, "%*s %255s %255s", name, substitute) == 2;
+            g_GoldenTextures[name] = directory + "/" + substitute;
+        }
+        else if ( strcmp(command, "output") == 0 )
+        {
+            ok = sscanf(line, "%*s %255s", name) == 1;
+            g_GoldenOutput = name;
+        }
+        else if ( strcmp(command, "inputs") == 0 )
+        {
+            int v[6];
+            ok = sscanf(line, "%*s %d %d %d %d %d %d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) == 6;
+            for (int i = 0; i < 6; ++i)
+            {
+                ok = ok && (v[i] == 0 || v[i] == 1);
+                inputs[i] = v[i] == 1;
+            }
+        }
+        else if ( strcmp(command, "shot") == 0 )
+        {
+            GoldenShot shot = GoldenShot();
+            float* p = shot.params;
+            ok = sscanf(line, "%*s %255s %31s", name, mode) == 2;
+            if ( ok && strcmp(mode, "bezier") == 0 )
+            {
+                shot.mode = BENCHMARK_BEZIER;
+                ok = sscanf(line, "%*s %*s %*s %f", &p[0]) == 1;
+            }
+            else if ( ok && strcmp(mode, "orbit") == 0 )
+            {
+                shot.mode = BENCHMARK_ORBIT;
+                ok = sscanf(line, "%*s %*s %*s %f %f %f", &p[0], &p[1], &p[2]) == 3;
+            }
+            else if ( ok && strcmp(mode, "free") == 0 )
+            {
+                shot.mode = BENCHMARK_FREE;
+                ok = sscanf(line, "%*s %*s %*s %f %f %f %f", &p[0], &p[1], &p[2], &p[3]) == 4;
+            }
+            else
+                ok = false;
+
+            shot.name = name;
+            for (int i = 0; i < CIRCUIT_NUM_INPUTS; ++i)
+                shot.inputs[i] = inputs[i];
+            shot.threshold = threshold;
+            shot.max_fraction = max_fraction;
+            g_GoldenShots.push_back(shot);
+        }
+        else
+            ok = false;
+
+        if ( !ok )
+            fprintf(stderr, "ERROR: %s:%d: invalid golden image command.\n", filename, line_number);
+    }
+    fclose(file);
+
+    if ( ok && g_GoldenShots.empty() )
+    {
+        fprintf(stderr, "ERROR: %s: golden image script has no shots.\n", filename);
+        ok = false;
+    }
+    if ( !ok )
+        return false;
+
+    printf("Imagens de referência \"%s\": %d shots, %dx%d, em \"%s\"%s.\n",
+           filename, (int)g_GoldenShots.size(), g_GoldenWidth, g_GoldenHeight,
+           g_GoldenReferences.c_str(), update ? " (atualizando)" : "");
+
+    g_GoldenUpdate = update;
+    g_GoldenRunning = true;
+    return true;
+}
+
+bool Golden_IsRunning()
+{
+    return g_GoldenRunning;
+}
+
+const char* Golden_TexturePath(const char* filename)
+{
+    if ( !g_GoldenRunning )
+        return filename;
+    std::map<std::string, std::string>::const_iterator it = g_GoldenTextures.find(filename);
+    return it == g_GoldenTextures.end() ? filename : it->second.c_str();
+}
+
+void Golden_WindowSize(int* width, int* height)
+{
+    *width = g_GoldenWidth;
+    *height = g_GoldenHeight;
+}
+
+void Golden_BeginFrame(BenchmarkCamera* camera)
+{
+    const GoldenShot& shot = g_GoldenShots[g_GoldenFrame / g_GoldenSettle];
+    const float* p = shot.params;
+
+    *camera = BenchmarkCamera();
+    camera->mode = shot.mode;
+    switch ( shot.mode )
+    {
+        case BENCHMARK_BEZIER:
+            camera->bezier_t = p[0];
+            break;
+        case BENCHMARK_ORBIT:
+            camera->theta    = p[0];
+            camera->phi      = p[1];
+            camera->distance = p[2];
+            break;
+        case BENCHMARK_FREE:
+            camera->theta    = p[0];
+            camera->phi      = p[1];
+            camera->distance = 3.5f; // Mesma distância definida pela tecla C
+            camera->movement = glm::vec3(p[2], 0.0f, p[3]);
+            break;
+    }
+
+    // As entradas só mudam no primeiro quadro de cada shot.
+    if ( g_GoldenFrame % g_GoldenSettle == 0 )
+    {
+        for (int i = 0; i < CIRCUIT_NUM_INPUTS; ++i)
+            Simulator_SetInput(&g_CircuitSim, i, shot.inputs[i]);
+    }
+}
+
+// Tabela do CRC-32 usado nos chunks do formato PNG.
+static unsigned int Crc32(const unsigned char* data, size_t size, unsigned int crc)
+{
+    static unsigned int table[256];
+    static bool table_ready = false;
+    if ( !table_ready )
+    {
+        for (unsigned int n = 0; n < 256; ++n)
+        {
+            unsigned int c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        table_ready = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void WriteBigEndian(std::vector<unsigned char>& out, unsigned int value)
+{
+    out.push_back((value >> 24) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+static void WriteChunk(FILE* file, const char* type, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> chunk;
+    WriteBigEndian(chunk, (unsigned int)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    WriteBigEndian(chunk, Crc32(&chunk[4], chunk.size() - 4, 0));
+    fwrite(&chunk[0], 1, chunk.size(), file);
+}
+
+// Grava uma imagem RGB em PNG. As linhas de "rgb" estão na ordem do OpenGL
+// (de baixo para cima). A stb_image só lê imagens; para não depender de outra
+// biblioteca, os dados são gravados sem compressão (blocos "stored" do
+// deflate), o que basta para imagens de teste.
+static bool WritePNG(const char* filename, const unsigned char* rgb, int width, int height)
+{
+    FILE* file = fopen(filename, "wb");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write image \"%s\".\n", filename);
+        return false;
+    }
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, 1, sizeof(signature), file);
+
+    std::vector<unsigned char> header;
+    WriteBigEndian(header, width);
+    WriteBigEndian(header, height);
+    header.push_back(8); // Bits por canal
+    header.push_back(2); // RGB
+    header.push_back(0); // Compressão deflate
+    header.push_back(0); // Filtros adaptativos
+    header.push_back(0); // Sem entrelaçamento
+    WriteChunk(file, "IHDR", header);
+
+    // Cada linha começa com o tipo de filtro (0: nenhum).
+    std::vector<unsigned char> raw;
+    size_t row_size = 3 * (size_t)width;
+    raw.reserve((row_size + 1) * height);
+    for (int y = height - 1; y >= 0; --y)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + y * row_size, rgb + (y + 1) * row_size);
+    }
+
+    std::vector<unsigned char> zlib;
+    zlib.push_back(0x78); // Deflate, janela de 32 KB
+    zlib.push_back(0x01);
+    size_t offset = 0;
+    do
+    {
+        size_t size = std::min(raw.size() - offset, (size_t)65535);
+        bool last = offset + size == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(size & 0xFF);
+        zlib.push_back((size >> 8) & 0xFF);
+        zlib.push_back(~size & 0xFF);
+        zlib.push_back((~size >> 8) & 0xFF);
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+        offset += size;
+    } while ( offset < raw.size() );
+
+    unsigned int a = 1, b = 0; // Adler-32
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    WriteBigEndian(zlib, (b << 16) | a);
+    WriteChunk(file, "IDAT", zlib);
+
+    WriteChunk(file, "IEND", std::vector<unsigned char>());
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    if ( !ok )
+        fprintf(stderr, "ERROR: Cannot write image \"%s\".\n", filename);
+    return ok;
+}
+
+// Diferença perceptual entre duas cores, no espaço YIQ (Kotsarenko e Ramos,
+// "Measuring perceived color difference using YIQ NTSC transmission color
+// space in mobile applications", 2010). Vai de 0 a 35215.
+static float ColorDelta(const unsigned char* c1, const unsigned char* c2)
+{
+    float r = (float)c1[0] - c2[0];
+    float g = (float)c1[1] - c2[1];
+    float b = (float)c1[2] - c2[2];
+
+    float y = r * 0.29889531f + g * 0.58662247f + b * 0.11448223f;
+    float i = r * 0.59597799f - g * 0.27417610f - b * 0.32180189f;
+    float q = r * 0.21147017f - g * 0.52261711f + b * 0.31114694f;
+
+    return 0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q;
+}
+
+// Compara o quadro com a imagem de referência. Retorna o número de pixels
+// diferentes e preenche "diff", ou -1 se a referência não pôde ser lida.
+static long CompareWithReference(const char* filename, const unsigned char* rgb, int width, int height, float threshold, std::vector<unsigned char>& diff)
+{
+    // Lida de baixo para cima, como o framebuffer (veja LoadTextureImage()).
+    stbi_set_flip_vertically_on_load(true);
+    int ref_width, ref_height, channels;
+    unsigned char* reference = stbi_load(filename, &ref_width, &ref_height, &channels, 3);
+    if ( reference == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot open reference image \"%s\" (use --golden-update to create it).\n", filename);
+        return -1;
+    }
+    if ( ref_width != width || ref_height != height )
+    {
+        fprintf(stderr, "ERROR: Reference image \"%s\" is %dx%d, expected %dx%d.\n", filename, ref_width, ref_height, width, height);
+        stbi_image_free(reference);
+        return -1;
+    }
+
+    const float max_delta = 35215.0f * threshold * threshold;
+    long different = 0;
+    diff.resize(3 * (size_t)width * height);
+    for (size_t i = 0; i < (size_t)width * height; ++i)
+    {
+        const unsigned char* a = rgb + 3 * i;
+        const unsigned char* b = reference + 3 * i;
+        unsigned char* d = &diff[3 * i];
+        if ( ColorDelta(a, b) > max_delta )
+        {
+            d[0] = 255; d[1] = 0; d[2] = 0;
+            different += 1;
+        }
+        else
+        {
+            // Referência em tons de cinza claros, para destacar as diferenças.
+            float luma = b[0] * 0.29889531f + b[1] * 0.58662247f + b[2] * 0.11448223f;
+            d[0] = d[1] = d[2] = (unsigned char)(255.0f - 0.1f * (255.0f - luma));
+        }
+    }
+
+    stbi_image_free(reference);
+    return different;
+}
+
+static void CheckShot(const GoldenShot& shot)
+{
+    // O viewport cobre todo o framebuffer (veja FramebufferSizeCallback()).
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    int width = viewport[2], height = viewport[3];
+
+    std::vector<unsigned char> rgb(3 * (size_t)width * height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &rgb[0]);
+
+    std::string reference = g_GoldenReferences + "/" + shot.name + ".png";
+    if ( g_GoldenUpdate )
+    {
+        if ( WritePNG(reference.c_str(), &rgb[0], width, height) )
+            printf("  %-24s atualizada (%s)\n", shot.name.c_str(), reference.c_str());
+        else
+            g_GoldenFailures += 1;
+        return;
+    }
+
+    std::vector<unsigned char> diff;
+    long different = CompareWithReference(reference.c_str(), &rgb[0], width, height, shot.threshold, diff);
+    long allowed = (long)(shot.max_fraction * width * height);
+    if ( different >= 0 && different <= allowed )
+    {
+        printf("  %-24s OK   (%ld pixels diferentes, máximo %ld)\n", shot.name.c_str(), different, allowed);
+        return;
+    }
+
+    g_GoldenFailures += 1;
+    std::string prefix = g_GoldenOutput + "_" + shot.name;
+    WritePNG((prefix + "_actual.png").c_str(), &rgb[0], width, height);
+    if ( different < 0 )
+    {
+        printf("  %-24s FALHA (sem referência; imagem obtida em %s_actual.png)\n", shot.name.c_str(), prefix.c_str());
+        return;
+    }
+    WritePNG((prefix + "_diff.png").c_str(), &diff[0], width, height);
+    printf("  %-24s FALHA (%ld pixels diferentes, máximo %ld; veja %s_diff.png)\n",
+           shot.name.c_str(), different, allowed, prefix.c_str());
+}
+
+bool Golden_EndFrame()
+{
+    g_GoldenFrame += 1;
+    if ( g_GoldenFrame % g_GoldenSettle == 0 )
+        CheckShot(g_GoldenShots[g_GoldenFrame / g_GoldenSettle - 1]);
+    return g_GoldenFrame < (int)g_GoldenShots.size() * g_GoldenSettle;
+}
+
+bool Golden_Finish()
+{
+    // A janela pode ter sido fechada antes do fim do roteiro.
+    int done = g_GoldenFrame / g_GoldenSettle;
+    if ( done < (int)g_GoldenShots.size() )
+    {
+        fprintf(stderr, "ERROR: Golden image run interrupted after %d of %d shots.\n", done, (int)g_GoldenShots.size());
+        g_GoldenFailures += (int)g_GoldenShots.size() - done;
+    }
+
+    if ( g_GoldenUpdate )
+        printf("Imagens de referência: %d de %d shots gravados.\n",
+               (int)g_GoldenShots.size() - g_GoldenFailures, (int)g_GoldenShots.size());
+    else
+        printf("Imagens de referência: %d de %d shots OK.\n",
+               (int)g_GoldenShots.size() - g_GoldenFailures, (int)g_GoldenShots.size());
+    return g_GoldenFailures == 0;
+}
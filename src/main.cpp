@@ -27,6 +27,7 @@
 #include <limits>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
 
 
 // Headers locais, definidos na pasta "include/"
@@ -35,28 +36,215 @@
 #include "bezierCurve.h"
 #include "window.h"
 #include "collisions.h"
+#include "assets.h"
+#include "shaderReload.h"
+#include "trace.h"
+#include "profiler.h"
+#include "glStats.h"
+#include "benchmark.h"
+#include "golden.h"
+#include "simulator.h"
+#include "cyclesim.h"
+#include "netlistLoader.h"
 
 #define M_PI 3.14159265358979323846
 
+// Limite de ciclos do clock livre por quadro: um quadro lento não acumula
+// ciclos atrasados, o clock desacelera.
+#define MAX_CLOCK_CYCLES_PER_FRAME 100000
+
 int main(int argc, char* argv[])
 {
-    initializeGLFW();
+    // Opções de linha de comando:
+    //   --obj-benchmark arquivo.obj   compara a vazão dos leitores de arquivos
+    //                                 ".obj" e termina, sem abrir a janela;
+    //   --sim-benchmark N             mede a simulação lógica em um circuito
+    //                                 aleatório de N portas e termina. Veja "simulator.h";
+    //   --sim-threads N               com --sim-benchmark, número máximo de
+    //                                 threads da simulação paralela (padrão:
+    //                                 uma por núcleo). Veja "parallelsim.h";
+    //   --sim-native                  com --sim-benchmark, mede o código
+    //                                 nativo mesmo em circuitos grandes, de
+    //                                 compilação demorada. Veja "nativesim.h";
+    //   --trace-startup[=arquivo]     grava a linha do tempo da inicialização
+    //                                 (até o primeiro quadro) no formato
+    //                                 trace_event do Chrome. Veja "trace.h";
+    //   --benchmark roteiro.txt       percorre um caminho de câmera fixo e
+    //                                 grava os tempos dos quadros. Veja "benchmark.h";
+    //   --headless                    renderiza sem janela, em um FBO (requer
+    //                                 cmake -DHEADLESS=ON). Veja "window.h";
+    //   --frames N                    termina após N quadros (sem janela e
+    //                                 fora do benchmark, o padrão é 1);
+    //   --golden roteiro.txt          compara poses fixas da cena com imagens
+    //                                 de referência. Veja "golden.h";
+    //   --golden-update               com --golden, regrava as referências;
+    //   --netlist arquivo             simula o circuito do arquivo (.blif, .v
+    //                                 ou .nlb) no lugar dos circuitos da mesa:
+    //                                 suas 6 primeiras entradas são os
+    //                                 mostradores e as 4 primeiras saídas, as
+    //                                 lâmpadas. Veja "netlistLoader.h";
+    //   --clock-rate HZ               frequência do clock livre dos circuitos
+    //                                 sequenciais (padrão: 1; 0 desliga o clock);
+    //   --cycles N                    executa N ciclos dos circuitos (da mesa
+    //                                 ou de --netlist) com a simulação por
+    //                                 ciclos, imprime a vazão e termina, sem
+    //                                 abrir a janela. Veja "cyclesim.h";
+    //   arquivo.obj                   modelo extra adicionado à cena.
+    const char* modelFilename = NULL;
+    const char* netlistFilename = NULL;
+    const char* traceFilename = NULL;
+    const char* goldenFilename = NULL;
+    bool goldenUpdate = false;
+    bool headless = false;
+    int maxFrames = 0;
+    uint32_t simBenchmarkGates = 0;
+    int simThreads = 0;
+    bool simNative = false;
+    double clockRate = 1.0;
+    uint64_t cycleCount = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ( strcmp(argv[i], "--obj-benchmark") == 0 && i + 1 < argc )
+        {
+            ObjLoader_Benchmark(argv[i + 1]);
+            return 0;
+        }
+        else if ( strcmp(argv[i], "--sim-benchmark") == 0 && i + 1 < argc )
+            simBenchmarkGates = (uint32_t)atol(argv[++i]);
+        else if ( strcmp(argv[i], "--sim-threads") == 0 && i + 1 < argc )
+            simThreads = atoi(argv[++i]);
+        else if ( strcmp(argv[i], "--sim-native") == 0 )
+            simNative = true;
+        else if ( strcmp(argv[i], "--trace-startup") == 0 )
+            traceFilename = "startup_trace.json";
+        else if ( strncmp(argv[i], "--trace-startup=", 16) == 0 )
+            traceFilename = argv[i] + 16;
+        else if ( strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc )
+        {
+            if ( !Benchmark_Load(argv[++i]) )
+                std::exit(EXIT_FAILURE);
+        }
+        else if ( strcmp(argv[i], "--golden") == 0 && i + 1 < argc )
+            goldenFilename = argv[++i];
+        else if ( strcmp(argv[i], "--golden-update") == 0 )
+            goldenUpdate = true;
+        else if ( strcmp(argv[i], "--netlist") == 0 && i + 1 < argc )
+            netlistFilename = argv[++i];
+        else if ( strcmp(argv[i], "--clock-rate") == 0 && i + 1 < argc )
+            clockRate = atof(argv[++i]);
+        else if ( strcmp(argv[i], "--cycles") == 0 && i + 1 < argc )
+            cycleCount = strtoull(argv[++i], NULL, 10);
+        else if ( strcmp(argv[i], "--headless") == 0 )
+            headless = true;
+        else if ( strcmp(argv[i], "--frames") == 0 && i + 1 < argc )
+            maxFrames = atoi(argv[++i]);
+        else if ( argv[i][0] == '-' )
+            fprintf(stderr, "WARNING: Opção desconhecida \"%s\" ignorada.\n", argv[i]);
+        else if ( modelFilename == NULL )
+            modelFilename = argv[i];
+    }
+
+    if ( simBenchmarkGates > 0 )
+    {
+        Simulator_Benchmark(simBenchmarkGates, simThreads, simNative);
+        return 0;
+    }
+
+    if ( traceFilename != NULL )
+        Trace_Begin(traceFilename);
 
-    // Definimos o callback para impressão de erros da GLFW no terminal
-    glfwSetErrorCallback(ErrorCallback);
+    // Circuitos da mesa; os roteiros de benchmark e de imagens de referência
+    // alteram suas entradas.
+    NetlistLoadStats netlistStats;
+    if ( netlistFilename != NULL )
+    {
+        if ( !NetlistLoader_Load(netlistFilename, &g_Circuits, &netlistStats) )
+            std::exit(EXIT_FAILURE);
+        if ( g_Circuits.inputs.size() < CIRCUIT_NUM_INPUTS || g_Circuits.outputs.size() < CIRCUIT_NUM_LAMPS )
+            fprintf(stderr, "WARNING: O netlist \"%s\" tem %zu entradas e %zu saídas; os mostradores e lâmpadas excedentes ficam desligados.\n",
+                    netlistFilename, g_Circuits.inputs.size(), g_Circuits.outputs.size());
+    }
+    else
+        Netlist_BuildDemoCircuits(&g_Circuits);
+    Simulator_Init(&g_CircuitSim, &g_Circuits);
+    if ( cycleCount > 0 )
+        return CycleSim_Benchmark(&g_Circuits, &g_CircuitSim, cycleCount) ? 0 : EXIT_FAILURE;
+    CircuitView_Init(&g_CircuitView, &g_Circuits);
+
+    if ( goldenFilename != NULL )
+    {
+        if ( Benchmark_IsRunning() )
+        {
+            fprintf(stderr, "ERROR: --golden and --benchmark cannot be used together.\n");
+            std::exit(EXIT_FAILURE);
+        }
+        if ( !Golden_Load(goldenFilename, goldenUpdate) )
+            std::exit(EXIT_FAILURE);
+    }
 
-    configureGLFW();
+    // Benchmark e imagens de referência controlam a câmera e as entradas dos
+    // circuitos quadro a quadro, e terminam sozinhos.
+    bool scripted = Benchmark_IsRunning() || Golden_IsRunning();
+
+    // Sem janela, sem um limite de quadros nem um roteiro, o programa não
+    // terminaria nunca: renderizamos um único quadro.
+    if ( headless && maxFrames == 0 && !scripted )
+        maxFrames = 1;
 
     // Criamos uma janela do sistema operacional, com 800 colunas e 600 linhas
     // de pixels
-    GLFWwindow* window;
-    window = glfwCreateWindow(800, 600, "Computer Engineering for Babies", NULL, NULL);
-    createWindow(window);
+    // No modo benchmark e nas imagens de referência o tamanho da janela é
+    // definido pelo roteiro.
+    int windowWidth = 800, windowHeight = 600;
+    if ( Benchmark_IsRunning() )
+        Benchmark_WindowSize(&windowWidth, &windowHeight);
+    if ( Golden_IsRunning() )
+        Golden_WindowSize(&windowWidth, &windowHeight);
+
+    GLFWwindow* window = NULL;
+    if ( headless )
+    {
+        // Sem janela a GLFW não é utilizada; não há teclado nem mouse.
+        TRACE_SCOPE("createHeadlessContext");
+        createHeadlessContext(windowWidth, windowHeight);
+    }
+    else
+    {
+        {
+            TRACE_SCOPE("initializeGLFW");
+            initializeGLFW();
+        }
+
+        // Definimos o callback para impressão de erros da GLFW no terminal
+        glfwSetErrorCallback(ErrorCallback);
+
+        configureGLFW();
 
-    setCallbacks(window);
+        {
+            TRACE_SCOPE("createWindow");
+            window = glfwCreateWindow(windowWidth, windowHeight, "Computer Engineering for Babies", NULL, NULL);
+            createWindow(window);
+        }
+
+        setCallbacks(window);
+    }
+
+    // O benchmark ignora teclado e mouse, e desliga o vsync para que o tempo
+    // dos quadros não seja limitado pela taxa de atualização do monitor.
+    if ( scripted && !headless )
+    {
+        glfwSetKeyCallback(window, NULL);
+        glfwSetMouseButtonCallback(window, NULL);
+        glfwSetCursorPosCallback(window, NULL);
+        glfwSetScrollCallback(window, NULL);
+        glfwSwapInterval(0);
+    }
 
     printGPUinfo();
 
+    // Consultas de tempo da GPU para o profiler (tecla F3). Veja "profiler.h".
+    Profiler_GpuInit();
+
     // Carregamos os shaders de vértices e de fragmentos que serão utilizados
     // para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
     //
@@ -69,39 +257,70 @@ int main(int argc, char* argv[])
     LoadTextureImage("../../data/table/chinese_console_table_diff_4k.jpg"); // TextureTable
     LoadTextureImage("../../data/cylinder/Metal009_4K-JPG_Color.jpg"); // TextureWire
     LoadTextureImage("../../data/display/textures/metal_plate_diff_4k.jpg"); // TextureDisplay
-    LoadTextureImage("../../data/display/textures/digit0.jpg"); // TextureDigit0
-    LoadTextureImage("../../data/display/textures/digit1.jpg"); // TextureDigit1
-    LoadTextureImage("../../data/circuits/wire.jpg"); // TexturePlaneWire
-    LoadTextureImage("../../data/circuits/not.jpg"); // TexturePlaneNot
+
+    // Texturas de mesmo conteúdo (dígitos e placas dos circuitos) são
+    // agrupadas em texturas do tipo GL_TEXTURE_2D_ARRAY, onde cada imagem é
+    // uma camada (layer) selecionada em tempo de desenho pelo uniform
+    // "texture_layer". A ordem dos arquivos define o índice de cada camada.
+    const char* digitTextures[] = {
+        "../../data/display/textures/digit0.jpg", // LAYER_DIGIT0
+        "../../data/display/textures/digit1.jpg", // LAYER_DIGIT1
+    };
+    LoadTextureArray(digitTextures, 2); // TextureDigits
+
+    const char* boardTextures[] = {
+        "../../data/circuits/wire.jpg", // LAYER_BOARD_WIRE
+        "../../data/circuits/not.jpg",  // LAYER_BOARD_NOT
+        "../../data/circuits/and.jpg",  // LAYER_BOARD_AND
+        "../../data/circuits/or.jpg",   // LAYER_BOARD_OR
+    };
+    LoadTextureArray(boardTextures, 4); // TextureBoards
+
     LoadTextureImage("../../data/circuits/lego.png"); // TextureBlocks
     LoadTextureImage("../../data/Blocks_001_COLOR_B.jpg"); // TextureSphere
-    LoadTextureImage("../../data/circuits/and.jpg"); // TexturePlaneAnd
     LoadTextureImage("../../data/grass-1000-mm-architextures.jpg"); // TextureFloor
-    LoadTextureImage("../../data/circuits/or.jpg"); // TexturePlaneOr
     LoadTextureImage("../../data/sky/toy-story-cloud-1g0hhs34nbf7q7ma.jpg"); // TextureSky
 
     
-    // Construímos a representação de objetos geométricos através de malhas de triângulos
-    buildModel("../../data/sphere.obj");
-    buildModel("../../data/bunny.obj");
-    buildModel("../../data/lampada/lightbulb_01_4k.obj");
-    buildModel("../../data/and/and.obj");
-    buildModel("../../data/cylinder/cylinder.obj");
-    buildModel("../../data/display/cube.obj");
-    buildModel("../../data/plane.obj");
-    buildModel("../../data/table/chinese_console_table_4k.obj");
-    buildModel("../../data/not/not.obj");
-    buildModel("../../data/and/and.obj");
-    buildModel("../../data/or/or.obj");
-
-    if ( argc > 1 )
+    // Registramos os modelos geométricos da cena. Cada modelo só é carregado
+    // (e sua malha de triângulos construída) na primeira vez que um de seus
+    // objetos é referenciado. Veja Assets_GetObject() em "assets.cpp".
+    Assets_RegisterModel("../../data/sphere.obj", "the_sphere");
+    Assets_RegisterModel("../../data/bunny.obj", "the_bunny");
+    Assets_RegisterModel("../../data/lampada/lightbulb_01_4k.obj", "lightbulb_01");
+    Assets_RegisterModel("../../data/and/and.obj", "and");
+    Assets_RegisterModel("../../data/cylinder/cylinder.obj", "Cylinder");
+    Assets_RegisterModel("../../data/display/cube.obj", "Cube");
+    Assets_RegisterModel("../../data/plane.obj", "the_plane");
+    Assets_RegisterModel("../../data/table/chinese_console_table_4k.obj", "table");
+    Assets_RegisterModel("../../data/not/not.obj", "Not");
+    Assets_RegisterModel("../../data/or/or.obj", "or");
+
+    if ( modelFilename != NULL )
     {
-        ObjModel model(argv[1]);
+        TRACE_SCOPE("buildModel");
+        Trace_AddArg("file", modelFilename);
+
+        // Modelos passados por linha de comando podem ser grandes, então
+        // utilizamos o leitor paralelo de ObjLoader_Load().
+        ObjModel model(modelFilename, NULL, true, true);
+        ComputeNormals(&model);
         BuildTrianglesAndAddToVirtualScene(&model);
     }
 
     // Inicializamos o código para renderização de texto.
-    TextRendering_Init();
+    {
+        TRACE_SCOPE("TextRendering_Init");
+        TextRendering_Init();
+    }
+
+    // Iniciamos a recompilação automática dos shaders quando os arquivos
+    // ".glsl" forem alterados. Veja "shaderReload.h".
+    if ( !headless )
+    {
+        TRACE_SCOPE("ShaderReload_Init");
+        ShaderReload_Init(window);
+    }
 
     // Habilitamos o Z-buffer. Veja slides 104-116 do documento Aula_09_Projecoes.pdf.
     glEnable(GL_DEPTH_TEST);
@@ -113,7 +332,13 @@ int main(int argc, char* argv[])
 
     // Definição de propriedades da câmera
     float speed = 2.0f; // Velocidade da câmera
-    float prev_time = (float)glfwGetTime();
+    float prev_time = (float)getTime();
+
+    // Clock livre dos circuitos sequenciais: o número de bordas de cada
+    // quadro é proporcional ao tempo decorrido, independente da taxa de
+    // quadros. Nos roteiros, cada quadro vale 1/60 s.
+    double clockTime = getTime();
+    double clockPendingEdges = 0.0;
 
     // Calcula as coordenadas iniciais da free camera, que são fixas para servir 
     // de 'ancoragem' ao vetor view.
@@ -142,50 +367,85 @@ int main(int argc, char* argv[])
     bool isTableCollision = false;
     bool isSkyCollision = false;
 
-    // Inicializa as informações sobre os objetos da cena
+    // Inicializa as informações sobre os objetos da cena (todos os campos,
+    // na ordem de GameObject)
     GameObject table = {
-        table.name = "mesa",
-        table.pos = glm::vec3(0.0f, 0.0f, 0.0f),
-        table.scale = glm::vec3(0.0f, 0.0f, 0.0f),
-        table.rotation = glm::vec3(0.0f, 0.0f, 0.0f),
-        table.sceneObject = g_VirtualScene["table"]
+        "mesa",
+        glm::vec3(0.0f, 0.0f, 0.0f), // pos
+        glm::vec3(0.0f, 0.0f, 0.0f), // scale
+        glm::vec3(0.0f, 0.0f, 0.0f), // rotation
+        Assets_GetObject("table"),   // sceneObject
+        false,                       // isHovered
+        AABB()                       // bbox
     };
 
     GameObject WireCircuit = {
-        WireCircuit.name = "Circuito Wire", 
-        WireCircuit.pos = glm::vec3(0.0f, 0.0f, 0.0f),
-        WireCircuit.scale = glm::vec3(0.0f, 0.0f, 0.0f),
-        WireCircuit.rotation = glm::vec3(0.0f, 0.0f, 0.0f)
+        "Circuito Wire",
+        glm::vec3(0.0f, 0.0f, 0.0f), // pos
+        glm::vec3(0.0f, 0.0f, 0.0f), // scale
+        glm::vec3(0.0f, 0.0f, 0.0f), // rotation
+        SceneObject(),               // sceneObject
+        false,                       // isHovered
+        AABB()                       // bbox
     };
 
     GameObject AndCircuit = {
-        AndCircuit.name = "Circuito AND", 
-        AndCircuit.pos = glm::vec3(0.0f, 0.0f, 0.0f),
-        AndCircuit.scale = glm::vec3(0.0f, 0.0f, 0.0f),
-        AndCircuit.rotation = glm::vec3(0.0f, 0.0f, 0.0f),
+        "Circuito AND",
+        glm::vec3(0.0f, 0.0f, 0.0f), // pos
+        glm::vec3(0.0f, 0.0f, 0.0f), // scale
+        glm::vec3(0.0f, 0.0f, 0.0f), // rotation
+        SceneObject(),               // sceneObject
+        false,                       // isHovered
+        AABB()                       // bbox
     };
 
     GameObject NotCircuit = {
-        NotCircuit.name = "Circuito NOT", 
-        NotCircuit.pos = glm::vec3(0.0f, 0.0f, 0.0f),
-        NotCircuit.scale = glm::vec3(0.0f, 0.0f, 0.0f),
-        NotCircuit.rotation = glm::vec3(0.0f, 0.0f, 0.0f),
+        "Circuito NOT",
+        glm::vec3(0.0f, 0.0f, 0.0f), // pos
+        glm::vec3(0.0f, 0.0f, 0.0f), // scale
+        glm::vec3(0.0f, 0.0f, 0.0f), // rotation
+        SceneObject(),               // sceneObject
+        false,                       // isHovered
+        AABB()                       // bbox
     };
 
     GameObject OrCircuit = {
-        NotCircuit.name = "Circuito OR", 
-        NotCircuit.pos = glm::vec3(0.0f, 0.0f, 0.0f),
-        NotCircuit.scale = glm::vec3(0.0f, 0.0f, 0.0f),
-        NotCircuit.rotation = glm::vec3(0.0f, 0.0f, 0.0f),
+        "Circuito OR",
+        glm::vec3(0.0f, 0.0f, 0.0f), // pos
+        glm::vec3(0.0f, 0.0f, 0.0f), // scale
+        glm::vec3(0.0f, 0.0f, 0.0f), // rotation
+        SceneObject(),               // sceneObject
+        false,                       // isHovered
+        AABB()                       // bbox
     };
     glm::vec4 cameraCollisionOffset = glm::vec4(0.0f,0.0f,0.0f,0.0f);
 
+    // Nível de detalhe atual dos objetos desenhados com LOD. Guardamos o nível
+    // do quadro anterior para que SelectLOD() aplique histerese na troca.
+    int tableLod = 0;
+    int bulbLod[4] = { 0, 0, 0, 0 }; // Lâmpadas dos circuitos WIRE, NOT, AND e OR
+
+    bool startupStatsPrinted = false;
+    int frameCount = 0;
+
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
-    while (!glfwWindowShouldClose(window))
+    while (!windowShouldClose(window))
     {
+        // Só tem efeito enquanto o trace da inicialização está ativo, ou
+        // seja, no primeiro quadro.
+        TRACE_SCOPE("frame");
+
+        // Zonas do profiler de CPU, mostradas na tela com a tecla F3. Veja "profiler.h".
+        PROFILE_ZONE("frame");
+        Profiler_GpuFrameBegin();
+
+        // Se um novo programa de GPU foi compilado em segundo plano, passamos
+        // a utilizá-lo a partir deste quadro.
+        ShaderReload_Poll();
+
         // Obtém o tamanho atual da janela, para renderização
         int screenWidth, screenHeight;
-        glfwGetWindowSize(window, &screenWidth, &screenHeight);
+        getWindowSize(window, &screenWidth, &screenHeight);
         g_ScreenWidth = static_cast<float>(screenWidth);
         g_ScreenHeight = static_cast<float>(screenHeight);
         g_ScreenRatio = g_ScreenWidth / g_ScreenHeight;
@@ -208,11 +468,37 @@ int main(int argc, char* argv[])
         // os shaders de vértice e fragmentos).
         glUseProgram(g_GpuProgramID);
 
+        ProfileZone cameraZone("camera");
+
+        // No modo benchmark (e nas imagens de referência) a câmera segue o
+        // roteiro, quadro a quadro, em vez do tempo decorrido e da entrada do
+        // usuário.
+        if ( scripted )
+        {
+            BenchmarkCamera benchmarkCamera;
+            if ( Benchmark_IsRunning() )
+                Benchmark_BeginFrame(&benchmarkCamera);
+            else
+                Golden_BeginFrame(&benchmarkCamera);
+
+            curvedCamera = benchmarkCamera.mode == BENCHMARK_BEZIER;
+            freeCamera = benchmarkCamera.mode == BENCHMARK_FREE;
+            if (curvedCamera) {
+                t = benchmarkCamera.bezier_t;
+            } else {
+                g_CameraTheta = benchmarkCamera.theta;
+                g_CameraPhi = benchmarkCamera.phi;
+                g_CameraDistance = benchmarkCamera.distance;
+            }
+            camera_movement = glm::vec4(benchmarkCamera.movement, 0.0f);
+        }
+
         if (curvedCamera) {
-            float currentTimeBezier = (float)glfwGetTime();
+            float currentTimeBezier = (float)getTime();
             float deltaTime = currentTimeBezier - prev_time;
             prev_time = currentTimeBezier;
-            t += deltaTime / 2.0f;
+            if ( !scripted )
+                t += deltaTime / 2.0f;
 
             if (t >= 1.0f) {
                 t = 1.0f;
@@ -296,6 +582,31 @@ int main(int argc, char* argv[])
             projectionMatrix = Matrix_Orthographic(l, r, b, t, nearplane, farplane);
         }
 
+        cameraZone.End();
+
+        // Avançamos o clock livre e propagamos as entradas alteradas desde o
+        // quadro anterior (cliques, benchmark, imagens de referência) pelos
+        // circuitos. Só as nets que mudaram são lidas, e só as lâmpadas que
+        // mudaram são enviadas ao shader (veja "circuitView.h").
+        {
+            PROFILE_ZONE("simulation");
+            if ( !g_Circuits.clocks.empty() && clockRate > 0.0 )
+            {
+                double now = scripted ? clockTime + 1.0 / 60.0 : getTime();
+                clockPendingEdges += 2.0 * clockRate * (now - clockTime);
+                clockTime = now;
+                if ( clockPendingEdges > 2.0 * MAX_CLOCK_CYCLES_PER_FRAME )
+                    clockPendingEdges = 2.0 * MAX_CLOCK_CYCLES_PER_FRAME;
+                for (; clockPendingEdges >= 1.0; clockPendingEdges -= 1.0)
+                    Simulator_ClockEdge(&g_CircuitSim, g_Circuits.net_value[g_Circuits.clocks[0]] == 0);
+            }
+            Simulator_Run(&g_CircuitSim);
+            if ( CircuitView_Update(&g_CircuitView, &g_CircuitSim) > 0 )
+                UpdateCircuitUniforms();
+        }
+
+        ProfileZone sceneZone("scene");
+
         glm::mat4 model = Matrix_Identity(); // Transformação identidade de modelagem
 
         // Enviamos as matrizes "view" e "projection" para a placa de vídeo
@@ -303,6 +614,8 @@ int main(int argc, char* argv[])
         // efetivamente aplicadas em todos os pontos.
         glUniformMatrix4fv(g_view_uniform       , 1 , GL_FALSE , glm::value_ptr(viewMatrix));
         glUniformMatrix4fv(g_projection_uniform , 1 , GL_FALSE , glm::value_ptr(projectionMatrix));
+        g_ViewMatrix = viewMatrix;
+        g_ProjectionMatrix = projectionMatrix;
 
         #define SPHERE 0
         #define LIGHTBULB_WIRE 1
@@ -328,6 +641,15 @@ int main(int argc, char* argv[])
         #define NOT_INPUT1_DIGIT 21
         #define SKY 22
 
+        // Camadas das texturas GL_TEXTURE_2D_ARRAY. Veja LoadTextureArray().
+        #define LAYER_DIGIT0 0
+        #define LAYER_DIGIT1 1
+        #define LAYER_BOARD_WIRE 0
+        #define LAYER_BOARD_NOT 1
+        #define LAYER_BOARD_AND 2
+        #define LAYER_BOARD_OR 3
+        #define DIGIT_LAYER(input) (CircuitView_DigitOn(&g_CircuitView, input) ? LAYER_DIGIT1 : LAYER_DIGIT0)
+
         #define PLANE_WIDTH 0.2f
         #define PLANE_HEIGHT 0.145f
         #define DISPLAY_WIDTH (PLANE_WIDTH / 6.0f)
@@ -335,6 +657,9 @@ int main(int argc, char* argv[])
         #define NUM_CIRCUITS 4
         #define CIRCUIT_WIDTH (0.75 * PLANE_WIDTH)
 
+        // Cada etapa do desenho da cena é medida também na GPU (tecla F3).
+        GpuProfileZone skyGpuZone("sky");
+
         glDepthFunc(GL_ALWAYS); // Desativa Z-buffer para renderizar o céu
 
         glm::mat4 skyModel = Matrix_Scale(farplane/2,farplane/2,farplane/2);
@@ -344,6 +669,9 @@ int main(int argc, char* argv[])
 
         glDepthFunc(GL_LESS); // Reativa o Z-buffer
 
+        skyGpuZone.End();
+        GpuProfileZone tableGpuZone("table");
+
         // ----------------------------------------------------------------------------------------------------------
         // 0 - TABLE
         // ----------------------------------------------------------------------------------------------------------
@@ -356,9 +684,10 @@ int main(int argc, char* argv[])
                     * Matrix_Rotate_Y(M_PI/2.0f);
             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
             glUniform1i(g_object_id_uniform, TABLE);
-            DrawVirtualObject("table");
+            tableLod = SelectLOD("table", model, tableLod);
+            DrawVirtualObjectLOD("table", tableLod);
 
-            table.bbox = GetWorldAABB(g_VirtualScene["table"], model);
+            table.bbox = GetWorldAABB(Assets_GetObject("table"), model);
 
         PopMatrix(model);
 
@@ -367,8 +696,8 @@ int main(int argc, char* argv[])
         glm::vec3 bbox_max;
 
         // Cálculo da altura da mesa
-        bbox_min = g_VirtualScene["table"].bbox_min;
-        bbox_max = g_VirtualScene["table"].bbox_max;
+        bbox_min = Assets_GetObject("table").bbox_min;
+        bbox_max = Assets_GetObject("table").bbox_max;
         glUniform4f(g_bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
         glUniform4f(g_bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
         float tableHeight = bbox_max.z - bbox_min.z;
@@ -377,12 +706,15 @@ int main(int argc, char* argv[])
         float tableDepth = bbox_max.y - bbox_min.y;
 
         // Cálculo da altura da lâmpada
-        bbox_min = g_VirtualScene["lightbulb_01"].bbox_min;
-        bbox_max = g_VirtualScene["lightbulb_01"].bbox_max;
+        bbox_min = Assets_GetObject("lightbulb_01").bbox_min;
+        bbox_max = Assets_GetObject("lightbulb_01").bbox_max;
         glUniform4f(g_bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
         glUniform4f(g_bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
         float lightBulbHeight = bbox_max[1] - bbox_min[1];
 
+        tableGpuZone.End();
+        GpuProfileZone circuitsGpuZone("circuits");
+
         // ----------------------------------------------------------------------------------------------------------
         // CIRCUITOS
         // ----------------------------------------------------------------------------------------------------------
@@ -409,8 +741,9 @@ int main(int argc, char* argv[])
                     model *= Matrix_Scale(PLANE_WIDTH, 1.0f, PLANE_HEIGHT);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, PLANE_WIRE);
+                    glUniform1i(g_texture_layer_uniform, LAYER_BOARD_WIRE);
                     DrawVirtualObject("the_plane");
-                    AABB wirePlaneBbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                    AABB wirePlaneBbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
 
                 PopMatrix(model);
 
@@ -419,9 +752,10 @@ int main(int argc, char* argv[])
                     model *= Matrix_Translate(CIRCUIT_WIDTH, 0.01f, 0.0f);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, LIGHTBULB_WIRE);
-                    DrawVirtualObject("lightbulb_01");
+                    bulbLod[0] = SelectLOD("lightbulb_01", model, bulbLod[0]);
+                    DrawVirtualObjectLOD("lightbulb_01", bulbLod[0]);
 
-                    AABB wireBulbBbox = GetWorldAABB(g_VirtualScene["lightbulb_01"], model);
+                    AABB wireBulbBbox = GetWorldAABB(Assets_GetObject("lightbulb_01"), model);
 
                 PopMatrix(model);
 
@@ -446,7 +780,7 @@ int main(int argc, char* argv[])
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, DISPLAY);
                             DrawVirtualObject("Cube");
-                            AABB wireCubeBbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                            AABB wireCubeBbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                         PopMatrix(model);
 
                         PushMatrix(model);
@@ -455,8 +789,9 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, WIRE_INPUT1_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_WIRE_IN));
                             DrawVirtualObject("the_plane");
-                            AABB wireInputBbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                            AABB wireInputBbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                         PopMatrix(model);
 
                 PopMatrix(model);
@@ -491,9 +826,10 @@ int main(int argc, char* argv[])
                     model *= Matrix_Scale(PLANE_WIDTH, 1.0f, PLANE_HEIGHT);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, PLANE_NOT);
+                    glUniform1i(g_texture_layer_uniform, LAYER_BOARD_NOT);
 
                     DrawVirtualObject("the_plane");
-                    AABB notPlaneBbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                    AABB notPlaneBbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                 PopMatrix(model);
 
                 PushMatrix(model);
@@ -501,8 +837,9 @@ int main(int argc, char* argv[])
                     model *= Matrix_Translate(CIRCUIT_WIDTH, 0.01f, 0.0f);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, LIGHTBULB_NOT);
-                    DrawVirtualObject("lightbulb_01");
-                    AABB notBulbBbox = GetWorldAABB(g_VirtualScene["lightbulb_01"], model);
+                    bulbLod[1] = SelectLOD("lightbulb_01", model, bulbLod[1]);
+                    DrawVirtualObjectLOD("lightbulb_01", bulbLod[1]);
+                    AABB notBulbBbox = GetWorldAABB(Assets_GetObject("lightbulb_01"), model);
                 PopMatrix(model);
 
                 PushMatrix(model);
@@ -537,7 +874,7 @@ int main(int argc, char* argv[])
                         glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                         glUniform1i(g_object_id_uniform, DISPLAY);
                         DrawVirtualObject("Cube");
-                        AABB notCubeBbox = GetWorldAABB(g_VirtualScene["Cube"], model);
+                        AABB notCubeBbox = GetWorldAABB(Assets_GetObject("Cube"), model);
                     PopMatrix(model);
 
                     PushMatrix(model);
@@ -546,8 +883,9 @@ int main(int argc, char* argv[])
                             * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                         glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                         glUniform1i(g_object_id_uniform, NOT_INPUT1_DIGIT);
+                        glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_NOT_IN));
                         DrawVirtualObject("the_plane");
-                        AABB notInputBbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                        AABB notInputBbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                     PopMatrix(model);
 
                     PushMatrix(model);
@@ -558,7 +896,7 @@ int main(int argc, char* argv[])
                         glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                         glUniform1i(g_object_id_uniform, NOT);
                         DrawVirtualObject("Not");
-                        AABB notBbox = GetWorldAABB(g_VirtualScene["Not"], model);
+                        AABB notBbox = GetWorldAABB(Assets_GetObject("Not"), model);
                     PopMatrix(model);
 
                     PushMatrix(model);
@@ -604,8 +942,9 @@ int main(int argc, char* argv[])
                     model *= Matrix_Scale(PLANE_WIDTH, 1.0f, PLANE_HEIGHT);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, PLANE_AND);
+                    glUniform1i(g_texture_layer_uniform, LAYER_BOARD_AND);
                     DrawVirtualObject("the_plane");
-                    AABB andPlaneBbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                    AABB andPlaneBbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                 PopMatrix(model);
 
                 PushMatrix(model);
@@ -613,8 +952,9 @@ int main(int argc, char* argv[])
                     model *= Matrix_Translate(CIRCUIT_WIDTH, 0.01f, 0.0f);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, LIGHTBULB_AND);
-                    DrawVirtualObject("lightbulb_01");
-                    AABB andBulbBbox = GetWorldAABB(g_VirtualScene["lightbulb_01"], model);
+                    bulbLod[2] = SelectLOD("lightbulb_01", model, bulbLod[2]);
+                    DrawVirtualObjectLOD("lightbulb_01", bulbLod[2]);
+                    AABB andBulbBbox = GetWorldAABB(Assets_GetObject("lightbulb_01"), model);
 
                 PopMatrix(model);
 
@@ -673,6 +1013,7 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, AND_INPUT1_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_AND_IN1));
                             DrawVirtualObject("the_plane");
                         PopMatrix(model);
 
@@ -690,8 +1031,9 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, AND_INPUT1_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_AND_IN1));
                             DrawVirtualObject("the_plane");
-                            AABB andInput1Bbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                            AABB andInput1Bbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                         PopMatrix(model);
                         
                     PopMatrix(model);
@@ -714,6 +1056,7 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, AND_INPUT2_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_AND_IN2));
                             DrawVirtualObject("the_plane");
                         PopMatrix(model);
 
@@ -731,8 +1074,9 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, AND_INPUT1_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_AND_IN1));
                             DrawVirtualObject("the_plane");
-                            AABB andInput2Bbox = GetWorldAABB(g_VirtualScene["Cube"], model);
+                            AABB andInput2Bbox = GetWorldAABB(Assets_GetObject("Cube"), model);
                         PopMatrix(model);
                         
                     PopMatrix(model);                
@@ -747,7 +1091,7 @@ int main(int argc, char* argv[])
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, AND);
                     DrawVirtualObject("and");
-                    AABB andBbox = GetWorldAABB(g_VirtualScene["and"], model);
+                    AABB andBbox = GetWorldAABB(Assets_GetObject("and"), model);
 
                 PopMatrix(model);
 
@@ -783,8 +1127,9 @@ int main(int argc, char* argv[])
                     model *= Matrix_Scale(PLANE_WIDTH, 1.0f, PLANE_HEIGHT);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, PLANE_OR);
+                    glUniform1i(g_texture_layer_uniform, LAYER_BOARD_OR);
                     DrawVirtualObject("the_plane");
-                    AABB orPlaneBbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                    AABB orPlaneBbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                 PopMatrix(model);
 
                 PushMatrix(model);
@@ -792,8 +1137,9 @@ int main(int argc, char* argv[])
                     model *= Matrix_Translate(CIRCUIT_WIDTH, 0.01f, 0.0f);
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, LIGHTBULB_OR);
-                    DrawVirtualObject("lightbulb_01");
-                    AABB orBulbBbox = GetWorldAABB(g_VirtualScene["lightbulb_01"], model);
+                    bulbLod[3] = SelectLOD("lightbulb_01", model, bulbLod[3]);
+                    DrawVirtualObjectLOD("lightbulb_01", bulbLod[3]);
+                    AABB orBulbBbox = GetWorldAABB(Assets_GetObject("lightbulb_01"), model);
 
                 PopMatrix(model);
 
@@ -852,6 +1198,7 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, OR_INPUT1_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_OR_IN1));
                             DrawVirtualObject("the_plane");
                         PopMatrix(model);
 
@@ -869,9 +1216,10 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, OR_INPUT1_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_OR_IN1));
                             DrawVirtualObject("the_plane");
 
-                            AABB orInput1Bbox = GetWorldAABB(g_VirtualScene["the_plane"], model);
+                            AABB orInput1Bbox = GetWorldAABB(Assets_GetObject("the_plane"), model);
                         PopMatrix(model);
                         
                     PopMatrix(model);
@@ -894,6 +1242,7 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, OR_INPUT2_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_OR_IN2));
                             DrawVirtualObject("the_plane");
                         PopMatrix(model);
 
@@ -911,9 +1260,10 @@ int main(int argc, char* argv[])
                                 * Matrix_Scale(DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT);
                             glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                             glUniform1i(g_object_id_uniform, OR_INPUT1_DIGIT);
+                            glUniform1i(g_texture_layer_uniform, DIGIT_LAYER(CIRCUIT_OR_IN1));
                             DrawVirtualObject("the_plane");
 
-                            AABB orInput2Bbox = GetWorldAABB(g_VirtualScene["Cube"], model);
+                            AABB orInput2Bbox = GetWorldAABB(Assets_GetObject("Cube"), model);
                         PopMatrix(model);
                         
                     PopMatrix(model);                
@@ -928,7 +1278,7 @@ int main(int argc, char* argv[])
                     glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
                     glUniform1i(g_object_id_uniform, OR);
                     DrawVirtualObject("or");
-                    AABB orBbox = GetWorldAABB(g_VirtualScene["and"], model);
+                    AABB orBbox = GetWorldAABB(Assets_GetObject("and"), model);
                 PopMatrix(model);
 
             PopMatrix(model);
@@ -947,12 +1297,20 @@ int main(int argc, char* argv[])
 
         PopMatrix(model);
 
+        circuitsGpuZone.End();
+        GpuProfileZone groundGpuZone("ground");
+
         // Desenhamos o plano do chão
         model = Matrix_Translate(0.0f,0.0f,0.0f) * Matrix_Scale(10.0f,10.0f,10.0f);
         glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
         glUniform1i(g_object_id_uniform, GROUND);
         DrawVirtualObject("the_plane");
 
+        groundGpuZone.End();
+
+        sceneZone.End();
+        ProfileZone pickingZone("picking");
+
         // Projeta um ray casting em coord. do mundo a partir das coord. do mouse
         g_rayPoint = MouseRayCasting(projectionMatrix, viewMatrix);
         glm::vec3 rayVec = glm::normalize(glm::vec4(g_rayPoint, 1.0f));
@@ -966,33 +1324,27 @@ int main(int argc, char* argv[])
  
         // Testa o clique do mouse para alterar o input dos circuitos
         if (g_LeftMouseButtonPressed && wireInputClick) {
-            wireIsInputDigit0 = !wireIsInputDigit0;
-            reLoadShaders();
+            Simulator_ToggleInput(&g_CircuitSim, CIRCUIT_WIRE_IN);
             g_LeftMouseButtonPressed = false;
         }
         else if (g_LeftMouseButtonPressed && notInputClick) {
-            notIsInputDigit0 = !notIsInputDigit0;
-            reLoadShaders();
+            Simulator_ToggleInput(&g_CircuitSim, CIRCUIT_NOT_IN);
             g_LeftMouseButtonPressed = false;
         }
         else if (g_LeftMouseButtonPressed && andInput1Click) {
-            andIsInput1Digit0 = !andIsInput1Digit0;
-            reLoadShaders();
+            Simulator_ToggleInput(&g_CircuitSim, CIRCUIT_AND_IN1);
             g_LeftMouseButtonPressed = false;
         }
         else if (g_LeftMouseButtonPressed && andInput2Click) {
-            andIsInput2Digit0 = !andIsInput2Digit0;
-            reLoadShaders();
+            Simulator_ToggleInput(&g_CircuitSim, CIRCUIT_AND_IN2);
             g_LeftMouseButtonPressed = false;
         }
         else if (g_LeftMouseButtonPressed && orInput1Click) {
-            orIsInput1Digit0 = !orIsInput1Digit0;
-            reLoadShaders();
+            Simulator_ToggleInput(&g_CircuitSim, CIRCUIT_OR_IN1);
             g_LeftMouseButtonPressed = false;
         }
         else if (g_LeftMouseButtonPressed && orInput2Click) {
-            orIsInput2Digit0 = !orIsInput2Digit0;
-            reLoadShaders();
+            Simulator_ToggleInput(&g_CircuitSim, CIRCUIT_OR_IN2);
             g_LeftMouseButtonPressed = false;
         }
 
@@ -1008,6 +1360,9 @@ int main(int argc, char* argv[])
         NotCircuit.isHovered = RayIntersectsAABB(camera_position_c, rayVec, NotCircuit.bbox);
         OrCircuit.isHovered = RayIntersectsAABB(camera_position_c, rayVec, OrCircuit.bbox);
 
+        pickingZone.End();
+        ProfileZone collisionsZone("collisions");
+
         // Define a hitsphere da câmera
         Sphere cameraSphere = {camera_position_c, 0.2f};
         Sphere skySphere = {glm::vec3(0.0f,0.0f,0.0f), -farplane/2.0f};
@@ -1026,9 +1381,14 @@ int main(int argc, char* argv[])
             cameraCollisionOffset = {0.0f, 0.0f, 0.0f, 0.0f};
         }
 
+        collisionsZone.End();
+
         glUniformMatrix4fv(g_view_uniform, 1, GL_FALSE, glm::value_ptr(viewMatrix));
         glUniformMatrix4fv(g_projection_uniform, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
 
+        ProfileZone textZone("text");
+        GpuProfileZone hudGpuZone("hud");
+
         // Imprimimos na tela os ângulos de Euler que controlam a rotação do
         // terceiro cubo.
         TextRendering_ShowMouseCoords(window);
@@ -1046,9 +1406,15 @@ int main(int argc, char* argv[])
         // por segundo (frames per second).
         TextRendering_ShowFramesPerSecond(window);
 
+        // Imprimimos na tela o tempo de CPU de cada zona do profiler.
+        TextRendering_ShowProfiler(window);
+
+        hudGpuZone.End();
+        textZone.End();
+
         // Cálculo de delta logo antes do glfwSwapBuffers para tentar minimizar o atraso da geração de imagens
         // Atualiza delta de tempo
-        float current_time = (float)glfwGetTime();
+        float current_time = (float)getTime();
         float delta_t = current_time - prev_time;
         prev_time = current_time;
 
@@ -1070,26 +1436,77 @@ int main(int argc, char* argv[])
             // Movimenta câmera para direita
             camera_movement += camera_u * speed * delta_t;
 
+        // As imagens de referência são comparadas com o quadro antes da troca
+        // de buffers, enquanto ele ainda pode ser lido.
+        if ( Golden_IsRunning() && !Golden_EndFrame() )
+            setWindowShouldClose(window);
+
         // O framebuffer onde OpenGL executa as operações de renderização não
         // é o mesmo que está sendo mostrado para o usuário, caso contrário
         // seria possível ver artefatos conhecidos como "screen tearing". A
         // chamada abaixo faz a troca dos buffers, mostrando para o usuário
         // tudo que foi renderizado pelas funções acima.
         // Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
-        glfwSwapBuffers(window);
+        {
+            PROFILE_ZONE("swap");
+            swapBuffers(window);
+        }
+
+        // Fecha os contadores de chamadas OpenGL do quadro (cmake -DGL_STATS=ON).
+        GLStats_EndFrame();
+
+        if ( Benchmark_IsRunning() && !Benchmark_EndFrame() )
+            setWindowShouldClose(window);
+
+        frameCount += 1;
+        if ( maxFrames > 0 && frameCount >= maxFrames )
+            setWindowShouldClose(window);
+
+        // Ao fim do primeiro quadro todos os modelos utilizados já foram
+        // carregados; imprimimos então as estatísticas de inicialização.
+        if (!startupStatsPrinted)
+        {
+            printf("Inicialização: primeiro quadro em %.1f ms desde glfwInit() (ou createHeadlessContext()), pico de memória de %.1f MB.\n",
+                   1000.0 * getTime(), GetPeakResidentMemory() / (1024.0 * 1024.0));
+            if ( netlistFilename != NULL )
+                printf("Netlist \"%s\": %.1f MB e %u portas lidos em %.1f ms (%.1f MB/s, %.2f M portas/s).\n",
+                       netlistFilename, netlistStats.bytes / (1024.0 * 1024.0), Netlist_NumGates(&g_Circuits),
+                       1000.0 * netlistStats.seconds, netlistStats.bytes / (1024.0 * 1024.0) / netlistStats.seconds,
+                       Netlist_NumGates(&g_Circuits) / netlistStats.seconds / 1e6);
+            startupStatsPrinted = true;
+
+            // Os modelos são carregados sob demanda durante o primeiro
+            // quadro (veja "assets.h"), então ele também faz parte do trace.
+            Trace_End();
+        }
 
         // Verificamos com o sistema operacional se houve alguma interação do
         // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
         // definidas anteriormente usando glfwSet*Callback() serão chamadas
         // pela biblioteca GLFW.
-        glfwPollEvents();
+        {
+            PROFILE_ZONE("events");
+            pollEvents();
+        }
     }
 
+    // Imprimimos quais assets foram utilizados durante a execução
+    Assets_ReportUsage();
+
+    if ( Benchmark_IsRunning() )
+        Benchmark_WriteReport();
+
+    int exitStatus = 0;
+    if ( Golden_IsRunning() && !Golden_Finish() )
+        exitStatus = EXIT_FAILURE;
+
+    ShaderReload_Shutdown();
+
     // Finalizamos o uso dos recursos do sistema operacional
-    glfwTerminate();
+    terminateWindow();
 
     // Fim do programa
-    return 0;
+    return exitStatus;
 }
 
 
@@ -0,0 +1,79 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+bool MappedFile_Open(const char* filename, MappedFile* mapped)
+{
+    mapped->data = NULL;
+    mapped->size = 0;
+
+#ifdef _WIN32
+    mapped->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if ( mapped->file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(mapped->file, &size);
+    mapped->size = (size_t)size.QuadPart;
+    mapped->mapping = NULL;
+    if ( mapped->size == 0 )
+        return true;
+
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if ( mapped->mapping == NULL )
+    {
+        CloseHandle(mapped->file);
+        return false;
+    }
+    mapped->data = (const char*)MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+    return mapped->data != NULL;
+#else
+    int fd = open(filename, O_RDONLY);
+    if ( fd < 0 )
+        return false;
+
+    struct stat st;
+    if ( fstat(fd, &st) != 0 )
+    {
+        close(fd);
+        return false;
+    }
+
+    mapped->size = (size_t)st.st_size;
+    if ( mapped->size > 0 )
+    {
+        void* data = mmap(NULL, mapped->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if ( data == MAP_FAILED )
+        {
+            close(fd);
+            return false;
+        }
+        madvise(data, mapped->size, MADV_SEQUENTIAL);
+        mapped->data = (const char*)data;
+    }
+    close(fd);
+    return true;
+#endif
+}
+
+void MappedFile_Close(MappedFile* mapped)
+{
+#ifdef _WIN32
+    if ( mapped->data != NULL )
+        UnmapViewOfFile(mapped->data);
+    if ( mapped->mapping != NULL )
+        CloseHandle(mapped->mapping);
+    CloseHandle(mapped->file);
+#else
+    if ( mapped->data != NULL )
+        munmap((void*)mapped->data, mapped->size);
+#endif
+    mapped->data = NULL;
+}
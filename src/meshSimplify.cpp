@@ -0,0 +1,293 @@
+#include "meshSimplify.h"
+
+#include <cmath>
+#include <queue>
+#include <algorithm>
+#include <unordered_map>
+
+// Quádrica de erro: matriz simétrica 4x4 armazenada pelos seus 10
+// coeficientes distintos. Para um plano n.p + d = 0, Q = [n*n^T, n*d; d*n^T, d^2].
+struct Quadric
+{
+    double a00, a01, a02, a03;
+    double      a11, a12, a13;
+    double           a22, a23;
+    double                a33;
+};
+
+static void Quadric_Zero(Quadric* q)
+{
+    q->a00 = q->a01 = q->a02 = q->a03 = 0.0;
+    q->a11 = q->a12 = q->a13 = 0.0;
+    q->a22 = q->a23 = 0.0;
+    q->a33 = 0.0;
+}
+
+static void Quadric_AddPlane(Quadric* q, double nx, double ny, double nz, double d, double weight)
+{
+    q->a00 += weight*nx*nx; q->a01 += weight*nx*ny; q->a02 += weight*nx*nz; q->a03 += weight*nx*d;
+    q->a11 += weight*ny*ny; q->a12 += weight*ny*nz; q->a13 += weight*ny*d;
+    q->a22 += weight*nz*nz; q->a23 += weight*nz*d;
+    q->a33 += weight*d*d;
+}
+
+static void Quadric_Add(Quadric* q, const Quadric& r)
+{
+    q->a00 += r.a00; q->a01 += r.a01; q->a02 += r.a02; q->a03 += r.a03;
+    q->a11 += r.a11; q->a12 += r.a12; q->a13 += r.a13;
+    q->a22 += r.a22; q->a23 += r.a23;
+    q->a33 += r.a33;
+}
+
+// Avalia p^T Q p, isto é, a soma das distâncias ao quadrado de p aos planos da quádrica.
+static double Quadric_Eval(const Quadric& q, const float* p)
+{
+    double x = p[0], y = p[1], z = p[2];
+    return q.a00*x*x + 2.0*q.a01*x*y + 2.0*q.a02*x*z + 2.0*q.a03*x
+         + q.a11*y*y + 2.0*q.a12*y*z + 2.0*q.a13*y
+         + q.a22*z*z + 2.0*q.a23*z
+         + q.a33;
+}
+
+// Candidato a colapso "from -> to", com os contadores de versão dos dois
+// vértices no momento em que o custo foi calculado. Se algum dos vértices foi
+// modificado desde então, o candidato é descartado ao ser retirado da fila.
+struct Collapse
+{
+    double   cost;
+    unsigned from;
+    unsigned to;
+    unsigned version_from;
+    unsigned version_to;
+
+    bool operator<(const Collapse& other) const { return cost > other.cost; } // min-heap
+};
+
+static void TriangleNormal(const float* a, const float* b, const float* c, double* n)
+{
+    double ux = b[0]-a[0], uy = b[1]-a[1], uz = b[2]-a[2];
+    double vx = c[0]-a[0], vy = c[1]-a[1], vz = c[2]-a[2];
+    n[0] = uy*vz - uz*vy;
+    n[1] = uz*vx - ux*vz;
+    n[2] = ux*vy - uy*vx;
+}
+
+// Insere na fila o colapso "from -> to", caso "from" possa ser movido.
+static void PushCollapse(std::priority_queue<Collapse>* heap, const std::vector<Quadric>& quadrics,
+                         const std::vector<float>& positions, const std::vector<char>& locked,
+                         const std::vector<unsigned>& version, unsigned from, unsigned to)
+{
+    if ( locked[from] )
+        return;
+
+    Quadric q = quadrics[from];
+    Quadric_Add(&q, quadrics[to]);
+
+    Collapse c;
+    c.cost = Quadric_Eval(q, &positions[3*to]);
+    c.from = from;
+    c.to = to;
+    c.version_from = version[from];
+    c.version_to = version[to];
+    heap->push(c);
+}
+
+// Copia os triângulos restantes da malha para um nível de detalhe.
+static void TakeSnapshot(const std::vector<unsigned>& tri, const std::vector<char>& alive,
+                         std::vector<unsigned>* lod, std::vector<unsigned>* source)
+{
+    for (size_t t = 0; t < alive.size(); ++t)
+        if ( alive[t] )
+        {
+            lod->push_back(tri[3*t + 0]);
+            lod->push_back(tri[3*t + 1]);
+            lod->push_back(tri[3*t + 2]);
+            source->push_back((unsigned)t);
+        }
+}
+
+void SimplifyMeshChain(
+    const std::vector<float>&    positions,
+    const std::vector<unsigned>& triangles,
+    const std::vector<size_t>&   targets,
+    double                       max_error,
+    std::vector< std::vector<unsigned> >* lods,
+    std::vector< std::vector<unsigned> >* sources)
+{
+    const size_t num_vertices  = positions.size() / 3;
+    const size_t num_triangles = triangles.size() / 3;
+
+    lods->assign(targets.size(), std::vector<unsigned>());
+    sources->assign(targets.size(), std::vector<unsigned>());
+
+    std::vector<unsigned> tri(triangles);          // Triângulos com os índices atualizados pelos colapsos
+    std::vector<char>     alive(num_triangles, 1);
+    size_t                live_triangles = num_triangles;
+
+    // Adjacência vértice -> triângulos. Ao colapsar "from -> to", a lista de
+    // "from" é concatenada à de "to".
+    std::vector< std::vector<unsigned> > vertex_triangles(num_vertices);
+    for (size_t t = 0; t < num_triangles; ++t)
+        for (int k = 0; k < 3; ++k)
+            vertex_triangles[tri[3*t + k]].push_back((unsigned)t);
+
+    // Quádricas iniciais: soma dos planos dos triângulos adjacentes, com peso
+    // proporcional à área de cada triângulo.
+    std::vector<Quadric> quadrics(num_vertices);
+    for (size_t v = 0; v < num_vertices; ++v)
+        Quadric_Zero(&quadrics[v]);
+
+    for (size_t t = 0; t < num_triangles; ++t)
+    {
+        const float* a = &positions[3*tri[3*t + 0]];
+        const float* b = &positions[3*tri[3*t + 1]];
+        const float* c = &positions[3*tri[3*t + 2]];
+        double n[3];
+        TriangleNormal(a, b, c, n);
+        double length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if ( length == 0.0 )
+            continue;
+        n[0] /= length; n[1] /= length; n[2] /= length;
+        double d = -(n[0]*a[0] + n[1]*a[1] + n[2]*a[2]);
+        for (int k = 0; k < 3; ++k)
+            Quadric_AddPlane(&quadrics[tri[3*t + k]], n[0], n[1], n[2], d, 0.5 * length);
+    }
+
+    // Vértices em arestas de borda (arestas com um único triângulo) ficam fixos.
+    std::vector<char> locked(num_vertices, 0);
+    {
+        std::unordered_map<unsigned long long, unsigned> edge_count;
+        edge_count.reserve(3 * num_triangles);
+        for (size_t t = 0; t < num_triangles; ++t)
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned long long i = tri[3*t + k], j = tri[3*t + (k+1)%3];
+                unsigned long long key = (std::min(i, j) << 32) | std::max(i, j);
+                edge_count[key] += 1;
+            }
+        for (std::unordered_map<unsigned long long, unsigned>::const_iterator it = edge_count.begin(); it != edge_count.end(); ++it)
+            if ( it->second == 1 )
+            {
+                locked[it->first >> 32] = 1;
+                locked[it->first & 0xFFFFFFFFULL] = 1;
+            }
+    }
+
+    std::vector<unsigned> version(num_vertices, 0);
+    std::vector<char>     removed(num_vertices, 0);
+    std::priority_queue<Collapse> heap;
+
+    for (size_t t = 0; t < num_triangles; ++t)
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned i = tri[3*t + k], j = tri[3*t + (k+1)%3];
+            PushCollapse(&heap, quadrics, positions, locked, version, i, j);
+            PushCollapse(&heap, quadrics, positions, locked, version, j, i);
+        }
+
+    size_t level = 0;
+    std::vector<unsigned> neighbors;
+
+    while ( level < targets.size() && !heap.empty() )
+    {
+        if ( live_triangles <= targets[level] )
+        {
+            TakeSnapshot(tri, alive, &(*lods)[level], &(*sources)[level]);
+            level += 1;
+            continue;
+        }
+
+        Collapse c = heap.top();
+        heap.pop();
+
+        if ( removed[c.from] || removed[c.to] )
+            continue;
+        if ( c.version_from != version[c.from] || c.version_to != version[c.to] )
+            continue;
+        if ( c.cost > max_error )
+            break;
+
+        // Rejeitamos colapsos que invertem (ou degeneram) algum triângulo
+        // adjacente a "from" que permanece na malha.
+        bool flips = false;
+        const float* p_to = &positions[3*c.to];
+        for (size_t i = 0; i < vertex_triangles[c.from].size() && !flips; ++i)
+        {
+            unsigned t = vertex_triangles[c.from][i];
+            if ( !alive[t] )
+                continue;
+            const unsigned* v = &tri[3*t];
+            if ( v[0] == c.to || v[1] == c.to || v[2] == c.to )
+                continue;
+
+            const float* p[3];
+            const float* q[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                p[k] = &positions[3*v[k]];
+                q[k] = (v[k] == c.from) ? p_to : p[k];
+            }
+            double n0[3], n1[3];
+            TriangleNormal(p[0], p[1], p[2], n0);
+            TriangleNormal(q[0], q[1], q[2], n1);
+            double dot = n0[0]*n1[0] + n0[1]*n1[1] + n0[2]*n1[2];
+            double len0 = std::sqrt(n0[0]*n0[0] + n0[1]*n0[1] + n0[2]*n0[2]);
+            double len1 = std::sqrt(n1[0]*n1[0] + n1[1]*n1[1] + n1[2]*n1[2]);
+            if ( dot <= 0.2 * len0 * len1 )
+                flips = true;
+        }
+        if ( flips )
+            continue;
+
+        // Efetua o colapso: todos os triângulos de "from" passam a usar "to"
+        removed[c.from] = 1;
+        Quadric_Add(&quadrics[c.to], quadrics[c.from]);
+
+        for (size_t i = 0; i < vertex_triangles[c.from].size(); ++i)
+        {
+            unsigned t = vertex_triangles[c.from][i];
+            if ( !alive[t] )
+                continue;
+            unsigned* v = &tri[3*t];
+            for (int k = 0; k < 3; ++k)
+                if ( v[k] == c.from )
+                    v[k] = c.to;
+            if ( v[0] == v[1] || v[1] == v[2] || v[0] == v[2] )
+            {
+                alive[t] = 0;
+                live_triangles -= 1;
+            }
+            else
+            {
+                vertex_triangles[c.to].push_back(t);
+            }
+        }
+        std::vector<unsigned>().swap(vertex_triangles[c.from]);
+
+        // Compacta a lista de "to" e recalcula os custos de suas arestas
+        std::vector<unsigned>& list = vertex_triangles[c.to];
+        list.erase(std::remove_if(list.begin(), list.end(), [&alive](unsigned t) { return !alive[t]; }), list.end());
+
+        version[c.to] += 1;
+        neighbors.clear();
+        for (size_t i = 0; i < list.size(); ++i)
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned n = tri[3*list[i] + k];
+                if ( n != c.to )
+                    neighbors.push_back(n);
+            }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+        for (size_t i = 0; i < neighbors.size(); ++i)
+        {
+            PushCollapse(&heap, quadrics, positions, locked, version, c.to, neighbors[i]);
+            PushCollapse(&heap, quadrics, positions, locked, version, neighbors[i], c.to);
+        }
+    }
+
+    // Alvos não atingidos (erro máximo ou fila vazia) recebem a malha atual.
+    for (; level < targets.size(); ++level)
+        TakeSnapshot(tri, alive, &(*lods)[level], &(*sources)[level]);
+}
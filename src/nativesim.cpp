@@ -0,0 +1,279 @@
+#include "nativesim.h"
+#include "bitsim.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <sys/stat.h>
+#endif
+
+#define NATIVESIM_CACHE_DIR "native_cache"
+#define NATIVESIM_VERSION   2u // Incrementar quando o código gerado ou o hash do cache mudar
+#define NATIVESIM_FLAGS     "-O1 -shared -fPIC"
+
+static unsigned long long HashBytes(unsigned long long h, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+template <typename T>
+static unsigned long long HashVector(unsigned long long h, const std::vector<T>& v)
+{
+    size_t size = v.size();
+    h = HashBytes(h, &size, sizeof(size));
+    return v.empty() ? h : HashBytes(h, v.data(), v.size() * sizeof(T));
+}
+
+// Grava o código C++ das instruções de "compiled".
+static bool WriteSource(const char* filename, const CompiledSim* compiled)
+{
+    FILE* file = fopen(filename, "w");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot create generated netlist source \"%s\".\n", filename);
+        return false;
+    }
+
+    fprintf(file, "// Gerado por NativeSim_Build() (veja \"nativesim.h\"). Não editar.\n");
+    fprintf(file, "#include <stdint.h>\n\n");
+
+    // Na ordem de COMPILEDSIM_*
+    static const char* const formats[] = {
+        "  v[%u] = v[%u];\n",
+        "  v[%u] = ~v[%u];\n",
+        "  v[%u] = v[%u] & v[%u];\n",
+        "  v[%u] = v[%u] | v[%u];\n",
+        "  v[%u] = ~(v[%u] & v[%u]);\n",
+        "  v[%u] = ~(v[%u] | v[%u]);\n",
+        "  v[%u] = v[%u] ^ v[%u];\n",
+        "  v[%u] = ~(v[%u] ^ v[%u]);\n",
+    };
+
+    size_t num_ops = compiled->code.size() - 1; // Sem COMPILEDSIM_HALT
+    size_t num_blocks = (num_ops + NATIVESIM_BLOCK_SIZE - 1) / NATIVESIM_BLOCK_SIZE;
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        fprintf(file, "static void block_%zu(uint64_t* __restrict v)\n{\n", b);
+        size_t end = (b + 1) * NATIVESIM_BLOCK_SIZE < num_ops ? (b + 1) * NATIVESIM_BLOCK_SIZE : num_ops;
+        for (size_t i = b * NATIVESIM_BLOCK_SIZE; i < end; ++i)
+        {
+            const CompiledOp& op = compiled->code[i];
+            fprintf(file, formats[op.opcode], op.out, op.a, op.b);
+        }
+        fprintf(file, "}\n\n");
+    }
+
+    fprintf(file, "extern \"C\" void netlist_eval(uint64_t* v)\n{\n");
+    for (size_t b = 0; b < num_blocks; ++b)
+        fprintf(file, "  block_%zu(v);\n", b);
+    fprintf(file, "}\n");
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if ( !ok )
+        fprintf(stderr, "ERROR: Cannot write generated netlist source \"%s\".\n", filename);
+    return ok;
+}
+
+bool NativeSim_Build(NativeSim* sim, const Netlist* netlist)
+{
+    sim->library = NULL;
+    sim->run = NULL;
+    sim->cached = false;
+    sim->runs = 0;
+    sim->seconds = 0.0;
+
+#ifdef _WIN32
+    (void)netlist;
+    fprintf(stderr, "ERROR: Native netlist compilation is not supported on Windows.\n");
+    return false;
+#else
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if ( !CompiledSim_Compile(&sim->compiled, netlist) )
+        return false;
+
+    const char* compiler = getenv("CXX");
+    std::string command = std::string(compiler != NULL && compiler[0] != '\0' ? compiler : "c++") + " " NATIVESIM_FLAGS;
+
+    // O hash cobre exatamente o que é emitido: as instruções, na numeração
+    // compilada, e o número de nets compiladas (o tamanho de "values" que o
+    // código supõe). A estrutura do netlist não basta: nets sem porta que não
+    // são entradas (fios soltos, saídas de registradores, clocks) deslocam a
+    // numeração sem mudar as portas.
+    unsigned long long hash = 14695981039346656037ULL;
+    unsigned int version[2] = { NATIVESIM_VERSION, NATIVESIM_BLOCK_SIZE };
+    hash = HashBytes(hash, version, sizeof(version));
+    hash = HashBytes(hash, command.c_str(), command.size() + 1);
+    hash = HashVector(hash, sim->compiled.code);
+    size_t num_values = sim->compiled.values.size();
+    hash = HashBytes(hash, &num_values, sizeof(num_values));
+
+    char name[64];
+    snprintf(name, sizeof(name), NATIVESIM_CACHE_DIR "/netlist_%016llx", hash);
+    sim->library_path = std::string(name) + ".so";
+
+    struct stat info;
+    if ( stat(sim->library_path.c_str(), &info) == 0 )
+        sim->cached = true;
+    else
+    {
+        mkdir(NATIVESIM_CACHE_DIR, 0755);
+
+        // Compila para um arquivo temporário e o renomeia só no fim, para
+        // que uma compilação interrompida não deixe uma biblioteca inválida
+        // no cache.
+        std::string source = std::string(name) + ".cpp";
+        std::string temporary = std::string(name) + ".tmp.so";
+        if ( !WriteSource(source.c_str(), &sim->compiled) )
+            return false;
+
+        printf("Compilando o netlist (%zu instruções) para \"%s\"...\n", sim->compiled.code.size() - 1, sim->library_path.c_str());
+        fflush(stdout);
+        std::string compile = command + " -o \"" + temporary + "\" \"" + source + "\"";
+        if ( system(compile.c_str()) != 0 )
+        {
+            fprintf(stderr, "ERROR: Native netlist compilation failed: %s\n", compile.c_str());
+            remove(temporary.c_str());
+            return false;
+        }
+        remove(source.c_str());
+        if ( rename(temporary.c_str(), sim->library_path.c_str()) != 0 )
+        {
+            fprintf(stderr, "ERROR: Cannot move \"%s\" to the native netlist cache.\n", temporary.c_str());
+            remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    // Caminho com "/", para que dlopen() não busque nos diretórios do sistema.
+    sim->library = dlopen(("./" + sim->library_path).c_str(), RTLD_NOW | RTLD_LOCAL);
+    if ( sim->library == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot load native netlist \"%s\": %s\n", sim->library_path.c_str(), dlerror());
+        return false;
+    }
+    sim->run = (NativeSimFunction)dlsym(sim->library, "netlist_eval");
+    if ( sim->run == NULL )
+    {
+        fprintf(stderr, "ERROR: Native netlist \"%s\" has no netlist_eval().\n", sim->library_path.c_str());
+        NativeSim_Release(sim);
+        return false;
+    }
+
+    sim->values.assign(Netlist_NumNets(netlist), 0);
+    for (size_t i = 0; i < netlist->inputs.size(); ++i)
+        NativeSim_SetInput(sim, (int)i, Netlist_GetInput(netlist, (int)i) ? ~(uint64_t)0 : 0);
+
+    sim->build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+#endif
+}
+
+void NativeSim_Release(NativeSim* sim)
+{
+#ifndef _WIN32
+    if ( sim->library != NULL )
+        dlclose(sim->library);
+#endif
+    sim->library = NULL;
+    sim->run = NULL;
+}
+
+void NativeSim_SetInput(NativeSim* sim, int input, uint64_t lanes)
+{
+    sim->values[sim->compiled.net_index[sim->compiled.netlist->inputs[input]]] = lanes;
+}
+
+void NativeSim_Run(NativeSim* sim)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    sim->run(sim->values.data());
+    sim->runs += 1;
+    sim->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Gerador pseudoaleatório (xorshift) dos vetores de entrada.
+static uint64_t NextRandom64(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+void NativeSim_Benchmark(const Netlist* netlist)
+{
+    NativeSim native;
+    if ( !NativeSim_Build(&native, netlist) )
+        return;
+    printf("  código nativo: \"%s\" %s em %.1f ms\n", native.library_path.c_str(),
+           native.cached ? "carregado do cache" : "gerado e compilado", 1000.0 * native.build_seconds);
+
+    BitSimulator bitsim;
+    if ( !BitSim_Init(&bitsim, netlist, 64) )
+    {
+        NativeSim_Release(&native);
+        return;
+    }
+    CompiledSim& compiled = native.compiled;
+
+    // Os três recebem os mesmos vetores; o interpretador da simulação
+    // compilada só simula o primeiro (bit 0).
+    const double min_seconds = 0.5;
+    uint64_t seed = 88172645463325252ull;
+    bool ok = true;
+    while ( ok && (native.seconds < min_seconds || bitsim.seconds < min_seconds || compiled.seconds < min_seconds) )
+    {
+        for (size_t i = 0; i < netlist->inputs.size(); ++i)
+        {
+            uint64_t lanes = NextRandom64(&seed);
+            NativeSim_SetInput(&native, (int)i, lanes);
+            BitSim_SetInput(&bitsim, (int)i, &lanes);
+            CompiledSim_SetInput(&compiled, (int)i, lanes & 1);
+        }
+        if ( native.seconds < min_seconds )
+            NativeSim_Run(&native);
+        if ( bitsim.seconds < min_seconds )
+            BitSim_Run(&bitsim);
+        if ( compiled.seconds < min_seconds )
+            CompiledSim_Run(&compiled);
+
+        // Confere as primeiras execuções, em que todos receberam os mesmos vetores.
+        if ( native.runs <= 4 && native.runs == bitsim.runs && native.runs == compiled.runs )
+        {
+            for (uint32_t n = 0; ok && n < Netlist_NumNets(netlist); ++n)
+            {
+                uint64_t lanes = NativeSim_GetNet(&native, n);
+                if ( lanes != BitSim_GetNet(&bitsim, n)[0] || (lanes & 1) != (uint64_t)CompiledSim_GetNet(&compiled, n) )
+                {
+                    fprintf(stderr, "ERROR: Native simulation disagrees with the bit-parallel simulation on net \"%s\".\n",
+                            Netlist_NetName(netlist, n));
+                    ok = false;
+                }
+            }
+        }
+    }
+
+    if ( ok )
+    {
+        double gates = Netlist_NumGates(netlist);
+        printf("  %-18s  %8.3f ms  %6.1f M avaliações/s\n", "interpretado",
+               1000.0 * compiled.seconds / compiled.runs, compiled.runs * gates / compiled.seconds / 1e6);
+        printf("  %-18s  %8.3f ms  %6.1f M avaliações/s\n", "bit-paralelo 64",
+               1000.0 * bitsim.seconds / bitsim.runs, bitsim.runs * gates * 64 / bitsim.seconds / 1e6);
+        printf("  %-18s  %8.3f ms  %6.1f M avaliações/s\n", "nativo 64",
+               1000.0 * native.seconds / native.runs, native.runs * gates * 64 / native.seconds / 1e6);
+    }
+    NativeSim_Release(&native);
+}
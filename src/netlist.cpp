@@ -0,0 +1,301 @@
+#include "netlist.h"
+
+#include <cstdio>
+#include <cstring>
+
+uint32_t Netlist_AddNet(Netlist* netlist, const char* name)
+{
+    uint32_t net = Netlist_NumNets(netlist);
+    netlist->net_value.push_back(0);
+    netlist->net_driver.push_back(NETLIST_NONE);
+    netlist->net_name_offset.push_back((uint32_t)netlist->net_names.size());
+    netlist->net_names.insert(netlist->net_names.end(), name, name + strlen(name) + 1);
+    return net;
+}
+
+uint32_t Netlist_AddInput(Netlist* netlist, const char* name)
+{
+    uint32_t net = Netlist_AddNet(netlist, name);
+    netlist->inputs.push_back(net);
+    return net;
+}
+
+void Netlist_AddOutput(Netlist* netlist, uint32_t net)
+{
+    netlist->outputs.push_back(net);
+}
+
+uint32_t Netlist_AddGate(Netlist* netlist, int type, const uint32_t* inputs, int num_inputs, uint32_t output)
+{
+    uint32_t gate = Netlist_NumGates(netlist);
+    if ( netlist->gate_input_begin.empty() )
+        netlist->gate_input_begin.push_back(0);
+
+    netlist->gate_type.push_back((uint8_t)type);
+    netlist->gate_output.push_back(output);
+    netlist->gate_inputs.insert(netlist->gate_inputs.end(), inputs, inputs + num_inputs);
+    netlist->gate_input_begin.push_back((uint32_t)netlist->gate_inputs.size());
+    return gate;
+}
+
+uint32_t Netlist_AddRegister(Netlist* netlist, int type, uint32_t d, uint32_t clock, uint32_t q, bool init)
+{
+    uint32_t reg = Netlist_NumRegisters(netlist);
+    netlist->reg_type.push_back((uint8_t)type);
+    netlist->reg_d.push_back(d);
+    netlist->reg_clock.push_back(clock);
+    netlist->reg_q.push_back(q);
+    netlist->reg_init.push_back(init ? 1 : 0);
+    return reg;
+}
+
+void Netlist_AddClock(Netlist* netlist, uint32_t net)
+{
+    for (size_t i = 0; i < netlist->clocks.size(); ++i)
+        if ( netlist->clocks[i] == net )
+            return;
+    netlist->clocks.push_back(net);
+}
+
+bool Netlist_Finalize(Netlist* netlist)
+{
+    uint32_t num_gates = Netlist_NumGates(netlist);
+    uint32_t num_nets = Netlist_NumNets(netlist);
+    if ( netlist->gate_input_begin.empty() )
+        netlist->gate_input_begin.push_back(0);
+
+    // Cada net é dirigida por no máximo uma porta, e as entradas primárias
+    // por nenhuma. Os simuladores leem a primeira entrada de toda porta sem
+    // conferir: BUF e NOT têm exatamente uma entrada, e as demais, ao menos
+    // uma.
+    std::vector<uint32_t>& driver = netlist->net_driver;
+    driver.assign(num_nets, NETLIST_NONE);
+    for (uint32_t g = 0; g < num_gates; ++g)
+    {
+        uint32_t net = netlist->gate_output[g];
+        if ( net >= num_nets )
+        {
+            fprintf(stderr, "ERROR: Netlist gate %u drives an invalid net.\n", g);
+            return false;
+        }
+        int type = netlist->gate_type[g];
+        uint32_t num_inputs = netlist->gate_input_begin[g + 1] - netlist->gate_input_begin[g];
+        if ( type > GATE_XNOR || num_inputs == 0 || ((type == GATE_BUF || type == GATE_NOT) && num_inputs != 1) )
+        {
+            fprintf(stderr, "ERROR: Netlist gate driving \"%s\" has an invalid type or number of inputs (%u).\n",
+                    Netlist_NetName(netlist, net), num_inputs);
+            return false;
+        }
+        if ( driver[net] != NETLIST_NONE )
+        {
+            fprintf(stderr, "ERROR: Netlist net \"%s\" has more than one driver.\n", Netlist_NetName(netlist, net));
+            return false;
+        }
+        driver[net] = g;
+    }
+    for (size_t i = 0; i < netlist->inputs.size(); ++i)
+    {
+        if ( driver[netlist->inputs[i]] != NETLIST_NONE )
+        {
+            fprintf(stderr, "ERROR: Netlist input \"%s\" is driven by a gate.\n", Netlist_NetName(netlist, netlist->inputs[i]));
+            return false;
+        }
+    }
+
+    // A saída de um registrador e os clocks também não têm outro driver, e
+    // os flip-flops só podem usar clocks (a simulação por ciclos não conhece
+    // as bordas de outras nets).
+    std::vector<uint8_t> is_clock(num_nets, 0);
+    for (size_t i = 0; i < netlist->clocks.size(); ++i)
+    {
+        uint32_t net = netlist->clocks[i];
+        if ( net >= num_nets || driver[net] != NETLIST_NONE )
+        {
+            fprintf(stderr, "ERROR: Netlist clock \"%s\" is driven by a gate.\n", net < num_nets ? Netlist_NetName(netlist, net) : "?");
+            return false;
+        }
+        is_clock[net] = 1;
+    }
+    std::vector<uint8_t> is_q(num_nets, 0);
+    for (uint32_t r = 0; r < Netlist_NumRegisters(netlist); ++r)
+    {
+        uint32_t d = netlist->reg_d[r], clock = netlist->reg_clock[r], q = netlist->reg_q[r];
+        if ( d >= num_nets || clock >= num_nets || q >= num_nets )
+        {
+            fprintf(stderr, "ERROR: Netlist register %u refers to an invalid net.\n", r);
+            return false;
+        }
+        if ( driver[q] != NETLIST_NONE || is_q[q] || is_clock[q] )
+        {
+            fprintf(stderr, "ERROR: Netlist net \"%s\" has more than one driver.\n", Netlist_NetName(netlist, q));
+            return false;
+        }
+        if ( !Netlist_IsLatch(netlist->reg_type[r]) && !is_clock[clock] )
+        {
+            fprintf(stderr, "ERROR: Netlist flip-flop \"%s\" is clocked by \"%s\", which is not a clock.\n",
+                    Netlist_NetName(netlist, q), Netlist_NetName(netlist, clock));
+            return false;
+        }
+        is_q[q] = 1;
+    }
+    for (size_t i = 0; i < netlist->inputs.size(); ++i)
+    {
+        if ( is_q[netlist->inputs[i]] )
+        {
+            fprintf(stderr, "ERROR: Netlist input \"%s\" is driven by a register.\n", Netlist_NetName(netlist, netlist->inputs[i]));
+            return false;
+        }
+    }
+
+    // Fan-out em CSR: contamos os leitores de cada net, acumulamos os
+    // deslocamentos e então preenchemos as posições (counting sort).
+    std::vector<uint32_t>& begin = netlist->net_fanout_begin;
+    begin.assign(num_nets + 1, 0);
+    for (size_t i = 0; i < netlist->gate_inputs.size(); ++i)
+    {
+        uint32_t net = netlist->gate_inputs[i];
+        if ( net >= num_nets )
+        {
+            fprintf(stderr, "ERROR: Netlist gate input refers to an invalid net.\n");
+            return false;
+        }
+        begin[net + 1] += 1;
+    }
+    for (uint32_t n = 0; n < num_nets; ++n)
+        begin[n + 1] += begin[n];
+
+    std::vector<uint32_t> next(begin.begin(), begin.end() - 1);
+    netlist->net_fanout.resize(netlist->gate_inputs.size());
+    for (uint32_t g = 0; g < num_gates; ++g)
+        for (uint32_t i = netlist->gate_input_begin[g]; i < netlist->gate_input_begin[g + 1]; ++i)
+            netlist->net_fanout[next[netlist->gate_inputs[i]]++] = g;
+
+    return true;
+}
+
+bool Netlist_Levelize(const Netlist* netlist, std::vector<uint32_t>* order, std::vector<uint32_t>* level_begin)
+{
+    uint32_t num_gates = Netlist_NumGates(netlist);
+
+    // Ordem topológica (algoritmo de Kahn): "pending" conta as entradas de
+    // cada porta que ainda não foram calculadas. Uma porta entra na fila
+    // quando todas foram, e seu nível é então definitivo.
+    std::vector<uint32_t> pending(num_gates, 0);
+    std::vector<uint32_t> level(num_gates, 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(num_gates);
+    for (uint32_t g = 0; g < num_gates; ++g)
+    {
+        for (uint32_t i = netlist->gate_input_begin[g]; i < netlist->gate_input_begin[g + 1]; ++i)
+            if ( netlist->net_driver[netlist->gate_inputs[i]] != NETLIST_NONE )
+                pending[g] += 1;
+        if ( pending[g] == 0 )
+            queue.push_back(g);
+    }
+
+    uint32_t num_levels = 0;
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        uint32_t g = queue[head];
+        uint32_t net = netlist->gate_output[g];
+        if ( level[g] + 1 > num_levels )
+            num_levels = level[g] + 1;
+        for (uint32_t k = netlist->net_fanout_begin[net]; k < netlist->net_fanout_begin[net + 1]; ++k)
+        {
+            uint32_t reader = netlist->net_fanout[k];
+            if ( level[reader] < level[g] + 1 )
+                level[reader] = level[g] + 1;
+            if ( --pending[reader] == 0 )
+                queue.push_back(reader);
+        }
+    }
+
+    if ( queue.size() != num_gates )
+    {
+        for (uint32_t g = 0; g < num_gates; ++g)
+        {
+            if ( pending[g] != 0 )
+            {
+                fprintf(stderr, "ERROR: Netlist has a combinational loop through net \"%s\".\n",
+                        Netlist_NetName(netlist, netlist->gate_output[g]));
+                break;
+            }
+        }
+        return false;
+    }
+
+    // Agrupa as portas por nível (counting sort), mantendo a ordem dos
+    // índices dentro de cada nível.
+    std::vector<uint32_t> begin(num_levels + 1, 0);
+    for (uint32_t g = 0; g < num_gates; ++g)
+        begin[level[g] + 1] += 1;
+    for (uint32_t l = 0; l < num_levels; ++l)
+        begin[l + 1] += begin[l];
+
+    std::vector<uint32_t> next(begin.begin(), begin.end() - 1);
+    order->resize(num_gates);
+    for (uint32_t g = 0; g < num_gates; ++g)
+        (*order)[next[level[g]]++] = g;
+
+    if ( level_begin != NULL )
+        level_begin->swap(begin);
+    return true;
+}
+
+uint32_t Netlist_FindNet(const Netlist* netlist, const char* name)
+{
+    for (uint32_t n = 0; n < Netlist_NumNets(netlist); ++n)
+        if ( strcmp(Netlist_NetName(netlist, n), name) == 0 )
+            return n;
+    return NETLIST_NONE;
+}
+
+bool Netlist_GetInput(const Netlist* netlist, int input)
+{
+    if ( input < 0 || input >= (int)netlist->inputs.size() )
+        return false;
+    return netlist->net_value[netlist->inputs[input]] != 0;
+}
+
+void Netlist_SetInput(Netlist* netlist, int input, bool value)
+{
+    if ( input < 0 || input >= (int)netlist->inputs.size() )
+        return;
+    netlist->net_value[netlist->inputs[input]] = value ? 1 : 0;
+}
+
+bool Netlist_GetOutput(const Netlist* netlist, int output)
+{
+    if ( output < 0 || output >= (int)netlist->outputs.size() )
+        return false;
+    return netlist->net_value[netlist->outputs[output]] != 0;
+}
+
+void Netlist_BuildDemoCircuits(Netlist* netlist)
+{
+    // As entradas são adicionadas primeiro, na ordem de CIRCUIT_*_IN*.
+    uint32_t wire_in = Netlist_AddInput(netlist, "wire.in");
+    uint32_t not_in  = Netlist_AddInput(netlist, "not.in");
+    uint32_t and_in[2] = { Netlist_AddInput(netlist, "and.in1"), Netlist_AddInput(netlist, "and.in2") };
+    uint32_t or_in[2]  = { Netlist_AddInput(netlist, "or.in1"),  Netlist_AddInput(netlist, "or.in2") };
+
+    // Uma porta por circuito, cuja saída acende a lâmpada. O "circuito" do
+    // fio é um buffer.
+    uint32_t wire_lamp = Netlist_AddNet(netlist, "wire.lamp");
+    uint32_t not_lamp  = Netlist_AddNet(netlist, "not.lamp");
+    uint32_t and_lamp  = Netlist_AddNet(netlist, "and.lamp");
+    uint32_t or_lamp   = Netlist_AddNet(netlist, "or.lamp");
+
+    Netlist_AddGate(netlist, GATE_BUF, &wire_in, 1, wire_lamp);
+    Netlist_AddGate(netlist, GATE_NOT, &not_in, 1, not_lamp);
+    Netlist_AddGate(netlist, GATE_AND, and_in, 2, and_lamp);
+    Netlist_AddGate(netlist, GATE_OR, or_in, 2, or_lamp);
+
+    // Na ordem de CIRCUIT_*_LAMP
+    Netlist_AddOutput(netlist, wire_lamp);
+    Netlist_AddOutput(netlist, not_lamp);
+    Netlist_AddOutput(netlist, and_lamp);
+    Netlist_AddOutput(netlist, or_lamp);
+
+    Netlist_Finalize(netlist);
+}
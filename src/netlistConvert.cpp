@@ -0,0 +1,52 @@
+// Conversor de netlists em texto para o formato binário (veja
+// "netlistFile.h"):
+//
+//     netlistconv entrada.blif|entrada.v saida.nlb
+//
+// Depois de gravar, abre o arquivo gerado para conferi-lo e imprime os
+// tempos de leitura dos dois formatos.
+#include "netlistLoader.h"
+#include "netlistFile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+
+int main(int argc, char* argv[])
+{
+    if ( argc != 3 )
+    {
+        fprintf(stderr, "Uso: %s entrada.blif|entrada.v saida.nlb\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Netlist netlist;
+    NetlistLoadStats text;
+    if ( !NetlistLoader_Load(argv[1], &netlist, &text) )
+        return EXIT_FAILURE;
+    printf("\"%s\": %.1f MB, %u portas e %u nets lidos em %.1f ms (%.1f MB/s).\n", argv[1],
+           text.bytes / (1024.0 * 1024.0), Netlist_NumGates(&netlist), Netlist_NumNets(&netlist),
+           1000.0 * text.seconds, text.bytes / (1024.0 * 1024.0) / text.seconds);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if ( !NetlistFile_Write(argv[2], &netlist) )
+        return EXIT_FAILURE;
+    double write_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Netlist check;
+    NetlistLoadStats binary;
+    if ( !NetlistFile_Load(argv[2], &check, &binary, true) )
+        return EXIT_FAILURE;
+    if ( check.gate_type != netlist.gate_type || check.gate_inputs != netlist.gate_inputs
+      || check.net_fanout != netlist.net_fanout || check.net_names != netlist.net_names
+      || check.inputs != netlist.inputs || check.outputs != netlist.outputs
+      || check.reg_type != netlist.reg_type || check.reg_d != netlist.reg_d || check.reg_clock != netlist.reg_clock
+      || check.reg_q != netlist.reg_q || check.reg_init != netlist.reg_init || check.clocks != netlist.clocks )
+    {
+        fprintf(stderr, "ERROR: \"%s\" does not read back as the converted netlist.\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    printf("\"%s\": %.1f MB gravados em %.1f ms e lidos em %.1f ms (%.1fx mais rápido que o texto).\n", argv[2],
+           binary.bytes / (1024.0 * 1024.0), 1000.0 * write_seconds, 1000.0 * binary.seconds, text.seconds / binary.seconds);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,398 @@
+#include "netlistFile.h"
+#include "trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+
+// Checksum de palavras de 64 bits em quatro acumuladores independentes, para
+// que as multiplicações de palavras vizinhas não esperem umas pelas outras.
+// Os dados são consumidos em múltiplos de 8 bytes (as seções são alinhadas),
+// então gravar seção a seção dá o mesmo resultado que ler o arquivo inteiro.
+struct Checksum
+{
+    uint64_t lane[4];
+    uint64_t words;
+};
+
+static void Checksum_Init(Checksum* c)
+{
+    c->lane[0] = 0x9E3779B97F4A7C15ull;
+    c->lane[1] = 0xC2B2AE3D27D4EB4Full;
+    c->lane[2] = 0x165667B19E3779F9ull;
+    c->lane[3] = 0x27D4EB2F165667C5ull;
+    c->words = 0;
+}
+
+static void Checksum_Add(Checksum* c, const void* data, size_t size)
+{
+    const char* bytes = (const char*)data;
+    size_t num_words = size / 8;
+    size_t i = 0;
+
+    // Alinha a posição com o acumulador 0, para o laço principal.
+    for (; i < num_words && (c->words & 3) != 0; ++i)
+    {
+        uint64_t w;
+        memcpy(&w, bytes + 8 * i, 8);
+        uint64_t& h = c->lane[c->words & 3];
+        h = (h ^ w) * 0x100000001B3ull;
+        c->words += 1;
+    }
+    for (; i + 4 <= num_words; i += 4)
+    {
+        uint64_t w[4];
+        memcpy(w, bytes + 8 * i, 32);
+        c->lane[0] = (c->lane[0] ^ w[0]) * 0x100000001B3ull;
+        c->lane[1] = (c->lane[1] ^ w[1]) * 0x100000001B3ull;
+        c->lane[2] = (c->lane[2] ^ w[2]) * 0x100000001B3ull;
+        c->lane[3] = (c->lane[3] ^ w[3]) * 0x100000001B3ull;
+        c->words += 4;
+    }
+    for (; i < num_words; ++i)
+    {
+        uint64_t w;
+        memcpy(&w, bytes + 8 * i, 8);
+        uint64_t& h = c->lane[c->words & 3];
+        h = (h ^ w) * 0x100000001B3ull;
+        c->words += 1;
+    }
+}
+
+static uint64_t Checksum_Result(const Checksum* c)
+{
+    uint64_t h = c->words;
+    for (int k = 0; k < 4; ++k)
+    {
+        h ^= c->lane[k];
+        h *= 0x100000001B3ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static inline uint64_t Padded(uint64_t size) { return (size + 7) & ~(uint64_t)7; }
+
+bool NetlistFile_Write(const char* filename, const Netlist* netlist)
+{
+    TRACE_SCOPE("NetlistFile_Write");
+
+    uint32_t num_nets = Netlist_NumNets(netlist);
+    if ( netlist->gate_input_begin.size() != Netlist_NumGates(netlist) + 1 || netlist->net_fanout_begin.size() != num_nets + 1 )
+    {
+        fprintf(stderr, "ERROR: Cannot write netlist file \"%s\": the netlist is not finalized.\n", filename);
+        return false;
+    }
+
+    const void* data[NETLISTFILE_NUM_SECTIONS];
+    uint64_t size[NETLISTFILE_NUM_SECTIONS];
+#define NETLISTFILE_SECTION(id, v) data[id] = v.data(); size[id] = v.size() * sizeof(v[0])
+    NETLISTFILE_SECTION(NETLISTFILE_GATE_TYPE, netlist->gate_type);
+    NETLISTFILE_SECTION(NETLISTFILE_GATE_OUTPUT, netlist->gate_output);
+    NETLISTFILE_SECTION(NETLISTFILE_GATE_INPUT_BEGIN, netlist->gate_input_begin);
+    NETLISTFILE_SECTION(NETLISTFILE_GATE_INPUTS, netlist->gate_inputs);
+    NETLISTFILE_SECTION(NETLISTFILE_NET_DRIVER, netlist->net_driver);
+    NETLISTFILE_SECTION(NETLISTFILE_NET_FANOUT_BEGIN, netlist->net_fanout_begin);
+    NETLISTFILE_SECTION(NETLISTFILE_NET_FANOUT, netlist->net_fanout);
+    NETLISTFILE_SECTION(NETLISTFILE_NET_NAME_OFFSET, netlist->net_name_offset);
+    NETLISTFILE_SECTION(NETLISTFILE_NET_NAMES, netlist->net_names);
+    NETLISTFILE_SECTION(NETLISTFILE_INPUTS, netlist->inputs);
+    NETLISTFILE_SECTION(NETLISTFILE_OUTPUTS, netlist->outputs);
+    NETLISTFILE_SECTION(NETLISTFILE_REG_TYPE, netlist->reg_type);
+    NETLISTFILE_SECTION(NETLISTFILE_REG_D, netlist->reg_d);
+    NETLISTFILE_SECTION(NETLISTFILE_REG_CLOCK, netlist->reg_clock);
+    NETLISTFILE_SECTION(NETLISTFILE_REG_Q, netlist->reg_q);
+    NETLISTFILE_SECTION(NETLISTFILE_REG_INIT, netlist->reg_init);
+    NETLISTFILE_SECTION(NETLISTFILE_CLOCKS, netlist->clocks);
+#undef NETLISTFILE_SECTION
+
+    NetlistFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, NETLISTFILE_MAGIC, sizeof(header.magic));
+    header.version = NETLISTFILE_VERSION;
+    header.endian = NETLISTFILE_ENDIAN;
+    header.num_gates = Netlist_NumGates(netlist);
+    header.num_nets = num_nets;
+
+    FILE* file = fopen(filename, "wb");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot create netlist file \"%s\".\n", filename);
+        return false;
+    }
+
+    // O cabeçalho é regravado no fim, com o checksum.
+    fwrite(&header, sizeof(header), 1, file);
+    uint64_t offset = sizeof(header);
+    Checksum checksum;
+    Checksum_Init(&checksum);
+    static const char zeros[8] = { 0 };
+    for (int s = 0; s < NETLISTFILE_NUM_SECTIONS; ++s)
+    {
+        header.section_offset[s] = offset;
+        header.section_size[s] = size[s];
+        uint64_t padding = Padded(size[s]) - size[s];
+
+        // A última palavra, incompleta, entra no checksum com o preenchimento.
+        uint64_t whole = size[s] - size[s] % 8;
+        Checksum_Add(&checksum, data[s], whole);
+        if ( padding > 0 )
+        {
+            char last[8] = { 0 };
+            memcpy(last, (const char*)data[s] + whole, size[s] - whole);
+            Checksum_Add(&checksum, last, 8);
+        }
+
+        if ( size[s] > 0 )
+            fwrite(data[s], 1, size[s], file);
+        fwrite(zeros, 1, padding, file);
+        offset += size[s] + padding;
+    }
+    header.checksum = Checksum_Result(&checksum);
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if ( !ok )
+        fprintf(stderr, "ERROR: Cannot write netlist file \"%s\".\n", filename);
+    Trace_AddArg("bytes_written", (double)offset);
+    return ok;
+}
+
+static bool FileError(const char* filename, const char* message)
+{
+    fprintf(stderr, "ERROR: Invalid netlist file \"%s\": %s\n", filename, message);
+    return false;
+}
+
+// Todos os elementos de "v" são menores que "limit".
+static bool IndicesBelow(const uint32_t* v, uint64_t count, uint64_t limit)
+{
+    uint32_t largest = 0;
+    for (uint64_t i = 0; i < count; ++i)
+        largest = v[i] > largest ? v[i] : largest;
+    return count == 0 || largest < limit;
+}
+
+// Deslocamentos CSR: começam em 0 e não decrescem (o último já foi
+// conferido contra o tamanho da seção de elementos).
+static bool OffsetsMonotone(const uint32_t* begin, uint64_t count)
+{
+    if ( begin[0] != 0 )
+        return false;
+    for (uint64_t i = 0; i < count; ++i)
+        if ( begin[i + 1] < begin[i] )
+            return false;
+    return true;
+}
+
+// Confere os índices das seções, que os simuladores usam sem verificação.
+// Retorna a descrição do primeiro problema encontrado, ou NULL.
+static const char* CheckIndices(const NetlistFile* nf, uint64_t names_size)
+{
+    uint64_t gates = nf->num_gates, nets = nf->num_nets, regs = nf->num_registers;
+
+    if ( !OffsetsMonotone(nf->gate_input_begin, gates) || !OffsetsMonotone(nf->net_fanout_begin, nets) )
+        return "CSR offsets are not monotone.";
+    for (uint64_t g = 0; g < gates; ++g)
+    {
+        uint32_t num_inputs = nf->gate_input_begin[g + 1] - nf->gate_input_begin[g];
+        if ( nf->gate_type[g] > GATE_XNOR || num_inputs == 0
+          || ((nf->gate_type[g] == GATE_BUF || nf->gate_type[g] == GATE_NOT) && num_inputs != 1) )
+            return "invalid gate type or number of gate inputs.";
+    }
+    for (uint64_t n = 0; n < nets; ++n)
+    {
+        uint32_t driver = nf->net_driver[n];
+        if ( driver != NETLIST_NONE && (driver >= gates || nf->gate_output[driver] != n) )
+            return "net driver does not match the gate outputs.";
+    }
+    for (uint64_t r = 0; r < regs; ++r)
+        if ( nf->reg_type[r] > REG_LATCH_LOW )
+            return "invalid register type.";
+
+    if ( !IndicesBelow(nf->gate_output, gates, nets)
+      || !IndicesBelow(nf->gate_inputs, nf->gate_input_begin[gates], nets)
+      || !IndicesBelow(nf->inputs, nf->num_inputs, nets)
+      || !IndicesBelow(nf->outputs, nf->num_outputs, nets)
+      || !IndicesBelow(nf->reg_d, regs, nets)
+      || !IndicesBelow(nf->reg_clock, regs, nets)
+      || !IndicesBelow(nf->reg_q, regs, nets)
+      || !IndicesBelow(nf->clocks, nf->num_clocks, nets) )
+        return "net index out of range.";
+    if ( !IndicesBelow(nf->net_fanout, nf->net_fanout_begin[nets], gates) )
+        return "gate index out of range.";
+    if ( !IndicesBelow(nf->net_name_offset, nets, names_size) )
+        return "net name offset out of range.";
+    return NULL;
+}
+
+bool NetlistFile_Open(const char* filename, NetlistFile* nf, bool verify)
+{
+    TRACE_SCOPE("NetlistFile_Open");
+    Trace_AddFileRead(filename);
+
+    if ( !MappedFile_Open(filename, &nf->file) )
+    {
+        fprintf(stderr, "ERROR: Cannot open netlist file \"%s\".\n", filename);
+        return false;
+    }
+    bool ok = false;
+    const NetlistFileHeader* header = (const NetlistFileHeader*)nf->file.data;
+    nf->header = header;
+    uint64_t file_size = nf->file.size;
+
+    // "do { } while (false)" para sair no primeiro erro e fechar o arquivo.
+    do
+    {
+        if ( file_size < sizeof(NetlistFileHeader) || memcmp(header->magic, NETLISTFILE_MAGIC, sizeof(header->magic)) != 0 )
+        {
+            FileError(filename, "not a binary netlist.");
+            break;
+        }
+        if ( header->endian != NETLISTFILE_ENDIAN )
+        {
+            FileError(filename, "written on a machine with a different byte order.");
+            break;
+        }
+        if ( header->version != NETLISTFILE_VERSION )
+        {
+            fprintf(stderr, "ERROR: Netlist file \"%s\" has version %u; this program reads version %u. Convert it again with netlistconv.\n",
+                    filename, header->version, NETLISTFILE_VERSION);
+            break;
+        }
+
+        // As seções são contíguas e alinhadas, na ordem de NETLISTFILE_*.
+        uint64_t expected = sizeof(NetlistFileHeader);
+        bool layout_ok = true;
+        for (int s = 0; s < NETLISTFILE_NUM_SECTIONS && layout_ok; ++s)
+        {
+            layout_ok = header->section_offset[s] == expected && expected <= file_size
+                     && header->section_size[s] <= file_size - expected;
+            expected += Padded(header->section_size[s]);
+        }
+        if ( !layout_ok || expected != file_size )
+        {
+            FileError(filename, "truncated or inconsistent section table.");
+            break;
+        }
+
+        const char* base = nf->file.data;
+        nf->num_gates = header->num_gates;
+        nf->num_nets = header->num_nets;
+        nf->gate_type        = (const uint8_t*)(base + header->section_offset[NETLISTFILE_GATE_TYPE]);
+        nf->gate_output      = (const uint32_t*)(base + header->section_offset[NETLISTFILE_GATE_OUTPUT]);
+        nf->gate_input_begin = (const uint32_t*)(base + header->section_offset[NETLISTFILE_GATE_INPUT_BEGIN]);
+        nf->gate_inputs      = (const uint32_t*)(base + header->section_offset[NETLISTFILE_GATE_INPUTS]);
+        nf->net_driver       = (const uint32_t*)(base + header->section_offset[NETLISTFILE_NET_DRIVER]);
+        nf->net_fanout_begin = (const uint32_t*)(base + header->section_offset[NETLISTFILE_NET_FANOUT_BEGIN]);
+        nf->net_fanout       = (const uint32_t*)(base + header->section_offset[NETLISTFILE_NET_FANOUT]);
+        nf->net_name_offset  = (const uint32_t*)(base + header->section_offset[NETLISTFILE_NET_NAME_OFFSET]);
+        nf->net_names        = base + header->section_offset[NETLISTFILE_NET_NAMES];
+        nf->inputs           = (const uint32_t*)(base + header->section_offset[NETLISTFILE_INPUTS]);
+        nf->outputs          = (const uint32_t*)(base + header->section_offset[NETLISTFILE_OUTPUTS]);
+        nf->reg_type         = (const uint8_t*)(base + header->section_offset[NETLISTFILE_REG_TYPE]);
+        nf->reg_d            = (const uint32_t*)(base + header->section_offset[NETLISTFILE_REG_D]);
+        nf->reg_clock        = (const uint32_t*)(base + header->section_offset[NETLISTFILE_REG_CLOCK]);
+        nf->reg_q            = (const uint32_t*)(base + header->section_offset[NETLISTFILE_REG_Q]);
+        nf->reg_init         = (const uint8_t*)(base + header->section_offset[NETLISTFILE_REG_INIT]);
+        nf->clocks           = (const uint32_t*)(base + header->section_offset[NETLISTFILE_CLOCKS]);
+        nf->num_inputs    = (uint32_t)(header->section_size[NETLISTFILE_INPUTS] / 4);
+        nf->num_outputs   = (uint32_t)(header->section_size[NETLISTFILE_OUTPUTS] / 4);
+        nf->num_registers = (uint32_t)header->section_size[NETLISTFILE_REG_TYPE];
+        nf->num_clocks    = (uint32_t)(header->section_size[NETLISTFILE_CLOCKS] / 4);
+
+        // Tamanhos das seções a partir dos totais e dos últimos deslocamentos CSR.
+        const uint64_t* size = header->section_size;
+        uint64_t gates = nf->num_gates, nets = nf->num_nets, regs = nf->num_registers;
+        bool sizes_ok = size[NETLISTFILE_GATE_TYPE] == gates
+                     && size[NETLISTFILE_GATE_OUTPUT] == 4 * gates
+                     && size[NETLISTFILE_GATE_INPUT_BEGIN] == 4 * (gates + 1)
+                     && size[NETLISTFILE_NET_DRIVER] == 4 * nets
+                     && size[NETLISTFILE_NET_FANOUT_BEGIN] == 4 * (nets + 1)
+                     && size[NETLISTFILE_NET_NAME_OFFSET] == 4 * nets
+                     && size[NETLISTFILE_INPUTS] % 4 == 0
+                     && size[NETLISTFILE_OUTPUTS] % 4 == 0
+                     && size[NETLISTFILE_REG_D] == 4 * regs
+                     && size[NETLISTFILE_REG_CLOCK] == 4 * regs
+                     && size[NETLISTFILE_REG_Q] == 4 * regs
+                     && size[NETLISTFILE_REG_INIT] == regs
+                     && size[NETLISTFILE_CLOCKS] % 4 == 0;
+        sizes_ok = sizes_ok && size[NETLISTFILE_GATE_INPUTS] == 4 * (uint64_t)nf->gate_input_begin[gates]
+                            && size[NETLISTFILE_NET_FANOUT] == 4 * (uint64_t)nf->net_fanout_begin[nets];
+        sizes_ok = sizes_ok && (nets == 0 || (size[NETLISTFILE_NET_NAMES] > 0 && nf->net_names[size[NETLISTFILE_NET_NAMES] - 1] == '\0'));
+        if ( !sizes_ok )
+        {
+            FileError(filename, "section sizes do not match the gate and net counts.");
+            break;
+        }
+
+        const char* index_error = CheckIndices(nf, size[NETLISTFILE_NET_NAMES]);
+        if ( index_error != NULL )
+        {
+            FileError(filename, index_error);
+            break;
+        }
+
+        if ( verify )
+        {
+            TRACE_SCOPE("NetlistFile_Verify");
+            Checksum checksum;
+            Checksum_Init(&checksum);
+            Checksum_Add(&checksum, base + sizeof(NetlistFileHeader), file_size - sizeof(NetlistFileHeader));
+            if ( Checksum_Result(&checksum) != header->checksum )
+            {
+                FileError(filename, "checksum mismatch (the file is corrupted).");
+                break;
+            }
+        }
+        ok = true;
+    } while ( false );
+
+    if ( !ok )
+        MappedFile_Close(&nf->file);
+    return ok;
+}
+
+void NetlistFile_Close(NetlistFile* nf)
+{
+    MappedFile_Close(&nf->file);
+    nf->header = NULL;
+}
+
+bool NetlistFile_Load(const char* filename, Netlist* netlist, NetlistLoadStats* stats, bool verify)
+{
+    TRACE_SCOPE("NetlistFile_Load");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    NetlistFile nf;
+    if ( !NetlistFile_Open(filename, &nf, verify) )
+        return false;
+
+    const uint64_t* size = nf.header->section_size;
+    netlist->gate_type.assign(nf.gate_type, nf.gate_type + nf.num_gates);
+    netlist->gate_output.assign(nf.gate_output, nf.gate_output + nf.num_gates);
+    netlist->gate_input_begin.assign(nf.gate_input_begin, nf.gate_input_begin + nf.num_gates + 1);
+    netlist->gate_inputs.assign(nf.gate_inputs, nf.gate_inputs + size[NETLISTFILE_GATE_INPUTS] / 4);
+    netlist->net_driver.assign(nf.net_driver, nf.net_driver + nf.num_nets);
+    netlist->net_fanout_begin.assign(nf.net_fanout_begin, nf.net_fanout_begin + nf.num_nets + 1);
+    netlist->net_fanout.assign(nf.net_fanout, nf.net_fanout + size[NETLISTFILE_NET_FANOUT] / 4);
+    netlist->net_name_offset.assign(nf.net_name_offset, nf.net_name_offset + nf.num_nets);
+    netlist->net_names.assign(nf.net_names, nf.net_names + size[NETLISTFILE_NET_NAMES]);
+    netlist->inputs.assign(nf.inputs, nf.inputs + nf.num_inputs);
+    netlist->outputs.assign(nf.outputs, nf.outputs + nf.num_outputs);
+    netlist->reg_type.assign(nf.reg_type, nf.reg_type + nf.num_registers);
+    netlist->reg_d.assign(nf.reg_d, nf.reg_d + nf.num_registers);
+    netlist->reg_clock.assign(nf.reg_clock, nf.reg_clock + nf.num_registers);
+    netlist->reg_q.assign(nf.reg_q, nf.reg_q + nf.num_registers);
+    netlist->reg_init.assign(nf.reg_init, nf.reg_init + nf.num_registers);
+    netlist->clocks.assign(nf.clocks, nf.clocks + nf.num_clocks);
+    netlist->net_value.assign(nf.num_nets, 0);
+
+    stats->bytes = nf.file.size;
+    NetlistFile_Close(&nf);
+    stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Trace_AddArg("gates", (double)Netlist_NumGates(netlist));
+    return true;
+}
@@ -0,0 +1,1516 @@
+#include "netlistLoader.h"
+#include "netlistFile.h"
+#include "mappedFile.h"
+#include "trace.h"
+
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <utility>
+
+// Nets criadas sob demanda pelos dois leitores.
+struct NetBuilder
+{
+    Netlist* netlist;
+    uint32_t const0;
+    uint32_t const1;
+};
+
+static void InitBuilder(NetBuilder* builder, Netlist* netlist)
+{
+    builder->netlist = netlist;
+    builder->const0 = NETLIST_NONE;
+    builder->const1 = NETLIST_NONE;
+}
+
+static uint32_t Const0(NetBuilder* builder)
+{
+    if ( builder->const0 == NETLIST_NONE )
+        builder->const0 = Netlist_AddNet(builder->netlist, "$const0");
+    return builder->const0;
+}
+
+static uint32_t Const1(NetBuilder* builder)
+{
+    if ( builder->const1 == NETLIST_NONE )
+    {
+        uint32_t zero = Const0(builder);
+        builder->const1 = Netlist_AddNet(builder->netlist, "$const1");
+        Netlist_AddGate(builder->netlist, GATE_NOT, &zero, 1, builder->const1);
+    }
+    return builder->const1;
+}
+
+// Trecho do arquivo mapeado (nome, padrão de uma linha...), sem cópia.
+struct Token
+{
+    const char* p;
+    uint32_t    n;
+};
+
+static inline bool TokenIs(const Token& token, const char* text)
+{
+    return token.n == strlen(text) && memcmp(token.p, text, token.n) == 0;
+}
+
+// Tabela de nomes com endereçamento aberto (sondagem linear). As chaves são
+// trechos do arquivo mapeado, então buscas e inserções não copiam nem alocam
+// strings; o arquivo precisa continuar mapeado enquanto a tabela é usada.
+// Chave, hash e valor ficam juntos, para que cada sondagem leia uma única
+// linha de cache.
+struct NameEntry
+{
+    const char* p;    // NULL: posição livre
+    uint32_t    n;
+    uint32_t    hash;
+    uint32_t    value;
+};
+
+struct NameTable
+{
+    std::vector<NameEntry> entries;
+    uint32_t               count;
+};
+
+static inline uint32_t HashName(const Token& name)
+{
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < name.n; ++i)
+        h = (h ^ (unsigned char)name.p[i]) * 16777619u;
+    return h;
+}
+
+static void NameTable_Init(NameTable* table, size_t expected)
+{
+    size_t capacity = 64;
+    while ( capacity < 2 * expected )
+        capacity *= 2;
+    NameEntry empty = { NULL, 0, 0, NETLIST_NONE };
+    table->entries.assign(capacity, empty);
+    table->count = 0;
+}
+
+// Posição do valor de "name", inserido com NETLIST_NONE se ainda não existe.
+// O ponteiro vale até a próxima inserção.
+static uint32_t* NameTable_Slot(NameTable* table, const Token& name)
+{
+    if ( 2 * (table->count + 1) > table->entries.size() )
+    {
+        std::vector<NameEntry> old;
+        old.swap(table->entries);
+        uint32_t count = table->count;
+        NameTable_Init(table, old.size());
+        size_t mask = table->entries.size() - 1;
+        for (size_t i = 0; i < old.size(); ++i)
+        {
+            if ( old[i].p == NULL )
+                continue;
+            size_t slot = old[i].hash & mask;
+            while ( table->entries[slot].p != NULL )
+                slot = (slot + 1) & mask;
+            table->entries[slot] = old[i];
+        }
+        table->count = count;
+    }
+
+    uint32_t hash = HashName(name);
+    size_t mask = table->entries.size() - 1;
+    size_t slot = hash & mask;
+    for (;;)
+    {
+        NameEntry& entry = table->entries[slot];
+        if ( entry.p == NULL )
+        {
+            entry.p = name.p;
+            entry.n = name.n;
+            entry.hash = hash;
+            table->count += 1;
+            return &entry.value;
+        }
+        if ( entry.hash == hash && entry.n == name.n && memcmp(entry.p, name.p, name.n) == 0 )
+            return &entry.value;
+        slot = (slot + 1) & mask;
+    }
+}
+
+// NETLIST_NONE se "name" não está na tabela.
+static uint32_t NameTable_Find(const NameTable* table, const Token& name)
+{
+    uint32_t hash = HashName(name);
+    size_t mask = table->entries.size() - 1;
+    for (size_t slot = hash & mask; table->entries[slot].p != NULL; slot = (slot + 1) & mask)
+    {
+        const NameEntry& entry = table->entries[slot];
+        if ( entry.hash == hash && entry.n == name.n && memcmp(entry.p, name.p, name.n) == 0 )
+            return entry.value;
+    }
+    return NETLIST_NONE;
+}
+
+static bool EndsWith(const char* text, const char* suffix)
+{
+    size_t n = strlen(text), m = strlen(suffix);
+    if ( n < m )
+        return false;
+    for (size_t i = 0; i < m; ++i)
+        if ( tolower((unsigned char)text[n - m + i]) != suffix[i] )
+            return false;
+    return true;
+}
+
+bool NetlistLoader_Load(const char* filename, Netlist* netlist, NetlistLoadStats* stats)
+{
+    if ( EndsWith(filename, ".blif") )
+        return NetlistLoader_LoadBLIF(filename, netlist, stats);
+    if ( EndsWith(filename, ".v") )
+        return NetlistLoader_LoadVerilog(filename, netlist, stats);
+    if ( EndsWith(filename, ".nlb") )
+        return NetlistFile_Load(filename, netlist, stats, false);
+
+    fprintf(stderr, "ERROR: Unknown netlist format \"%s\" (expected .blif, .v or .nlb).\n", filename);
+    return false;
+}
+
+// Abre o arquivo e marca o início da leitura; veja FinishLoad().
+static bool BeginLoad(const char* filename, MappedFile* file, std::chrono::steady_clock::time_point* start)
+{
+    *start = std::chrono::steady_clock::now();
+    Trace_AddFileRead(filename);
+    if ( !MappedFile_Open(filename, file) )
+    {
+        fprintf(stderr, "ERROR: Cannot open netlist file \"%s\".\n", filename);
+        return false;
+    }
+    return true;
+}
+
+static bool FinishLoad(bool ok, Netlist* netlist, MappedFile* file, std::chrono::steady_clock::time_point start, NetlistLoadStats* stats)
+{
+    ok = ok && Netlist_Finalize(netlist);
+    stats->bytes = file->size;
+    stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    MappedFile_Close(file);
+    Trace_AddArg("gates", (double)Netlist_NumGates(netlist));
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// BLIF
+// ---------------------------------------------------------------------------
+
+struct BlifReader
+{
+    const char*        filename;
+    const char*        p;
+    const char*        end;
+    int                line;       // Linha atual do arquivo
+    int                token_line; // Linha em que começou a linha lógica lida
+    std::vector<Token> tokens;     // Da última linha lógica
+
+    NetBuilder builder;
+    NameTable  nets;         // Nome -> net
+    uint32_t   global_clock; // "$clock", dos ".latch" sem controle
+
+    // ".names" sendo lido: sinais (entradas e, por último, a saída) e as
+    // linhas da cobertura.
+    bool               names_active;
+    int                names_line;
+    std::vector<Token> names_signals;
+    std::vector<Token> cover_inputs;
+    std::vector<char>  cover_outputs;
+};
+
+static bool BlifError(BlifReader* r, int line, const char* message)
+{
+    fprintf(stderr, "ERROR: %s:%d: %s\n", r->filename, line, message);
+    return false;
+}
+
+static inline bool IsBlifSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Lê a próxima linha lógica (juntando as continuações com '\') em
+// "tokens". Retorna false no fim do arquivo.
+static bool ReadBlifLine(BlifReader* r)
+{
+    r->tokens.clear();
+    const char* p = r->p;
+    const char* end = r->end;
+    while ( p < end )
+    {
+        char c = *p;
+        if ( c == '\n' )
+        {
+            r->line += 1;
+            p += 1;
+            if ( !r->tokens.empty() )
+                break;
+        }
+        else if ( IsBlifSpace(c) )
+            p += 1;
+        else if ( c == '#' )
+        {
+            while ( p < end && *p != '\n' )
+                p += 1;
+        }
+        else if ( c == '\\' && (p + 1 >= end || p[1] == '\n' || IsBlifSpace(p[1])) )
+        {
+            // Continuação: ignora o resto da linha e a quebra.
+            p += 1;
+            while ( p < end && IsBlifSpace(*p) )
+                p += 1;
+            if ( p < end && *p == '\n' )
+            {
+                r->line += 1;
+                p += 1;
+            }
+        }
+        else
+        {
+            if ( r->tokens.empty() )
+                r->token_line = r->line;
+            Token token;
+            token.p = p;
+            while ( p < end && !IsBlifSpace(*p) && *p != '\n' && *p != '#' )
+                p += 1;
+            token.n = (uint32_t)(p - token.p);
+            r->tokens.push_back(token);
+        }
+    }
+    r->p = p;
+    return !r->tokens.empty();
+}
+
+static uint32_t BlifNet(BlifReader* r, const Token& token)
+{
+    uint32_t* net = NameTable_Slot(&r->nets, token);
+    if ( *net == NETLIST_NONE )
+        *net = Netlist_AddNet(r->builder.netlist, std::string(token.p, token.n).c_str());
+    return *net;
+}
+
+// Nova net interna "<saída>$<sufixo><índice>".
+static uint32_t BlifInternalNet(BlifReader* r, uint32_t output, const char* suffix, size_t index)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "$%s%zu", suffix, index);
+    std::string name = std::string(Netlist_NetName(r->builder.netlist, output)) + buffer;
+    return Netlist_AddNet(r->builder.netlist, name.c_str());
+}
+
+// Converte a cobertura do ".names" pendente em portas.
+static bool FlushBlifNames(BlifReader* r)
+{
+    if ( !r->names_active )
+        return true;
+    r->names_active = false;
+
+    Netlist* netlist = r->builder.netlist;
+    size_t k = r->names_signals.size() - 1;
+    size_t num_rows = r->cover_outputs.size();
+
+    std::vector<uint32_t> in(k);
+    for (size_t i = 0; i < k; ++i)
+        in[i] = BlifNet(r, r->names_signals[i]);
+    uint32_t out = BlifNet(r, r->names_signals[k]);
+
+    // Todas as linhas descrevem a cobertura do 1 ou todas a do 0.
+    char value = num_rows > 0 ? r->cover_outputs[0] : '1';
+    for (size_t row = 0; row < num_rows; ++row)
+        if ( r->cover_outputs[row] != value )
+            return BlifError(r, r->names_line, "mixed on-set and off-set rows in .names are not supported.");
+    bool on_set = value == '1';
+
+    // Sem linhas, ou sem entradas: constante.
+    if ( num_rows == 0 || k == 0 )
+    {
+        uint32_t constant = (num_rows > 0 && on_set) ? Const1(&r->builder) : Const0(&r->builder);
+        Netlist_AddGate(netlist, GATE_BUF, &constant, 1, out);
+        return true;
+    }
+
+    // Portas conhecidas. "ones" e "zeros" contam literais de cada linha.
+    const Token* rows = r->cover_inputs.data();
+    bool all_single = true;           // Cada linha tem exatamente um literal, em posições distintas
+    int single_polarity = -1;         // '1' ou '0' se todos os literais únicos são iguais
+    std::vector<uint8_t> seen(k, 0);
+    for (size_t row = 0; row < num_rows && all_single; ++row)
+    {
+        int literal = -1;
+        for (size_t i = 0; i < k; ++i)
+        {
+            if ( rows[row].p[i] == '-' )
+                continue;
+            if ( literal >= 0 || seen[i] )
+            {
+                all_single = false;
+                break;
+            }
+            literal = (int)i;
+        }
+        if ( literal < 0 )
+            all_single = false;
+        if ( !all_single )
+            break;
+        seen[literal] = 1;
+        char c = rows[row].p[literal];
+        if ( single_polarity < 0 )
+            single_polarity = c;
+        else if ( single_polarity != c )
+            all_single = false;
+    }
+
+    if ( num_rows == 1 )
+    {
+        bool all_ones = true, all_zeros = true;
+        for (size_t i = 0; i < k; ++i)
+        {
+            all_ones = all_ones && rows[0].p[i] == '1';
+            all_zeros = all_zeros && rows[0].p[i] == '0';
+        }
+        if ( k == 1 && (all_ones || all_zeros) )
+        {
+            Netlist_AddGate(netlist, all_ones == on_set ? GATE_BUF : GATE_NOT, in.data(), 1, out);
+            return true;
+        }
+        if ( all_ones )
+        {
+            Netlist_AddGate(netlist, on_set ? GATE_AND : GATE_NAND, in.data(), (int)k, out);
+            return true;
+        }
+        if ( all_zeros )
+        {
+            Netlist_AddGate(netlist, on_set ? GATE_NOR : GATE_OR, in.data(), (int)k, out);
+            return true;
+        }
+    }
+    if ( all_single && num_rows == k && k > 1 )
+    {
+        if ( single_polarity == '1' )
+            Netlist_AddGate(netlist, on_set ? GATE_OR : GATE_NOR, in.data(), (int)k, out);
+        else
+            Netlist_AddGate(netlist, on_set ? GATE_NAND : GATE_AND, in.data(), (int)k, out);
+        return true;
+    }
+    if ( k == 2 && num_rows == 2 )
+    {
+        bool xor_rows = (rows[0].p[0] != rows[0].p[1]) && (rows[1].p[0] != rows[1].p[1]) && rows[0].p[0] != rows[1].p[0];
+        bool xnor_rows = (rows[0].p[0] == rows[0].p[1]) && (rows[1].p[0] == rows[1].p[1]) && rows[0].p[0] != rows[1].p[0];
+        xor_rows = xor_rows && rows[0].p[0] != '-' && rows[0].p[1] != '-' && rows[1].p[0] != '-' && rows[1].p[1] != '-';
+        xnor_rows = xnor_rows && rows[0].p[0] != '-' && rows[1].p[0] != '-';
+        if ( xor_rows || xnor_rows )
+        {
+            Netlist_AddGate(netlist, xor_rows == on_set ? GATE_XOR : GATE_XNOR, in.data(), 2, out);
+            return true;
+        }
+    }
+
+    // Caso geral: um AND por linha, com as entradas negadas quando
+    // necessário, e um OR (ou NOR, para a cobertura do 0) das linhas.
+    std::vector<uint32_t> negated(k, NETLIST_NONE);
+    std::vector<uint32_t> terms;
+    std::vector<uint32_t> literals;
+    for (size_t row = 0; row < num_rows; ++row)
+    {
+        literals.clear();
+        for (size_t i = 0; i < k; ++i)
+        {
+            char c = rows[row].p[i];
+            if ( c == '1' )
+                literals.push_back(in[i]);
+            else if ( c == '0' )
+            {
+                if ( negated[i] == NETLIST_NONE )
+                {
+                    negated[i] = BlifInternalNet(r, out, "not", i);
+                    Netlist_AddGate(netlist, GATE_NOT, &in[i], 1, negated[i]);
+                }
+                literals.push_back(negated[i]);
+            }
+        }
+
+        if ( literals.empty() )
+        {
+            // Linha só com '-': a saída é constante.
+            uint32_t constant = on_set ? Const1(&r->builder) : Const0(&r->builder);
+            Netlist_AddGate(netlist, GATE_BUF, &constant, 1, out);
+            return true;
+        }
+        if ( literals.size() == 1 )
+            terms.push_back(literals[0]);
+        else
+        {
+            uint32_t term = BlifInternalNet(r, out, "and", row);
+            Netlist_AddGate(netlist, GATE_AND, literals.data(), (int)literals.size(), term);
+            terms.push_back(term);
+        }
+    }
+
+    if ( terms.size() == 1 )
+        Netlist_AddGate(netlist, on_set ? GATE_BUF : GATE_NOT, terms.data(), 1, out);
+    else
+        Netlist_AddGate(netlist, on_set ? GATE_OR : GATE_NOR, terms.data(), (int)terms.size(), out);
+    return true;
+}
+
+// ".latch entrada saída [tipo controle] [valor-inicial]". Sem controle (ou
+// com "NIL"), o registrador usa o clock global "$clock", criado aqui; o
+// controle dos flip-flops ("re" e "fe") passa a ser um clock.
+static bool ReadBlifLatch(BlifReader* r)
+{
+    size_t n = r->tokens.size();
+    if ( n != 3 && n != 4 && n != 5 && n != 6 )
+        return BlifError(r, r->token_line, "invalid .latch.");
+
+    int type = REG_DFF_RISING;
+    bool has_control = n >= 5;
+    if ( has_control )
+    {
+        const Token& kind = r->tokens[3];
+        if ( TokenIs(kind, "re") )
+            type = REG_DFF_RISING;
+        else if ( TokenIs(kind, "fe") )
+            type = REG_DFF_FALLING;
+        else if ( TokenIs(kind, "ah") )
+            type = REG_LATCH_HIGH;
+        else if ( TokenIs(kind, "al") )
+            type = REG_LATCH_LOW;
+        else
+            return BlifError(r, r->token_line, "unsupported .latch type (expected re, fe, ah or al).");
+    }
+
+    // Valores iniciais 2 (indiferente) e 3 (desconhecido) começam em 0.
+    bool init = false;
+    if ( n == 4 || n == 6 )
+    {
+        const Token& value = r->tokens[n - 1];
+        if ( value.n != 1 || value.p[0] < '0' || value.p[0] > '3' )
+            return BlifError(r, r->token_line, "invalid .latch initial value.");
+        init = value.p[0] == '1';
+    }
+
+    Netlist* netlist = r->builder.netlist;
+    uint32_t control;
+    if ( !has_control || TokenIs(r->tokens[4], "NIL") )
+    {
+        if ( Netlist_IsLatch(type) )
+            return BlifError(r, r->token_line, "a transparent .latch needs an enable signal.");
+        if ( r->global_clock == NETLIST_NONE )
+            r->global_clock = Netlist_AddNet(netlist, "$clock");
+        control = r->global_clock;
+    }
+    else
+        control = BlifNet(r, r->tokens[4]);
+    if ( !Netlist_IsLatch(type) )
+        Netlist_AddClock(netlist, control);
+
+    Netlist_AddRegister(netlist, type, BlifNet(r, r->tokens[1]), control, BlifNet(r, r->tokens[2]), init);
+    return true;
+}
+
+bool NetlistLoader_LoadBLIF(const char* filename, Netlist* netlist, NetlistLoadStats* stats)
+{
+    TRACE_SCOPE("NetlistLoader_LoadBLIF");
+
+    MappedFile file;
+    std::chrono::steady_clock::time_point start;
+    if ( !BeginLoad(filename, &file, &start) )
+        return false;
+
+    BlifReader r;
+    r.filename = filename;
+    r.p = file.data;
+    r.end = file.data + file.size;
+    r.line = 1;
+    r.token_line = 1;
+    r.names_active = false;
+    r.names_line = 0;
+    r.global_clock = NETLIST_NONE;
+    InitBuilder(&r.builder, netlist);
+    NameTable_Init(&r.nets, file.size / 32); // ~1 net a cada 32 bytes
+
+    std::vector<Token> outputs; // Adicionadas no fim, quando as nets já existem
+    bool ok = true;
+    bool model_seen = false;
+    while ( ok && ReadBlifLine(&r) )
+    {
+        const Token& command = r.tokens[0];
+        if ( command.p[0] != '.' )
+        {
+            // Linha da cobertura do ".names" atual.
+            if ( !r.names_active )
+            {
+                ok = BlifError(&r, r.token_line, "cover row outside of .names.");
+                break;
+            }
+            size_t k = r.names_signals.size() - 1;
+            Token pattern = r.tokens[0];
+            Token value = r.tokens.size() > 1 ? r.tokens[1] : r.tokens[0];
+            if ( k == 0 )
+                pattern.n = 0;
+            bool valid = r.tokens.size() == (k == 0 ? 1u : 2u) && pattern.n == k && value.n == 1
+                      && (value.p[0] == '0' || value.p[0] == '1');
+            for (uint32_t i = 0; valid && i < pattern.n; ++i)
+                valid = pattern.p[i] == '0' || pattern.p[i] == '1' || pattern.p[i] == '-';
+            if ( !valid )
+            {
+                ok = BlifError(&r, r.token_line, "invalid .names cover row.");
+                break;
+            }
+            r.cover_inputs.push_back(pattern);
+            r.cover_outputs.push_back(value.p[0]);
+            continue;
+        }
+
+        ok = FlushBlifNames(&r);
+        if ( !ok )
+            break;
+
+        if ( TokenIs(command, ".model") )
+        {
+            if ( model_seen )
+                break; // Somente o primeiro modelo
+            model_seen = true;
+        }
+        else if ( TokenIs(command, ".inputs") )
+        {
+            for (size_t i = 1; i < r.tokens.size(); ++i)
+                netlist->inputs.push_back(BlifNet(&r, r.tokens[i]));
+        }
+        else if ( TokenIs(command, ".outputs") )
+            outputs.insert(outputs.end(), r.tokens.begin() + 1, r.tokens.end());
+        else if ( TokenIs(command, ".names") )
+        {
+            if ( r.tokens.size() < 2 )
+            {
+                ok = BlifError(&r, r.token_line, ".names without an output.");
+                break;
+            }
+            r.names_active = true;
+            r.names_line = r.token_line;
+            r.names_signals.assign(r.tokens.begin() + 1, r.tokens.end());
+            r.cover_inputs.clear();
+            r.cover_outputs.clear();
+        }
+        else if ( TokenIs(command, ".latch") )
+            ok = ReadBlifLatch(&r);
+        else if ( TokenIs(command, ".clock") )
+        {
+            for (size_t i = 1; i < r.tokens.size(); ++i)
+                Netlist_AddClock(netlist, BlifNet(&r, r.tokens[i]));
+        }
+        else if ( TokenIs(command, ".end") )
+            break;
+        else if ( TokenIs(command, ".subckt") || TokenIs(command, ".gate")
+               || TokenIs(command, ".mlatch") || TokenIs(command, ".exdc") )
+        {
+            std::string message = std::string(command.p, command.n) + " is not supported.";
+            ok = BlifError(&r, r.token_line, message.c_str());
+        }
+        else
+            fprintf(stderr, "WARNING: %s:%d: comando \"%.*s\" ignorado.\n", filename, r.token_line, (int)command.n, command.p);
+    }
+    ok = ok && FlushBlifNames(&r);
+
+    for (size_t i = 0; ok && i < outputs.size(); ++i)
+        Netlist_AddOutput(netlist, BlifNet(&r, outputs[i]));
+
+    return FinishLoad(ok, netlist, &file, start, stats);
+}
+
+// ---------------------------------------------------------------------------
+// Verilog estrutural
+// ---------------------------------------------------------------------------
+
+#define VTOKEN_END    0
+#define VTOKEN_IDENT  1
+#define VTOKEN_NUMBER 2
+#define VTOKEN_SYMBOL 3
+
+// Nets locais de um módulo que representam as constantes.
+#define VLOCAL_CONST0 0xFFFFFFF0u
+#define VLOCAL_CONST1 0xFFFFFFF1u
+
+#define VDIR_WIRE   0
+#define VDIR_INPUT  1
+#define VDIR_OUTPUT 2
+
+#define VBIT_SCALAR INT_MIN // VModule::net_bit de sinais escalares
+
+// Sinal declarado (escalar ou vetor); seus bits são nets locais
+// consecutivas, de "msb" para "lsb".
+struct VSignal
+{
+    uint32_t first;
+    int      msb;
+    int      lsb;
+    int      dir;
+    bool     declared; // false: criado implicitamente por uso, ou só citado na lista de portas
+};
+
+struct VGate
+{
+    int      type;
+    uint32_t begin; // Em VModule::pins: a saída, depois as entradas
+    uint32_t count;
+};
+
+struct VConnection
+{
+    Token       port;  // Vazio (n == 0): conexão por posição
+    uint32_t    begin; // Em VModule::pins
+    uint32_t    count;
+    bool        connected;
+};
+
+struct VInstance
+{
+    Token       module;
+    Token       name;
+    int         line;
+    uint32_t    first_connection; // Em VModule::connections
+    uint32_t    num_connections;
+};
+
+struct VModule
+{
+    Token                    name;
+    std::vector<Token>       port_names;   // Na ordem do cabeçalho
+    std::vector<Token>       net_name;     // Nets locais: nome do sinal...
+    std::vector<int>         net_bit;      // ...e bit ("x[3]"), ou VBIT_SCALAR
+    std::vector<uint8_t>     net_dir;
+    std::vector<VSignal>     signals;
+    NameTable                signal_index; // Nome -> posição em "signals"
+    std::vector<VGate>       gates;
+    std::vector<uint32_t>    pins;
+    std::vector<VInstance>   instances;
+    std::vector<VConnection> connections;
+    bool                     instantiated;
+    bool                     elaborating; // Na pilha de Elaborate(), para detectar recursão
+};
+
+struct VerilogReader
+{
+    const char* filename;
+    const char* p;
+    const char* end;
+    int         line;
+
+    // Token atual
+    int         kind;
+    Token       token;
+    int         token_line;
+
+    bool        ok;
+
+    std::vector<VModule> modules;
+    NameTable            module_index; // Nome -> posição em "modules"
+
+    NetBuilder builder;
+};
+
+static bool VerilogError(VerilogReader* r, const char* message)
+{
+    if ( r->ok )
+        fprintf(stderr, "ERROR: %s:%d: %s\n", r->filename, r->token_line, message);
+    r->ok = false;
+    return false;
+}
+
+static inline bool IsIdentStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+static inline bool IsIdentChar(char c)  { return IsIdentStart(c) || (c >= '0' && c <= '9') || c == '$'; }
+
+static void NextToken(VerilogReader* r)
+{
+    const char* p = r->p;
+    const char* end = r->end;
+    for (;;)
+    {
+        while ( p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') )
+        {
+            if ( *p == '\n' )
+                r->line += 1;
+            p += 1;
+        }
+        if ( p + 1 < end && p[0] == '/' && p[1] == '/' )
+        {
+            while ( p < end && *p != '\n' )
+                p += 1;
+        }
+        else if ( p + 1 < end && p[0] == '/' && p[1] == '*' )
+        {
+            p += 2;
+            while ( p + 1 < end && !(p[0] == '*' && p[1] == '/') )
+            {
+                if ( *p == '\n' )
+                    r->line += 1;
+                p += 1;
+            }
+            p = p + 2 <= end ? p + 2 : end;
+        }
+        else if ( p < end && *p == '`' )
+        {
+            // Diretivas do pré-processador (`timescale...) são ignoradas.
+            while ( p < end && *p != '\n' )
+                p += 1;
+        }
+        else
+            break;
+    }
+
+    r->token_line = r->line;
+    r->token.p = p;
+    if ( p >= end )
+        r->kind = VTOKEN_END;
+    else if ( IsIdentStart(*p) )
+    {
+        while ( p < end && IsIdentChar(*p) )
+            p += 1;
+        r->kind = VTOKEN_IDENT;
+    }
+    else if ( *p == '\\' )
+    {
+        // Identificador com escape: até o próximo espaço, sem a barra.
+        p += 1;
+        r->token.p = p;
+        while ( p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' )
+            p += 1;
+        r->kind = VTOKEN_IDENT;
+    }
+    else if ( (*p >= '0' && *p <= '9') || *p == '\'' )
+    {
+        while ( p < end && *p >= '0' && *p <= '9' )
+            p += 1;
+        if ( p < end && *p == '\'' )
+        {
+            p += 1;
+            if ( p < end && (*p == 's' || *p == 'S') )
+                p += 1;
+            if ( p < end )
+                p += 1; // Base
+            while ( p < end && (IsIdentChar(*p) || *p == '?') )
+                p += 1;
+        }
+        r->kind = VTOKEN_NUMBER;
+    }
+    else
+    {
+        p += 1;
+        r->kind = VTOKEN_SYMBOL;
+    }
+    r->token.n = (uint32_t)(p - r->token.p);
+    r->p = p;
+}
+
+static inline bool IsSymbol(const VerilogReader* r, char c)
+{
+    return r->kind == VTOKEN_SYMBOL && r->token.p[0] == c;
+}
+
+static bool Accept(VerilogReader* r, char c)
+{
+    if ( !IsSymbol(r, c) )
+        return false;
+    NextToken(r);
+    return true;
+}
+
+static bool Expect(VerilogReader* r, char c)
+{
+    if ( Accept(r, c) )
+        return true;
+    char message[64];
+    snprintf(message, sizeof(message), "expected '%c'.", c);
+    return VerilogError(r, message);
+}
+
+static bool ExpectIdent(VerilogReader* r, Token* name)
+{
+    if ( r->kind != VTOKEN_IDENT )
+        return VerilogError(r, "expected an identifier.");
+    *name = r->token;
+    NextToken(r);
+    return true;
+}
+
+static bool ParseInt(VerilogReader* r, int* value)
+{
+    if ( r->kind != VTOKEN_NUMBER )
+        return VerilogError(r, "expected a number.");
+    *value = 0;
+    for (uint32_t i = 0; i < r->token.n; ++i)
+    {
+        char c = r->token.p[i];
+        if ( c < '0' || c > '9' )
+            return VerilogError(r, "expected a decimal number.");
+        *value = *value * 10 + (c - '0');
+    }
+    NextToken(r);
+    return true;
+}
+
+// "[msb:lsb]" opcional de uma declaração.
+static bool ParseRange(VerilogReader* r, int* msb, int* lsb, bool* has_range)
+{
+    *has_range = Accept(r, '[');
+    *msb = *lsb = 0;
+    if ( !*has_range )
+        return true;
+    return ParseInt(r, msb) && Expect(r, ':') && ParseInt(r, lsb) && Expect(r, ']');
+}
+
+static VSignal* DeclareSignal(VerilogReader* r, VModule* m, const Token& name, int msb, int lsb, bool has_range, int dir)
+{
+    uint32_t* index = NameTable_Slot(&m->signal_index, name);
+    if ( *index != NETLIST_NONE )
+    {
+        // Ex: "output y;" seguido de "wire y;".
+        VSignal& s = m->signals[*index];
+        bool scalar = s.msb == s.lsb && !has_range;
+        if ( (s.msb != msb || s.lsb != lsb) && !scalar )
+        {
+            VerilogError(r, "signal redeclared with a different width.");
+            return NULL;
+        }
+        if ( dir != VDIR_WIRE )
+            s.dir = dir;
+        s.declared = true;
+        for (int i = 0; i <= (s.msb > s.lsb ? s.msb - s.lsb : s.lsb - s.msb); ++i)
+            m->net_dir[s.first + i] = (uint8_t)s.dir;
+        return &s;
+    }
+
+    VSignal s;
+    s.first = (uint32_t)m->net_name.size();
+    s.msb = msb;
+    s.lsb = lsb;
+    s.dir = dir;
+    s.declared = true;
+    int step = msb >= lsb ? -1 : 1;
+    for (int bit = msb; ; bit += step)
+    {
+        m->net_name.push_back(name);
+        m->net_bit.push_back(has_range ? bit : VBIT_SCALAR);
+        m->net_dir.push_back((uint8_t)dir);
+        if ( bit == lsb )
+            break;
+    }
+    *index = (uint32_t)m->signals.size();
+    m->signals.push_back(s);
+    return &m->signals.back();
+}
+
+// Bits de uma constante "N'bXXX" (também 'h, 'o e 'd), do mais significativo
+// para o menos.
+static bool ParseConstant(VerilogReader* r, std::vector<uint32_t>* bits)
+{
+    const char* p = r->token.p;
+    const char* end = p + r->token.n;
+    int width = 0;
+    bool sized = false;
+    while ( p < end && *p >= '0' && *p <= '9' )
+    {
+        width = width * 10 + (*p++ - '0');
+        sized = true;
+    }
+
+    unsigned long long value = 0;
+    if ( p == end )
+    {
+        // Decimal sem base: 0 ou 1, como um único bit.
+        value = (unsigned long long)width;
+        width = 1;
+        if ( value > 1 )
+            return VerilogError(r, "unsized constants other than 0 and 1 are not supported.");
+    }
+    else
+    {
+        p += 1; // '\''
+        if ( p < end && (*p == 's' || *p == 'S') )
+            p += 1;
+        char base = p < end ? (char)tolower((unsigned char)*p++) : 0;
+        int radix = base == 'b' ? 2 : base == 'o' ? 8 : base == 'h' ? 16 : base == 'd' ? 10 : 0;
+        if ( radix == 0 || !sized || width > 64 )
+            return VerilogError(r, "unsupported constant (expected a sized constant of up to 64 bits).");
+        for (; p < end; ++p)
+        {
+            if ( *p == '_' )
+                continue;
+            int digit = (*p >= '0' && *p <= '9') ? *p - '0'
+                      : (tolower((unsigned char)*p) >= 'a' && tolower((unsigned char)*p) <= 'f') ? tolower((unsigned char)*p) - 'a' + 10 : 99;
+            if ( digit >= radix )
+                return VerilogError(r, "unsupported digit in constant (x and z are not supported).");
+            value = value * radix + digit;
+        }
+    }
+
+    for (int i = width - 1; i >= 0; --i)
+        bits->push_back(((value >> i) & 1) ? VLOCAL_CONST1 : VLOCAL_CONST0);
+    NextToken(r);
+    return true;
+}
+
+// Sinal: identificador, bit ("x[3]"), trecho ("x[3:0]"), constante ou
+// concatenação. Acrescenta as nets locais a "bits", do bit mais
+// significativo para o menos.
+static bool ParseExpression(VerilogReader* r, VModule* m, std::vector<uint32_t>* bits)
+{
+    if ( r->kind == VTOKEN_NUMBER )
+        return ParseConstant(r, bits);
+
+    if ( Accept(r, '{') )
+    {
+        do
+        {
+            if ( !ParseExpression(r, m, bits) )
+                return false;
+        } while ( Accept(r, ',') );
+        return Expect(r, '}');
+    }
+
+    Token name;
+    if ( !ExpectIdent(r, &name) )
+        return false;
+
+    VSignal* s;
+    uint32_t index = NameTable_Find(&m->signal_index, name);
+    if ( index != NETLIST_NONE )
+        s = &m->signals[index];
+    else
+    {
+        // Net implícita de um bit.
+        s = DeclareSignal(r, m, name, 0, 0, false, VDIR_WIRE);
+        if ( s == NULL )
+            return false;
+        s->declared = false;
+    }
+
+    int msb = s->msb, lsb = s->lsb;
+    if ( Accept(r, '[') )
+    {
+        if ( !ParseInt(r, &msb) )
+            return false;
+        lsb = msb;
+        if ( Accept(r, ':') && !ParseInt(r, &lsb) )
+            return false;
+        if ( !Expect(r, ']') )
+            return false;
+
+        int low = s->msb < s->lsb ? s->msb : s->lsb;
+        int high = s->msb < s->lsb ? s->lsb : s->msb;
+        if ( msb < low || msb > high || lsb < low || lsb > high )
+            return VerilogError(r, "bit select out of range.");
+    }
+
+    int step = msb >= lsb ? -1 : 1;
+    for (int bit = msb; ; bit += step)
+    {
+        bits->push_back(s->first + (uint32_t)(s->msb >= s->lsb ? s->msb - bit : bit - s->msb));
+        if ( bit == lsb )
+            break;
+    }
+    return true;
+}
+
+static int PrimitiveType(const Token& name)
+{
+    if ( TokenIs(name, "and") )  return GATE_AND;
+    if ( TokenIs(name, "or") )   return GATE_OR;
+    if ( TokenIs(name, "nand") ) return GATE_NAND;
+    if ( TokenIs(name, "nor") )  return GATE_NOR;
+    if ( TokenIs(name, "xor") )  return GATE_XOR;
+    if ( TokenIs(name, "xnor") ) return GATE_XNOR;
+    if ( TokenIs(name, "not") )  return GATE_NOT;
+    if ( TokenIs(name, "buf") )  return GATE_BUF;
+    return -1;
+}
+
+static void AddModuleGate(VModule* m, int type, const uint32_t* pins, uint32_t count)
+{
+    VGate gate;
+    gate.type = type;
+    gate.begin = (uint32_t)m->pins.size();
+    gate.count = count;
+    m->pins.insert(m->pins.end(), pins, pins + count);
+    m->gates.push_back(gate);
+}
+
+// "and g1 (y, a, b), g2 (...);" depois do nome da primitiva.
+static bool ParsePrimitive(VerilogReader* r, VModule* m, int type)
+{
+    std::vector<uint32_t> pins;
+    do
+    {
+        if ( r->kind == VTOKEN_IDENT )
+            NextToken(r); // Nome da instância, opcional
+        if ( !Expect(r, '(') )
+            return false;
+
+        pins.clear();
+        do
+        {
+            size_t before = pins.size();
+            if ( !ParseExpression(r, m, &pins) )
+                return false;
+            if ( pins.size() != before + 1 )
+                return VerilogError(r, "primitive gate terminals must be 1 bit wide.");
+        } while ( Accept(r, ',') );
+        if ( !Expect(r, ')') )
+            return false;
+
+        if ( pins.size() < 2 )
+            return VerilogError(r, "primitive gate needs an output and at least one input.");
+        if ( type == GATE_BUF || type == GATE_NOT )
+        {
+            // Várias saídas, uma entrada (a última).
+            for (size_t i = 0; i + 1 < pins.size(); ++i)
+            {
+                uint32_t gate_pins[2] = { pins[i], pins.back() };
+                AddModuleGate(m, type, gate_pins, 2);
+            }
+        }
+        else
+            AddModuleGate(m, type, pins.data(), (uint32_t)pins.size());
+    } while ( Accept(r, ',') );
+    return Expect(r, ';');
+}
+
+static bool ParseAssign(VerilogReader* r, VModule* m)
+{
+    std::vector<uint32_t> lhs, rhs;
+    do
+    {
+        lhs.clear();
+        rhs.clear();
+        if ( !ParseExpression(r, m, &lhs) || !Expect(r, '=') )
+            return false;
+        bool invert = Accept(r, '~');
+        if ( !ParseExpression(r, m, &rhs) )
+            return false;
+        if ( lhs.size() != rhs.size() )
+            return VerilogError(r, "assign with operands of different widths.");
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            uint32_t pins[2] = { lhs[i], rhs[i] };
+            AddModuleGate(m, invert ? GATE_NOT : GATE_BUF, pins, 2);
+        }
+    } while ( Accept(r, ',') );
+    return Expect(r, ';');
+}
+
+// "modulo u1 (.a(x), .b(y)), u2 (x, y);" depois do nome do módulo.
+static bool ParseInstances(VerilogReader* r, VModule* m, const Token& module)
+{
+    if ( IsSymbol(r, '#') )
+        return VerilogError(r, "module parameters are not supported.");
+    do
+    {
+        VInstance instance;
+        instance.module = module;
+        instance.line = r->token_line;
+        if ( r->kind != VTOKEN_IDENT )
+        {
+            std::string message = "unsupported statement \"" + std::string(module.p, module.n) + "\" (expected a declaration, assign, primitive or module instance).";
+            return VerilogError(r, message.c_str());
+        }
+        if ( !ExpectIdent(r, &instance.name) || !Expect(r, '(') )
+            return false;
+        instance.first_connection = (uint32_t)m->connections.size();
+
+        if ( !IsSymbol(r, ')') )
+        {
+            do
+            {
+                VConnection connection;
+                connection.port.p = NULL;
+                connection.port.n = 0;
+                connection.connected = true;
+                if ( Accept(r, '.') )
+                {
+                    if ( !ExpectIdent(r, &connection.port) || !Expect(r, '(') )
+                        return false;
+                    connection.connected = !IsSymbol(r, ')');
+                }
+                connection.begin = (uint32_t)m->pins.size();
+                if ( connection.connected && !ParseExpression(r, m, &m->pins) )
+                    return false;
+                connection.count = (uint32_t)m->pins.size() - connection.begin;
+                if ( connection.port.n != 0 && !Expect(r, ')') )
+                    return false;
+                m->connections.push_back(connection);
+            } while ( Accept(r, ',') );
+        }
+        if ( !Expect(r, ')') )
+            return false;
+
+        instance.num_connections = (uint32_t)m->connections.size() - instance.first_connection;
+        m->instances.push_back(instance);
+    } while ( Accept(r, ',') );
+    return Expect(r, ';');
+}
+
+// "input [3:0] a, b;" depois da direção. Com "ansi", faz parte da lista de
+// portas do cabeçalho e termina em ',' seguida de outra direção, ou em ')'.
+static bool ParseDeclaration(VerilogReader* r, VModule* m, int dir, bool ansi)
+{
+    if ( r->kind == VTOKEN_IDENT && (TokenIs(r->token, "wire") || TokenIs(r->token, "reg")) )
+        NextToken(r);
+
+    int msb, lsb;
+    bool has_range;
+    if ( !ParseRange(r, &msb, &lsb, &has_range) )
+        return false;
+
+    Token name;
+    for (;;)
+    {
+        if ( !ExpectIdent(r, &name) )
+            return false;
+        if ( DeclareSignal(r, m, name, msb, lsb, has_range, dir) == NULL )
+            return false;
+        if ( ansi )
+            m->port_names.push_back(name);
+
+        if ( !IsSymbol(r, ',') )
+            break;
+        NextToken(r);
+        if ( ansi && r->kind == VTOKEN_IDENT
+          && (TokenIs(r->token, "input") || TokenIs(r->token, "output") || TokenIs(r->token, "inout")) )
+            return true; // A próxima declaração começa
+    }
+    return ansi ? true : Expect(r, ';');
+}
+
+static int DirectionKeyword(const Token& token)
+{
+    if ( TokenIs(token, "input") )  return VDIR_INPUT;
+    if ( TokenIs(token, "output") ) return VDIR_OUTPUT;
+    if ( TokenIs(token, "wire") || TokenIs(token, "reg") || TokenIs(token, "tri") ) return VDIR_WIRE;
+    return -1;
+}
+
+static bool ParseModule(VerilogReader* r)
+{
+    VModule m;
+    m.instantiated = false;
+    m.elaborating = false;
+    NameTable_Init(&m.signal_index, 16);
+    int module_line = r->token_line;
+    NextToken(r); // "module"
+    if ( !ExpectIdent(r, &m.name) )
+        return false;
+
+    // Lista de portas: só nomes, ou declarações no estilo ANSI.
+    if ( Accept(r, '(') && !IsSymbol(r, ')') )
+    {
+        for (;;)
+        {
+            if ( r->kind == VTOKEN_IDENT && TokenIs(r->token, "inout") )
+                return VerilogError(r, "inout ports are not supported.");
+            int dir = r->kind == VTOKEN_IDENT ? DirectionKeyword(r->token) : -1;
+            if ( dir == VDIR_INPUT || dir == VDIR_OUTPUT )
+            {
+                NextToken(r);
+                if ( !ParseDeclaration(r, &m, dir, true) )
+                    return false;
+                if ( IsSymbol(r, ')') )
+                    break;
+                continue;
+            }
+
+            Token name;
+            if ( !ExpectIdent(r, &name) )
+                return false;
+            m.port_names.push_back(name);
+            if ( !Accept(r, ',') )
+                break;
+        }
+        if ( !Expect(r, ')') )
+            return false;
+    }
+    else if ( IsSymbol(r, ')') )
+        NextToken(r);
+    if ( !Expect(r, ';') )
+        return false;
+
+    while ( r->ok )
+    {
+        if ( r->kind == VTOKEN_END )
+            return VerilogError(r, "missing endmodule.");
+        if ( r->kind != VTOKEN_IDENT )
+            return VerilogError(r, "expected a declaration, assign or instance.");
+
+        if ( TokenIs(r->token, "endmodule") )
+        {
+            NextToken(r);
+            break;
+        }
+        if ( TokenIs(r->token, "inout") )
+            return VerilogError(r, "inout ports are not supported.");
+
+        int dir = DirectionKeyword(r->token);
+        if ( dir >= 0 )
+        {
+            NextToken(r);
+            ParseDeclaration(r, &m, dir, false);
+            continue;
+        }
+        if ( TokenIs(r->token, "assign") )
+        {
+            NextToken(r);
+            ParseAssign(r, &m);
+            continue;
+        }
+
+        Token word = r->token;
+        NextToken(r);
+        int type = PrimitiveType(word);
+        if ( type >= 0 )
+            ParsePrimitive(r, &m, type);
+        else
+            ParseInstances(r, &m, word);
+    }
+    if ( !r->ok )
+        return false;
+
+    // Todas as portas precisam ter sido declaradas com uma direção.
+    for (size_t i = 0; i < m.port_names.size(); ++i)
+    {
+        uint32_t index = NameTable_Find(&m.signal_index, m.port_names[i]);
+        if ( index == NETLIST_NONE || m.signals[index].dir == VDIR_WIRE )
+        {
+            r->token_line = module_line;
+            std::string message = "port \"" + std::string(m.port_names[i].p, m.port_names[i].n) + "\" of module \""
+                                + std::string(m.name.p, m.name.n) + "\" has no input or output declaration.";
+            return VerilogError(r, message.c_str());
+        }
+    }
+
+    uint32_t* index = NameTable_Slot(&r->module_index, m.name);
+    if ( *index != NETLIST_NONE )
+    {
+        r->token_line = module_line;
+        return VerilogError(r, "module defined more than once.");
+    }
+    *index = (uint32_t)r->modules.size();
+    r->modules.push_back(std::move(m));
+    return true;
+}
+
+static uint32_t GlobalNet(VerilogReader* r, const std::vector<uint32_t>& map, uint32_t local)
+{
+    if ( local == VLOCAL_CONST0 )
+        return Const0(&r->builder);
+    if ( local == VLOCAL_CONST1 )
+        return Const1(&r->builder);
+    return map[local];
+}
+
+// Bits de uma porta do módulo, em nets locais.
+static void PortBits(const VSignal& s, std::vector<uint32_t>* bits)
+{
+    uint32_t width = (uint32_t)(s.msb > s.lsb ? s.msb - s.lsb : s.lsb - s.msb) + 1;
+    for (uint32_t i = 0; i < width; ++i)
+        bits->push_back(s.first + i);
+}
+
+// Nome no netlist da net local "net": "prefixo" + "x" ou "x[3]".
+static void LocalNetName(const VModule& m, uint32_t net, const std::string& prefix, std::string* name)
+{
+    name->assign(prefix);
+    name->append(m.net_name[net].p, m.net_name[net].n);
+    if ( m.net_bit[net] != VBIT_SCALAR )
+    {
+        char index[16];
+        snprintf(index, sizeof(index), "[%d]", m.net_bit[net]);
+        name->append(index);
+    }
+}
+
+// Cria as nets e portas do módulo "module" no netlist. "map" leva cada net local
+// à net do netlist; as nets ligadas às portas já vêm preenchidas pelo pai.
+static bool Elaborate(VerilogReader* r, size_t module, const std::string& prefix, std::vector<uint32_t>& map)
+{
+    Netlist* netlist = r->builder.netlist;
+    const VModule& m = r->modules[module];
+    if ( m.elaborating )
+    {
+        fprintf(stderr, "ERROR: %s: module \"%.*s\" is instantiated recursively.\n", r->filename, (int)m.name.n, m.name.p);
+        return false;
+    }
+    r->modules[module].elaborating = true;
+
+    std::string name;
+    for (uint32_t i = 0; i < (uint32_t)m.net_name.size(); ++i)
+    {
+        if ( map[i] == NETLIST_NONE )
+        {
+            LocalNetName(m, i, prefix, &name);
+            map[i] = Netlist_AddNet(netlist, name.c_str());
+        }
+    }
+
+    std::vector<uint32_t> pins;
+    for (size_t g = 0; g < m.gates.size(); ++g)
+    {
+        const VGate& gate = m.gates[g];
+        pins.clear();
+        for (uint32_t i = 1; i < gate.count; ++i)
+            pins.push_back(GlobalNet(r, map, m.pins[gate.begin + i]));
+        uint32_t output = m.pins[gate.begin];
+        if ( output == VLOCAL_CONST0 || output == VLOCAL_CONST1 )
+        {
+            fprintf(stderr, "ERROR: %s: gate in module \"%.*s\" drives a constant.\n", r->filename, (int)m.name.n, m.name.p);
+            return false;
+        }
+        Netlist_AddGate(netlist, gate.type, pins.data(), (int)pins.size(), map[output]);
+    }
+
+    std::vector<uint32_t> port_bits;
+    std::vector<uint32_t> child_map;
+    for (size_t i = 0; i < m.instances.size(); ++i)
+    {
+        const VInstance& instance = m.instances[i];
+        uint32_t found = NameTable_Find(&r->module_index, instance.module);
+        if ( found == NETLIST_NONE )
+        {
+            fprintf(stderr, "ERROR: %s:%d: unknown module or primitive \"%.*s\".\n",
+                    r->filename, instance.line, (int)instance.module.n, instance.module.p);
+            return false;
+        }
+        const VModule& child = r->modules[found];
+        child_map.assign(child.net_name.size(), NETLIST_NONE);
+
+        for (uint32_t c = 0; c < instance.num_connections; ++c)
+        {
+            const VConnection& connection = m.connections[instance.first_connection + c];
+            const Token* port = &connection.port;
+            if ( port->n == 0 )
+            {
+                if ( c >= child.port_names.size() )
+                {
+                    fprintf(stderr, "ERROR: %s:%d: too many connections for module \"%.*s\".\n",
+                            r->filename, instance.line, (int)child.name.n, child.name.p);
+                    return false;
+                }
+                port = &child.port_names[c];
+            }
+            uint32_t index = NameTable_Find(&child.signal_index, *port);
+            if ( index == NETLIST_NONE || child.signals[index].dir == VDIR_WIRE )
+            {
+                fprintf(stderr, "ERROR: %s:%d: module \"%.*s\" has no port \"%.*s\".\n",
+                        r->filename, instance.line, (int)child.name.n, child.name.p, (int)port->n, port->p);
+                return false;
+            }
+            if ( !connection.connected )
+                continue;
+
+            const VSignal& s = child.signals[index];
+            port_bits.clear();
+            PortBits(s, &port_bits);
+            if ( port_bits.size() != connection.count )
+            {
+                fprintf(stderr, "ERROR: %s:%d: port \"%.*s\" of module \"%.*s\" is %zu bits wide, connected to %u bits.\n",
+                        r->filename, instance.line, (int)port->n, port->p, (int)child.name.n, child.name.p,
+                        port_bits.size(), connection.count);
+                return false;
+            }
+            for (size_t b = 0; b < port_bits.size(); ++b)
+            {
+                uint32_t local = m.pins[connection.begin + b];
+                if ( s.dir == VDIR_OUTPUT && (local == VLOCAL_CONST0 || local == VLOCAL_CONST1) )
+                {
+                    fprintf(stderr, "ERROR: %s:%d: output port \"%.*s\" connected to a constant.\n",
+                            r->filename, instance.line, (int)port->n, port->p);
+                    return false;
+                }
+                child_map[port_bits[b]] = GlobalNet(r, map, local);
+            }
+        }
+
+        if ( !Elaborate(r, found, prefix + std::string(instance.name.p, instance.name.n) + ".", child_map) )
+            return false;
+    }
+    r->modules[module].elaborating = false;
+    return true;
+}
+
+bool NetlistLoader_LoadVerilog(const char* filename, Netlist* netlist, NetlistLoadStats* stats)
+{
+    TRACE_SCOPE("NetlistLoader_LoadVerilog");
+
+    MappedFile file;
+    std::chrono::steady_clock::time_point start;
+    if ( !BeginLoad(filename, &file, &start) )
+        return false;
+
+    VerilogReader r;
+    r.filename = filename;
+    r.p = file.data;
+    r.end = file.data + file.size;
+    r.line = 1;
+    r.ok = true;
+    NameTable_Init(&r.module_index, 16);
+    InitBuilder(&r.builder, netlist);
+
+    NextToken(&r);
+    while ( r.ok && r.kind != VTOKEN_END )
+    {
+        if ( r.kind == VTOKEN_IDENT && TokenIs(r.token, "module") )
+            ParseModule(&r);
+        else
+            VerilogError(&r, "expected \"module\".");
+    }
+    if ( r.ok && r.modules.empty() )
+    {
+        fprintf(stderr, "ERROR: %s: no modules found.\n", filename);
+        r.ok = false;
+    }
+
+    if ( r.ok )
+    {
+        // O módulo principal é o último que nenhum outro instancia.
+        for (size_t i = 0; i < r.modules.size(); ++i)
+        {
+            for (size_t k = 0; k < r.modules[i].instances.size(); ++k)
+            {
+                uint32_t found = NameTable_Find(&r.module_index, r.modules[i].instances[k].module);
+                if ( found != NETLIST_NONE )
+                    r.modules[found].instantiated = true;
+            }
+        }
+        size_t top = r.modules.size() - 1;
+        for (size_t i = 0; i < r.modules.size(); ++i)
+            if ( !r.modules[i].instantiated )
+                top = i;
+        const VModule& m = r.modules[top];
+
+        // Portas do módulo principal: entradas e saídas primárias, na ordem
+        // do cabeçalho.
+        std::vector<uint32_t> map(m.net_name.size(), NETLIST_NONE);
+        std::vector<uint32_t> bits;
+        std::string name;
+        for (size_t i = 0; i < m.port_names.size(); ++i)
+        {
+            const VSignal& s = m.signals[NameTable_Find(&m.signal_index, m.port_names[i])];
+            bits.clear();
+            PortBits(s, &bits);
+            for (size_t b = 0; b < bits.size(); ++b)
+            {
+                LocalNetName(m, bits[b], "", &name);
+                if ( s.dir == VDIR_INPUT )
+                    map[bits[b]] = Netlist_AddInput(netlist, name.c_str());
+                else
+                {
+                    map[bits[b]] = Netlist_AddNet(netlist, name.c_str());
+                    Netlist_AddOutput(netlist, map[bits[b]]);
+                }
+            }
+        }
+        r.ok = Elaborate(&r, top, "", map);
+    }
+
+    return FinishLoad(r.ok, netlist, &file, start, stats);
+}
@@ -0,0 +1,297 @@
+#include "objects.h"
+#include "trace.h"
+
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+// Cálculo das normais de vértices de um ObjModel (veja ComputeNormals()).
+//
+// Os triângulos são processados em blocos de 4 com instruções SIMD (SSE2,
+// quando disponível), e em paralelo por várias threads, cada uma sobre um
+// intervalo contíguo de triângulos. Cada thread acumula as normais em seu
+// próprio vetor (x, y e z separados), evitando condições de corrida; depois os
+// acumuladores são somados e normalizados, também em paralelo e em blocos de 4
+// vértices.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+
+typedef __m128 float4;
+
+static inline float4 F4_Set1(float x)                  { return _mm_set1_ps(x); }
+static inline float4 F4_Load(const float* p)           { return _mm_loadu_ps(p); }
+static inline void   F4_Store(float* p, float4 a)      { _mm_storeu_ps(p, a); }
+static inline float4 F4_Add(float4 a, float4 b)        { return _mm_add_ps(a, b); }
+static inline float4 F4_Sub(float4 a, float4 b)        { return _mm_sub_ps(a, b); }
+static inline float4 F4_Mul(float4 a, float4 b)        { return _mm_mul_ps(a, b); }
+static inline float4 F4_Div(float4 a, float4 b)        { return _mm_div_ps(a, b); }
+static inline float4 F4_Min(float4 a, float4 b)        { return _mm_min_ps(a, b); }
+static inline float4 F4_Max(float4 a, float4 b)        { return _mm_max_ps(a, b); }
+static inline float4 F4_Sqrt(float4 a)                 { return _mm_sqrt_ps(a); }
+static inline float4 F4_Abs(float4 a)                  { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+// Para cada posição, retorna "b" se a < 0 e "c" caso contrário.
+static inline float4 F4_SelectNegative(float4 a, float4 b, float4 c)
+{
+    __m128 mask = _mm_cmplt_ps(a, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, c));
+}
+
+#else // Sem SSE2: mesmas operações, posição por posição.
+
+struct float4 { float v[4]; };
+
+#define F4_LANEWISE(expr) float4 r; for (int i = 0; i < 4; ++i) r.v[i] = (expr); return r;
+
+static inline float4 F4_Set1(float x)                  { F4_LANEWISE(x) }
+static inline float4 F4_Load(const float* p)           { F4_LANEWISE(p[i]) }
+static inline void   F4_Store(float* p, float4 a)      { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+static inline float4 F4_Add(float4 a, float4 b)        { F4_LANEWISE(a.v[i] + b.v[i]) }
+static inline float4 F4_Sub(float4 a, float4 b)        { F4_LANEWISE(a.v[i] - b.v[i]) }
+static inline float4 F4_Mul(float4 a, float4 b)        { F4_LANEWISE(a.v[i] * b.v[i]) }
+static inline float4 F4_Div(float4 a, float4 b)        { F4_LANEWISE(a.v[i] / b.v[i]) }
+static inline float4 F4_Min(float4 a, float4 b)        { F4_LANEWISE(std::min(a.v[i], b.v[i])) }
+static inline float4 F4_Max(float4 a, float4 b)        { F4_LANEWISE(std::max(a.v[i], b.v[i])) }
+static inline float4 F4_Sqrt(float4 a)                 { F4_LANEWISE(std::sqrt(a.v[i])) }
+static inline float4 F4_Abs(float4 a)                  { F4_LANEWISE(std::fabs(a.v[i])) }
+static inline float4 F4_SelectNegative(float4 a, float4 b, float4 c) { F4_LANEWISE(a.v[i] < 0.0f ? b.v[i] : c.v[i]) }
+
+#undef F4_LANEWISE
+
+#endif
+
+// Aproximação de acos(x), x em [-1,1], com erro máximo de ~7e-5 radianos
+// (Abramowitz & Stegun, 4.4.45). Suficiente para ponderar normais.
+static inline float4 F4_Acos(float4 x)
+{
+    float4 ax = F4_Abs(x);
+    float4 p  = F4_Set1(-0.0187293f);
+    p = F4_Add(F4_Mul(p, ax), F4_Set1(0.0742610f));
+    p = F4_Add(F4_Mul(p, ax), F4_Set1(-0.2121144f));
+    p = F4_Add(F4_Mul(p, ax), F4_Set1(1.5707288f));
+    float4 r = F4_Mul(F4_Sqrt(F4_Sub(F4_Set1(1.0f), ax)), p);
+    return F4_SelectNegative(x, F4_Sub(F4_Set1(3.14159265f), r), r);
+}
+
+// Cosseno do ângulo entre as arestas "u" e "v", limitado a [-1,1].
+static inline float4 CornerCosine(float4 dot, float4 length_u, float4 length_v)
+{
+    float4 denominator = F4_Max(F4_Mul(length_u, length_v), F4_Set1(1e-30f));
+    float4 c = F4_Div(dot, denominator);
+    return F4_Min(F4_Max(c, F4_Set1(-1.0f)), F4_Set1(1.0f));
+}
+
+static inline float4 Dot3(float4 ux, float4 uy, float4 uz, float4 vx, float4 vy, float4 vz)
+{
+    return F4_Add(F4_Add(F4_Mul(ux, vx), F4_Mul(uy, vy)), F4_Mul(uz, vz));
+}
+
+// Acumuladores de normais de uma thread, com as componentes x, y e z em
+// vetores separados para que a soma final seja feita em blocos de 4 vértices.
+struct NormalAccumulator
+{
+    std::vector<float> x, y, z;
+};
+
+// Acumula as normais dos triângulos [first_triangle, last_triangle) do
+// modelo, numerados sequencialmente ao longo de todas as formas.
+// "shape_first_triangle[s]" é o número do primeiro triângulo da forma s.
+static void AccumulateFaceNormals(ObjModel* model, const std::vector<size_t>& shape_first_triangle,
+                                  size_t first_triangle, size_t last_triangle, NormalAccumulator* accumulator)
+{
+    const float* positions = model->attrib.vertices.data();
+    float* acc_x = accumulator->x.data();
+    float* acc_y = accumulator->y.data();
+    float* acc_z = accumulator->z.data();
+
+    size_t shape = std::upper_bound(shape_first_triangle.begin(), shape_first_triangle.end(), first_triangle)
+                 - shape_first_triangle.begin() - 1;
+
+    size_t triangle = first_triangle;
+    while ( triangle < last_triangle )
+    {
+        while ( triangle >= shape_first_triangle[shape + 1] )
+            shape += 1;
+
+        tinyobj::index_t* indices = model->shapes[shape].mesh.indices.data();
+        size_t local_first = triangle - shape_first_triangle[shape];
+        size_t local_last  = std::min(last_triangle, shape_first_triangle[shape + 1]) - shape_first_triangle[shape];
+
+        for (size_t block = local_first; block < local_last; block += 4)
+        {
+            size_t count = std::min((size_t)4, local_last - block);
+
+            // Copiamos os vértices dos (até) 4 triângulos do bloco para o
+            // formato "uma componente por registrador". Posições não utilizadas
+            // ficam zeradas e resultam em normais nulas.
+            float p[9][4] = {};
+            int   v[3][4];
+            for (size_t t = 0; t < count; ++t)
+            {
+                assert(model->shapes[shape].mesh.num_face_vertices[block + t] == 3);
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    tinyobj::index_t& idx = indices[3*(block + t) + corner];
+                    idx.normal_index = idx.vertex_index;
+                    v[corner][t] = idx.vertex_index;
+                    p[3*corner + 0][t] = positions[3*idx.vertex_index + 0];
+                    p[3*corner + 1][t] = positions[3*idx.vertex_index + 1];
+                    p[3*corner + 2][t] = positions[3*idx.vertex_index + 2];
+                }
+            }
+
+            float4 ax = F4_Load(p[0]), ay = F4_Load(p[1]), az = F4_Load(p[2]);
+            float4 bx = F4_Load(p[3]), by = F4_Load(p[4]), bz = F4_Load(p[5]);
+            float4 cx = F4_Load(p[6]), cy = F4_Load(p[7]), cz = F4_Load(p[8]);
+
+            // Arestas e0 = b-a, e1 = c-b, e2 = a-c
+            float4 e0x = F4_Sub(bx, ax), e0y = F4_Sub(by, ay), e0z = F4_Sub(bz, az);
+            float4 e1x = F4_Sub(cx, bx), e1y = F4_Sub(cy, by), e1z = F4_Sub(cz, bz);
+            float4 e2x = F4_Sub(ax, cx), e2y = F4_Sub(ay, cy), e2z = F4_Sub(az, cz);
+
+            // Normal da face: (b-a) x (c-a) = e0 x (-e2). Seu comprimento é o
+            // dobro da área do triângulo, o que pondera a normal pela área.
+            float4 nx = F4_Sub(F4_Mul(e2y, e0z), F4_Mul(e2z, e0y));
+            float4 ny = F4_Sub(F4_Mul(e2z, e0x), F4_Mul(e2x, e0z));
+            float4 nz = F4_Sub(F4_Mul(e2x, e0y), F4_Mul(e2y, e0x));
+
+            // Ângulo interno de cada canto, utilizado como segundo peso, para
+            // que a normal não dependa de como a superfície foi triangulada.
+            float4 l0 = F4_Sqrt(Dot3(e0x, e0y, e0z, e0x, e0y, e0z));
+            float4 l1 = F4_Sqrt(Dot3(e1x, e1y, e1z, e1x, e1y, e1z));
+            float4 l2 = F4_Sqrt(Dot3(e2x, e2y, e2z, e2x, e2y, e2z));
+            float4 zero = F4_Set1(0.0f);
+            float4 angle[3];
+            angle[0] = F4_Acos(CornerCosine(F4_Sub(zero, Dot3(e0x, e0y, e0z, e2x, e2y, e2z)), l0, l2));
+            angle[1] = F4_Acos(CornerCosine(F4_Sub(zero, Dot3(e1x, e1y, e1z, e0x, e0y, e0z)), l1, l0));
+            angle[2] = F4_Acos(CornerCosine(F4_Sub(zero, Dot3(e2x, e2y, e2z, e1x, e1y, e1z)), l2, l1));
+
+            float weighted[3][3][4]; // [canto][componente][triângulo]
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                F4_Store(weighted[corner][0], F4_Mul(nx, angle[corner]));
+                F4_Store(weighted[corner][1], F4_Mul(ny, angle[corner]));
+                F4_Store(weighted[corner][2], F4_Mul(nz, angle[corner]));
+            }
+
+            for (size_t t = 0; t < count; ++t)
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    int vertex = v[corner][t];
+                    acc_x[vertex] += weighted[corner][0][t];
+                    acc_y[vertex] += weighted[corner][1][t];
+                    acc_z[vertex] += weighted[corner][2][t];
+                }
+        }
+
+        triangle = shape_first_triangle[shape] + local_last;
+    }
+}
+
+// Soma os acumuladores de todas as threads para os vértices [first, last) e
+// escreve as normais normalizadas em model->attrib.normals.
+static void NormalizeVertexNormals(ObjModel* model, const std::vector<NormalAccumulator>& accumulators, size_t first, size_t last)
+{
+    float* normals = model->attrib.normals.data();
+
+    for (size_t block = first; block < last; block += 4)
+    {
+        size_t count = std::min((size_t)4, last - block);
+
+        float4 x = F4_Set1(0.0f), y = F4_Set1(0.0f), z = F4_Set1(0.0f);
+        for (size_t i = 0; i < accumulators.size(); ++i)
+        {
+            float bx[4] = {}, by[4] = {}, bz[4] = {};
+            for (size_t k = 0; k < count; ++k)
+            {
+                bx[k] = accumulators[i].x[block + k];
+                by[k] = accumulators[i].y[block + k];
+                bz[k] = accumulators[i].z[block + k];
+            }
+            x = F4_Add(x, F4_Load(bx));
+            y = F4_Add(y, F4_Load(by));
+            z = F4_Add(z, F4_Load(bz));
+        }
+
+        // Vértices sem triângulos (ou só com triângulos degenerados) ficam
+        // com normal nula.
+        float4 length = F4_Max(F4_Sqrt(Dot3(x, y, z, x, y, z)), F4_Set1(1e-30f));
+        float nx[4], ny[4], nz[4];
+        F4_Store(nx, F4_Div(x, length));
+        F4_Store(ny, F4_Div(y, length));
+        F4_Store(nz, F4_Div(z, length));
+
+        for (size_t k = 0; k < count; ++k)
+        {
+            normals[3*(block + k) + 0] = nx[k];
+            normals[3*(block + k) + 1] = ny[k];
+            normals[3*(block + k) + 2] = nz[k];
+        }
+    }
+}
+
+// Número mínimo de triângulos por thread; modelos pequenos são processados
+// por uma única thread, pois criar threads custaria mais que o cálculo.
+#define NORMALS_MIN_TRIANGLES_PER_THREAD 32768
+
+// Função que computa as normais de um ObjModel, caso elas não tenham sido
+// especificadas dentro do arquivo ".obj"
+void ComputeNormals(ObjModel* model)
+{
+    if ( !model->attrib.normals.empty() )
+        return;
+
+    TRACE_SCOPE("ComputeNormals");
+
+    // Primeiro computamos as normais para todos os TRIÂNGULOS.
+    // Segundo, computamos as normais dos VÉRTICES através do método proposto
+    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
+    // todas as faces que compartilham este vértice, aqui ponderada pela área
+    // de cada face e pelo ângulo do canto do triângulo naquele vértice.
+
+    size_t num_vertices = model->attrib.vertices.size() / 3;
+
+    std::vector<size_t> shape_first_triangle(model->shapes.size() + 1, 0);
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+        shape_first_triangle[shape + 1] = shape_first_triangle[shape] + model->shapes[shape].mesh.num_face_vertices.size();
+    size_t num_triangles = shape_first_triangle.back();
+
+    size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::max((size_t)1, std::min(num_threads, num_triangles / NORMALS_MIN_TRIANGLES_PER_THREAD));
+
+    std::vector<NormalAccumulator> accumulators(num_threads);
+    model->attrib.normals.resize( 3*num_vertices );
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        size_t first = num_triangles * i / num_threads;
+        size_t last  = num_triangles * (i + 1) / num_threads;
+        NormalAccumulator* accumulator = &accumulators[i];
+        threads.push_back(std::thread([=, &shape_first_triangle]() {
+            Trace_SetThreadName("ComputeNormals");
+            TRACE_SCOPE("AccumulateFaceNormals");
+            accumulator->x.assign(num_vertices, 0.0f);
+            accumulator->y.assign(num_vertices, 0.0f);
+            accumulator->z.assign(num_vertices, 0.0f);
+            AccumulateFaceNormals(model, shape_first_triangle, first, last, accumulator);
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    threads.clear();
+
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        // Os blocos começam em múltiplos de 4 vértices
+        size_t first = (num_vertices * i / num_threads) & ~(size_t)3;
+        size_t last  = (i + 1 == num_threads) ? num_vertices : ((num_vertices * (i + 1) / num_threads) & ~(size_t)3);
+        threads.push_back(std::thread([=, &accumulators]() {
+            Trace_SetThreadName("ComputeNormals");
+            TRACE_SCOPE("NormalizeVertexNormals");
+            NormalizeVertexNormals(model, accumulators, first, last);
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
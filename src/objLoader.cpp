@@ -0,0 +1,498 @@
+#include "objLoader.h"
+#include "mappedFile.h"
+#include "trace.h"
+
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+
+// Pedaços menores que isso não compensam o custo de criar uma thread.
+#define OBJ_MIN_CHUNK_BYTES (1 << 20)
+
+// Potências de 10 exatamente representáveis em double.
+static const double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static inline bool IsDigit(char c) { return (unsigned)(c - '0') < 10; }
+
+static inline const char* SkipSpaces(const char* p, const char* end)
+{
+    while ( p < end && IsSpace(*p) )
+        ++p;
+    return p;
+}
+
+// Interpreta um número em ponto flutuante a partir de "p", sem alocação nem
+// dependência de locale (ao contrário de strtod). Até 19 dígitos significativos
+// são acumulados em um inteiro de 64 bits, que é então escalado por uma
+// potência de 10. O resultado é exato para os números usuais em arquivos
+// ".obj" (até ~15 dígitos e expoentes pequenos) e tem no máximo alguns ulps
+// de erro nos demais casos, bem abaixo da precisão de um float.
+static const char* ParseFloat(const char* p, const char* end, float* value)
+{
+    bool negative = false;
+    if ( p < end && (*p == '-' || *p == '+') )
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool any = false;
+
+    for (; p < end && IsDigit(*p); ++p, any = true)
+    {
+        if ( digits < 19 ) { mantissa = 10*mantissa + (unsigned)(*p - '0'); if ( mantissa ) ++digits; }
+        else               exponent += 1;
+    }
+    if ( p < end && *p == '.' )
+    {
+        for (++p; p < end && IsDigit(*p); ++p, any = true)
+            if ( digits < 19 ) { mantissa = 10*mantissa + (unsigned)(*p - '0'); exponent -= 1; if ( mantissa ) ++digits; }
+    }
+    if ( !any )
+        return NULL;
+
+    if ( p < end && (*p == 'e' || *p == 'E') )
+    {
+        const char* q = p + 1;
+        bool exp_negative = false;
+        if ( q < end && (*q == '-' || *q == '+') )
+        {
+            exp_negative = (*q == '-');
+            ++q;
+        }
+        if ( q < end && IsDigit(*q) )
+        {
+            int e = 0;
+            for (; q < end && IsDigit(*q); ++q)
+                if ( e < 10000 )
+                    e = 10*e + (*q - '0');
+            exponent += exp_negative ? -e : e;
+            p = q;
+        }
+    }
+
+    double d = (double)mantissa;
+    if ( mantissa != 0 && exponent != 0 )
+    {
+        if ( exponent > 0 && exponent <= 22 )
+            d *= POW10[exponent];
+        else if ( exponent < 0 && exponent >= -22 )
+            d /= POW10[-exponent];
+        else
+            d *= std::pow(10.0, (double)exponent);
+    }
+
+    *value = (float)(negative ? -d : d);
+    return p;
+}
+
+static inline const char* ParseInt(const char* p, const char* end, int* value)
+{
+    bool negative = false;
+    if ( p < end && (*p == '-' || *p == '+') )
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+    if ( p >= end || !IsDigit(*p) )
+        return NULL;
+
+    int v = 0;
+    for (; p < end && IsDigit(*p); ++p)
+        v = 10*v + (*p - '0');
+    *value = negative ? -v : v;
+    return p;
+}
+
+// Índices relativos (negativos) de um canto de face. Como cada pedaço não
+// conhece quantos vértices existem nos pedaços anteriores, esses índices são
+// guardados relativos ao início do pedaço e corrigidos ao concatenar.
+#define RELATIVE_VERTEX   1
+#define RELATIVE_TEXCOORD 2
+#define RELATIVE_NORMAL   4
+
+// Resultado da interpretação de um pedaço do arquivo.
+struct ObjChunk
+{
+    std::vector<float>              vertices;
+    std::vector<float>              texcoords;
+    std::vector<float>              normals;
+    std::vector<tinyobj::index_t>   corners;  // 3 cantos por triângulo, índices começando em 0
+    std::vector<std::pair<size_t, unsigned char> > relative; // (canto, RELATIVE_*) com índices relativos ao pedaço
+    std::vector<std::pair<size_t, std::string> >   names;    // (triângulo, nome) para cada "o" ou "g"
+    std::vector<size_t>             quads;    // Primeiro triângulo de cada quadrilátero
+    std::string                     error;
+};
+
+// Converte um índice do arquivo (começando em 1, ou negativo) para começar em
+// 0. "count" é o número de elementos já lidos neste pedaço.
+static inline int ResolveIndex(int index, size_t count, unsigned char flag, unsigned char* relative)
+{
+    if ( index > 0 )
+        return index - 1;
+    *relative |= flag;
+    return (int)count + index;
+}
+
+static void ParseChunk(const char* begin, const char* end, ObjChunk* chunk)
+{
+    Trace_SetThreadName("ObjLoader");
+    TRACE_SCOPE("ParseChunk");
+    Trace_AddArg("bytes", (double)(end - begin));
+
+    std::vector<tinyobj::index_t> polygon;
+    std::vector<unsigned char> polygon_relative;
+
+    const char* line = begin;
+    while ( line < end )
+    {
+        const char* line_end = (const char*)memchr(line, '\n', end - line);
+        if ( line_end == NULL )
+            line_end = end;
+
+        const char* p = SkipSpaces(line, line_end);
+        const char* next = line_end + 1;
+
+        if ( p + 1 < line_end && p[0] == 'v' && IsSpace(p[1]) )
+        {
+            float xyz[3];
+            p += 1;
+            for (int i = 0; i < 3 && p; ++i)
+                p = ParseFloat(SkipSpaces(p, line_end), line_end, &xyz[i]);
+            if ( p == NULL )
+                goto invalid;
+            chunk->vertices.insert(chunk->vertices.end(), xyz, xyz + 3);
+        }
+        else if ( p + 2 < line_end && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2]) )
+        {
+            float xyz[3];
+            p += 2;
+            for (int i = 0; i < 3 && p; ++i)
+                p = ParseFloat(SkipSpaces(p, line_end), line_end, &xyz[i]);
+            if ( p == NULL )
+                goto invalid;
+            chunk->normals.insert(chunk->normals.end(), xyz, xyz + 3);
+        }
+        else if ( p + 2 < line_end && p[0] == 'v' && p[1] == 't' && IsSpace(p[2]) )
+        {
+            float uv[2] = { 0.0f, 0.0f };
+            p = ParseFloat(SkipSpaces(p + 2, line_end), line_end, &uv[0]);
+            if ( p == NULL )
+                goto invalid;
+            const char* q = SkipSpaces(p, line_end); // "v" é opcional
+            if ( q < line_end && ParseFloat(q, line_end, &uv[1]) == NULL )
+                goto invalid;
+            chunk->texcoords.insert(chunk->texcoords.end(), uv, uv + 2);
+        }
+        else if ( p + 1 < line_end && p[0] == 'f' && IsSpace(p[1]) )
+        {
+            polygon.clear();
+            polygon_relative.clear();
+            p = SkipSpaces(p + 1, line_end);
+            while ( p < line_end )
+            {
+                tinyobj::index_t idx;
+                unsigned char relative = 0;
+                int value;
+
+                idx.texcoord_index = -1;
+                idx.normal_index = -1;
+
+                p = ParseInt(p, line_end, &value);
+                if ( p == NULL || value == 0 )
+                    goto invalid;
+                idx.vertex_index = ResolveIndex(value, chunk->vertices.size() / 3, RELATIVE_VERTEX, &relative);
+
+                if ( p < line_end && *p == '/' )
+                {
+                    ++p;
+                    if ( p < line_end && *p != '/' )
+                    {
+                        p = ParseInt(p, line_end, &value);
+                        if ( p == NULL || value == 0 )
+                            goto invalid;
+                        idx.texcoord_index = ResolveIndex(value, chunk->texcoords.size() / 2, RELATIVE_TEXCOORD, &relative);
+                    }
+                    if ( p < line_end && *p == '/' )
+                    {
+                        p = ParseInt(p + 1, line_end, &value);
+                        if ( p == NULL || value == 0 )
+                            goto invalid;
+                        idx.normal_index = ResolveIndex(value, chunk->normals.size() / 3, RELATIVE_NORMAL, &relative);
+                    }
+                }
+
+                polygon.push_back(idx);
+                polygon_relative.push_back(relative);
+                p = SkipSpaces(p, line_end);
+            }
+            if ( polygon.size() < 3 )
+                goto invalid;
+
+            // Triangulação em leque: (0, k, k+1). A diagonal dos
+            // quadriláteros é escolhida depois, em SplitQuad().
+            if ( polygon.size() == 4 )
+                chunk->quads.push_back(chunk->corners.size() / 3);
+            for (size_t k = 1; k + 1 < polygon.size(); ++k)
+            {
+                const size_t corner[3] = { 0, k, k + 1 };
+                for (int i = 0; i < 3; ++i)
+                {
+                    if ( polygon_relative[corner[i]] )
+                        chunk->relative.push_back(std::make_pair(chunk->corners.size(), polygon_relative[corner[i]]));
+                    chunk->corners.push_back(polygon[corner[i]]);
+                }
+            }
+        }
+        else if ( p + 1 < line_end && (p[0] == 'o' || p[0] == 'g') && IsSpace(p[1]) )
+        {
+            const char* name = SkipSpaces(p + 1, line_end);
+            const char* name_end = line_end;
+            while ( name_end > name && IsSpace(name_end[-1]) )
+                --name_end;
+            chunk->names.push_back(std::make_pair(chunk->corners.size() / 3, std::string(name, name_end)));
+        }
+        // Demais comandos (comentários, "s", "mtllib", "usemtl", "l", ...) são ignorados.
+
+        line = next;
+        continue;
+
+    invalid:
+        chunk->error = "linha inválida: \"" + std::string(line, std::min(line_end, line + 80)) + "\"";
+        return;
+    }
+}
+
+static inline float SquaredDistance(const std::vector<float>& vertices, int a, int b)
+{
+    float dx = vertices[3*b + 0] - vertices[3*a + 0];
+    float dy = vertices[3*b + 1] - vertices[3*a + 1];
+    float dz = vertices[3*b + 2] - vertices[3*a + 2];
+    return dx*dx + dy*dy + dz*dz;
+}
+
+// Um quadrilátero é dividido na diagonal mais curta, como na tinyobjloader,
+// para que ambos os leitores produzam os mesmos triângulos. "t" aponta para os
+// 6 cantos da triangulação em leque [0,1,2], [0,2,3].
+static void SplitQuad(const std::vector<float>& vertices, tinyobj::index_t* t)
+{
+    const size_t num_vertices = vertices.size() / 3;
+    tinyobj::index_t c0 = t[0], c1 = t[1], c2 = t[2], c3 = t[5];
+
+    if ( c0.vertex_index < 0 || c1.vertex_index < 0 || c2.vertex_index < 0 || c3.vertex_index < 0
+      || (size_t)c0.vertex_index >= num_vertices || (size_t)c1.vertex_index >= num_vertices
+      || (size_t)c2.vertex_index >= num_vertices || (size_t)c3.vertex_index >= num_vertices )
+        return; // Reportado na validação dos índices
+
+    if ( SquaredDistance(vertices, c0.vertex_index, c2.vertex_index) < SquaredDistance(vertices, c1.vertex_index, c3.vertex_index) )
+        return;
+
+    // [0,1,3], [1,2,3]
+    t[0] = c0; t[1] = c1; t[2] = c3;
+    t[3] = c1; t[4] = c2; t[5] = c3;
+}
+
+bool ObjLoader_Load(const char* filename, tinyobj::attrib_t* attrib, std::vector<tinyobj::shape_t>* shapes, std::string* err)
+{
+    MappedFile file;
+    if ( !MappedFile_Open(filename, &file) )
+    {
+        *err = std::string("Não foi possível abrir o arquivo \"") + filename + "\".";
+        return false;
+    }
+
+    // Dividimos o arquivo em pedaços que começam logo após uma quebra de linha.
+    size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::max((size_t)1, std::min(num_threads, file.size / OBJ_MIN_CHUNK_BYTES));
+
+    std::vector<const char*> bounds(num_threads + 1);
+    bounds[0] = file.data;
+    bounds[num_threads] = file.data + file.size;
+    for (size_t i = 1; i < num_threads; ++i)
+    {
+        const char* p = std::max(bounds[i-1], file.data + file.size * i / num_threads);
+        const char* newline = (const char*)memchr(p, '\n', bounds[num_threads] - p);
+        bounds[i] = newline ? newline + 1 : bounds[num_threads];
+    }
+
+    std::vector<ObjChunk> chunks(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i)
+        threads.push_back(std::thread(ParseChunk, bounds[i], bounds[i+1], &chunks[i]));
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    MappedFile_Close(&file);
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+        if ( !chunks[i].error.empty() )
+        {
+            *err = std::string("Erro em \"") + filename + "\": " + chunks[i].error;
+            return false;
+        }
+
+    // Concatenamos os atributos de todos os pedaços.
+    size_t num_vertices = 0, num_texcoords = 0, num_normals = 0;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        num_vertices  += chunks[i].vertices.size();
+        num_texcoords += chunks[i].texcoords.size();
+        num_normals   += chunks[i].normals.size();
+    }
+
+    *attrib = tinyobj::attrib_t();
+    attrib->vertices.reserve(num_vertices);
+    attrib->texcoords.reserve(num_texcoords);
+    attrib->normals.reserve(num_normals);
+    shapes->clear();
+
+    // Primeiro concatenamos os atributos e corrigimos os índices relativos,
+    // pois a divisão dos quadriláteros precisa de todas as posições.
+    size_t first_vertex = 0, first_texcoord = 0, first_normal = 0;
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        ObjChunk& chunk = chunks[i];
+
+        for (size_t r = 0; r < chunk.relative.size(); ++r)
+        {
+            tinyobj::index_t& idx = chunk.corners[chunk.relative[r].first];
+            if ( chunk.relative[r].second & RELATIVE_VERTEX )   idx.vertex_index   += (int)first_vertex;
+            if ( chunk.relative[r].second & RELATIVE_TEXCOORD ) idx.texcoord_index += (int)first_texcoord;
+            if ( chunk.relative[r].second & RELATIVE_NORMAL )   idx.normal_index   += (int)first_normal;
+        }
+
+        attrib->vertices.insert(attrib->vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+        attrib->texcoords.insert(attrib->texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+        attrib->normals.insert(attrib->normals.end(), chunk.normals.begin(), chunk.normals.end());
+        first_vertex   += chunk.vertices.size() / 3;
+        first_texcoord += chunk.texcoords.size() / 2;
+        first_normal   += chunk.normals.size() / 3;
+
+        // Liberamos a memória do pedaço
+        std::vector<float>().swap(chunk.vertices);
+        std::vector<float>().swap(chunk.texcoords);
+        std::vector<float>().swap(chunk.normals);
+    }
+
+    // Cada "o" ou "g" termina a forma atual, caso ela tenha faces, e define o
+    // nome da próxima (mesmo comportamento da tinyobjloader).
+    tinyobj::shape_t shape;
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        ObjChunk& chunk = chunks[i];
+
+        for (size_t q = 0; q < chunk.quads.size(); ++q)
+            SplitQuad(attrib->vertices, &chunk.corners[3*chunk.quads[q]]);
+
+        size_t triangle = 0;
+        size_t num_triangles = chunk.corners.size() / 3;
+        for (size_t n = 0; n <= chunk.names.size(); ++n)
+        {
+            size_t last = (n < chunk.names.size()) ? chunk.names[n].first : num_triangles;
+
+            shape.mesh.indices.insert(shape.mesh.indices.end(), chunk.corners.begin() + 3*triangle, chunk.corners.begin() + 3*last);
+            shape.mesh.num_face_vertices.insert(shape.mesh.num_face_vertices.end(), last - triangle, 3);
+            shape.mesh.material_ids.insert(shape.mesh.material_ids.end(), last - triangle, -1);
+            shape.mesh.smoothing_group_ids.insert(shape.mesh.smoothing_group_ids.end(), last - triangle, 0);
+            triangle = last;
+
+            if ( n < chunk.names.size() )
+            {
+                if ( !shape.mesh.indices.empty() )
+                {
+                    shapes->push_back(shape);
+                    shape.mesh = tinyobj::mesh_t();
+                }
+                shape.name = chunk.names[n].second;
+            }
+        }
+
+        std::vector<tinyobj::index_t>().swap(chunk.corners);
+    }
+    if ( !shape.mesh.indices.empty() )
+        shapes->push_back(shape);
+
+    // Validamos os índices só agora, quando todos os vértices são conhecidos.
+    for (size_t s = 0; s < shapes->size(); ++s)
+        for (size_t c = 0; c < (*shapes)[s].mesh.indices.size(); ++c)
+        {
+            const tinyobj::index_t& idx = (*shapes)[s].mesh.indices[c];
+            if ( idx.vertex_index < 0 || (size_t)idx.vertex_index >= first_vertex
+              || idx.texcoord_index >= (int)first_texcoord || idx.normal_index >= (int)first_normal
+              || idx.texcoord_index < -1 || idx.normal_index < -1 )
+            {
+                *err = std::string("Erro em \"") + filename + "\": índice de face fora do intervalo no objeto \"" + (*shapes)[s].name + "\".";
+                return false;
+            }
+        }
+
+    return true;
+}
+
+void ObjLoader_Benchmark(const char* filename)
+{
+    const int repetitions = 5;
+
+    FILE* file = fopen(filename, "rb");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot open model file \"%s\".\n", filename);
+        std::exit(EXIT_FAILURE);
+    }
+    fseek(file, 0, SEEK_END);
+    double megabytes = ftell(file) / (1024.0 * 1024.0);
+    fclose(file);
+
+    printf("Benchmark de leitura de \"%s\" (%.1f MB, melhor de %d execuções):\n", filename, megabytes, repetitions);
+
+    for (int loader = 0; loader < 2; ++loader)
+    {
+        double best = 1e30;
+        size_t num_vertices = 0, num_triangles = 0, num_shapes = 0;
+
+        for (int i = 0; i < repetitions; ++i)
+        {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bool ok = (loader == 0)
+                    ? tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, NULL, true)
+                    : ObjLoader_Load(filename, &attrib, &shapes, &err);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if ( !ok )
+            {
+                fprintf(stderr, "ERROR: %s\n", err.c_str());
+                std::exit(EXIT_FAILURE);
+            }
+
+            best = std::min(best, seconds);
+            num_vertices = attrib.vertices.size() / 3;
+            num_shapes = shapes.size();
+            num_triangles = 0;
+            for (size_t s = 0; s < shapes.size(); ++s)
+                num_triangles += shapes[s].mesh.num_face_vertices.size();
+        }
+
+        printf("  %-20s %8.2f ms %8.1f MB/s  (%lu vértices, %lu triângulos, %lu objetos)\n",
+               loader == 0 ? "tinyobj::LoadObj" : "ObjLoader_Load",
+               1000.0 * best, megabytes / best,
+               (unsigned long)num_vertices, (unsigned long)num_triangles, (unsigned long)num_shapes);
+    }
+}
@@ -1,23 +1,122 @@
 #include "objects.h"
+#include "assets.h"
+#include "meshSimplify.h"
+#include "shaderCache.h"
+#include "window.h"
+#include "golden.h"
+
+// Formas com menos triângulos que isso não recebem níveis de detalhe.
+#define LOD_MIN_TRIANGLES 1000
+
+// Gera níveis de detalhe (LOD) para uma forma do ObjModel cujos vértices já
+// foram copiados, um por canto de triângulo, a partir de "first_vertex". Os
+// índices de cada nível são adicionados ao final de "indices", reaproveitando
+// os vértices (e portanto normais e coordenadas de textura) da malha original.
+static void BuildLODs(ObjModel* model, size_t shape, size_t first_vertex, std::vector<GLuint>* indices, SceneObject* theobject)
+{
+    const tinyobj::mesh_t& mesh = model->shapes[shape].mesh;
+    const size_t num_triangles = mesh.num_face_vertices.size();
+
+    // Soldamos os cantos dos triângulos que compartilham a mesma posição no
+    // arquivo ".obj" (vertex_index), pois o simplificador precisa da
+    // conectividade da malha. Para cada vértice soldado guardamos um canto
+    // representativo, utilizado quando um vértice é movido para outro.
+    std::map<int, unsigned> local_vertex;
+    std::vector<float>      positions;
+    std::vector<unsigned>   representative;
+    std::vector<unsigned>   triangles(3 * num_triangles);
+
+    for (size_t corner = 0; corner < 3 * num_triangles; ++corner)
+    {
+        int vertex_index = mesh.indices[corner].vertex_index;
+        std::map<int, unsigned>::iterator it = local_vertex.find(vertex_index);
+        if ( it == local_vertex.end() )
+        {
+            it = local_vertex.insert(std::make_pair(vertex_index, (unsigned)representative.size())).first;
+            positions.push_back(model->attrib.vertices[3*vertex_index + 0]);
+            positions.push_back(model->attrib.vertices[3*vertex_index + 1]);
+            positions.push_back(model->attrib.vertices[3*vertex_index + 2]);
+            representative.push_back((unsigned)corner);
+        }
+        triangles[corner] = it->second;
+    }
+
+    std::vector<size_t> targets;
+    for (size_t lod = 1; lod < MAX_LODS; ++lod)
+        targets.push_back(num_triangles >> (2*lod)); // 1/4, 1/16, 1/64 dos triângulos
+
+    std::vector< std::vector<unsigned> > lods;
+    std::vector< std::vector<unsigned> > sources;
+    SimplifyMeshChain(positions, triangles, targets, std::numeric_limits<double>::max(), &lods, &sources);
+
+    for (size_t level = 0; level < lods.size(); ++level)
+    {
+        size_t lod_triangles = sources[level].size();
+        size_t previous_triangles = theobject->lod_num_indices[theobject->num_lods - 1] / 3;
+
+        // Níveis que quase não reduzem a malha (ex: bordas impedem a
+        // simplificação) não valem a troca.
+        if ( lod_triangles == 0 || lod_triangles > previous_triangles * 9 / 10 )
+            break;
+
+        theobject->lod_first_index[theobject->num_lods] = indices->size();
+
+        for (size_t t = 0; t < lod_triangles; ++t)
+        {
+            unsigned source = sources[level][t];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                // Se o canto não foi movido, usamos o próprio vértice do
+                // triângulo original, preservando suas normais e coordenadas
+                // de textura. Caso contrário, usamos o canto representativo
+                // do vértice para onde ele foi movido.
+                unsigned v = lods[level][3*t + k];
+                size_t corner = (triangles[3*source + k] == v) ? 3*source + k : representative[v];
+                indices->push_back(first_vertex + corner);
+            }
+        }
+
+        theobject->lod_num_indices[theobject->num_lods] = 3 * lod_triangles;
+        theobject->num_lods += 1;
+    }
+}
 
 // Constrói triângulos para futura renderização a partir de um ObjModel.
 void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
 {
+    TRACE_SCOPE("BuildTrianglesAndAddToVirtualScene");
+
     GLuint vertex_array_object_id;
     glGenVertexArrays(1, &vertex_array_object_id);
     glBindVertexArray(vertex_array_object_id);
 
+    // Reservamos de antemão o espaço de todos os vetores a partir do número de
+    // faces, evitando as realocações (e cópias) de push_back(), que em modelos
+    // grandes chegam a dobrar o pico de memória.
+    size_t num_corners = 0;
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+        num_corners += 3 * model->shapes[shape].mesh.num_face_vertices.size();
+
     std::vector<GLuint> indices;
     std::vector<float>  model_coefficients;
     std::vector<float>  normal_coefficients;
     std::vector<float>  texture_coefficients;
 
+    indices.reserve(num_corners + num_corners / 3); // Níveis de detalhe somam ~1/3 dos índices originais
+    model_coefficients.reserve(3 * num_corners);
+    if ( !model->attrib.normals.empty() )
+        normal_coefficients.reserve(3 * num_corners);
+    if ( !model->attrib.texcoords.empty() )
+        texture_coefficients.reserve(2 * num_corners);
+
     for (size_t shape = 0; shape < model->shapes.size(); ++shape)
     {
         size_t first_index = indices.size();
+        size_t first_vertex = model_coefficients.size() / 3;
         size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+        Trace_AddArg("triangles", (double)num_triangles);
 
-        const float minval = std::numeric_limits<float>::min();
+        const float minval = std::numeric_limits<float>::lowest();
         const float maxval = std::numeric_limits<float>::max();
 
         glm::vec3 bbox_min = glm::vec3(maxval,maxval,maxval);
@@ -31,7 +130,7 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
             {
                 tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
 
-                indices.push_back(first_index + 3*triangle + vertex);
+                indices.push_back(first_vertex + 3*triangle + vertex);
 
                 const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
                 const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
@@ -40,7 +139,6 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
                 model_coefficients.push_back( vx ); // X
                 model_coefficients.push_back( vy ); // Y
                 model_coefficients.push_back( vz ); // Z
-                model_coefficients.push_back( 1.0f ); // W
 
                 bbox_min.x = std::min(bbox_min.x, vx);
                 bbox_min.y = std::min(bbox_min.y, vy);
@@ -62,7 +160,6 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
                     normal_coefficients.push_back( nx ); // X
                     normal_coefficients.push_back( ny ); // Y
                     normal_coefficients.push_back( nz ); // Z
-                    normal_coefficients.push_back( 0.0f ); // W
                 }
 
                 if ( idx.texcoord_index != -1 )
@@ -87,17 +184,35 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
         theobject.bbox_min = bbox_min;
         theobject.bbox_max = bbox_max;
 
-        g_VirtualScene[model->shapes[shape].name] = theobject;
+        theobject.num_lods = 1;
+        theobject.lod_first_index[0] = theobject.first_index;
+        theobject.lod_num_indices[0] = theobject.num_indices;
+
+        if ( num_triangles >= LOD_MIN_TRIANGLES )
+        {
+            BuildLODs(model, shape, first_vertex, &indices, &theobject);
+
+            printf("Objeto \"%s\": %d níveis de detalhe (", theobject.name.c_str(), theobject.num_lods);
+            for (int lod = 0; lod < theobject.num_lods; ++lod)
+                printf("%s%lu", lod > 0 ? ", " : "", (unsigned long)(theobject.lod_num_indices[lod] / 3));
+            printf(" triângulos)\n");
+        }
+
+        if ( g_VirtualScene.find(theobject.name) != g_VirtualScene.end() )
+            fprintf(stderr, "WARNING: Objeto \"%s\" já existe na cena virtual e será substituído.\n", theobject.name.c_str());
+
+        g_VirtualScene[theobject.name] = theobject;
 
     }
 
     GLuint VBO_model_coefficients_id;
     glGenBuffers(1, &VBO_model_coefficients_id);
     glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, model_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, model_coefficients.size() * sizeof(float), model_coefficients.data());
+    glBufferData(GL_ARRAY_BUFFER, model_coefficients.size() * sizeof(float), model_coefficients.data(), GL_STATIC_DRAW);
     GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
-    GLint  number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
+    // Guardamos só (x,y,z): a GPU completa o vec4 de "shader_vertex.glsl"
+    // com w = 1, e o vertex shader zera o w das normais.
+    GLint  number_of_dimensions = 3;
     glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(location);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -107,10 +222,9 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
         GLuint VBO_normal_coefficients_id;
         glGenBuffers(1, &VBO_normal_coefficients_id);
         glBindBuffer(GL_ARRAY_BUFFER, VBO_normal_coefficients_id);
-        glBufferData(GL_ARRAY_BUFFER, normal_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, normal_coefficients.size() * sizeof(float), normal_coefficients.data());
+        glBufferData(GL_ARRAY_BUFFER, normal_coefficients.size() * sizeof(float), normal_coefficients.data(), GL_STATIC_DRAW);
         location = 1; // "(location = 1)" em "shader_vertex.glsl"
-        number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
+        number_of_dimensions = 3; // vec4 em "shader_vertex.glsl", completado com w = 1
         glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
         glEnableVertexAttribArray(location);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -121,8 +235,7 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
         GLuint VBO_texture_coefficients_id;
         glGenBuffers(1, &VBO_texture_coefficients_id);
         glBindBuffer(GL_ARRAY_BUFFER, VBO_texture_coefficients_id);
-        glBufferData(GL_ARRAY_BUFFER, texture_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, texture_coefficients.size() * sizeof(float), texture_coefficients.data());
+        glBufferData(GL_ARRAY_BUFFER, texture_coefficients.size() * sizeof(float), texture_coefficients.data(), GL_STATIC_DRAW);
         location = 2; // "(location = 1)" em "shader_vertex.glsl"
         number_of_dimensions = 2; // vec2 em "shader_vertex.glsl"
         glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
@@ -135,84 +248,26 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
 
     // "Ligamos" o buffer. Note que o tipo agora é GL_ELEMENT_ARRAY_BUFFER.
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); // XXX Errado!
     //
 
     // "Desligamos" o VAO, evitando assim que operações posteriores venham a
     // alterar o mesmo. Isso evita bugs.
     glBindVertexArray(0);
-}
-
-// Função que computa as normais de um ObjModel, caso elas não tenham sido
-// especificadas dentro do arquivo ".obj"
-void ComputeNormals(ObjModel* model)
-{
-    if ( !model->attrib.normals.empty() )
-        return;
-
-    // Primeiro computamos as normais para todos os TRIÂNGULOS.
-    // Segundo, computamos as normais dos VÉRTICES através do método proposto
-    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
-    // todas as faces que compartilham este vértice.
-
-    size_t num_vertices = model->attrib.vertices.size() / 3;
-
-    std::vector<int> num_triangles_per_vertex(num_vertices, 0);
-    std::vector<glm::vec4> vertex_normals(num_vertices, glm::vec4(0.0f,0.0f,0.0f,0.0f));
-
-    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
-    {
-        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
-
-        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
-        {
-            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
-
-            glm::vec4  vertices[3];
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
-                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
-                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
-                vertices[vertex] = glm::vec4(vx,vy,vz,1.0);
-            }
 
-            const glm::vec4  a = vertices[0];
-            const glm::vec4  b = vertices[1];
-            const glm::vec4  c = vertices[2];
-
-            const glm::vec4  n = crossproduct(b-a,c-a);
-
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-                num_triangles_per_vertex[idx.vertex_index] += 1;
-                vertex_normals[idx.vertex_index] += n;
-                model->shapes[shape].mesh.indices[3*triangle + vertex].normal_index = idx.vertex_index;
-            }
-        }
-    }
-
-    model->attrib.normals.resize( 3*num_vertices );
-
-    for (size_t i = 0; i < vertex_normals.size(); ++i)
-    {
-        glm::vec4 n = vertex_normals[i] / (float)num_triangles_per_vertex[i];
-        n /= norm(n);
-        model->attrib.normals[3*i + 0] = n.x;
-        model->attrib.normals[3*i + 1] = n.y;
-        model->attrib.normals[3*i + 2] = n.z;
-    }
+    Trace_AddArg("bytes_uploaded", (double)(sizeof(float) * (model_coefficients.size() + normal_coefficients.size() + texture_coefficients.size())
+                                          + sizeof(GLuint) * indices.size()));
 }
 
+
 // Função que carrega os shaders de vértices e de fragmentos que serão
 // utilizados para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
 //
 void LoadShadersFromFiles()
 {
+    TRACE_SCOPE("LoadShadersFromFiles");
+
     // Note que o caminho para os arquivos "shader_vertex.glsl" e
     // "shader_fragment.glsl" estão fixados, sendo que assumimos a existência
     // da seguinte estrutura no sistema de arquivos:
@@ -231,15 +286,59 @@ void LoadShadersFromFiles()
     //       |
     //       o-- shader_fragment.glsl
     //
-    GLuint vertex_shader_id = LoadShader_Vertex("../../src/shader_vertex.glsl");
-    GLuint fragment_shader_id = LoadShader_Fragment("../../src/shader_fragment.glsl");
+    GLuint program_id = CreateGpuProgramFromFiles();
 
+    // Se algum shader não pôde ser lido ou compilado, mantemos o programa
+    // anterior (se existir), para que um erro de digitação durante a edição
+    // dos shaders não encerre o programa.
+    if ( program_id == 0 )
+    {
+        if ( g_GpuProgramID == 0 )
+        {
+            fprintf(stderr, "ERROR: Cannot build the GPU program from \"%s\" and \"%s\".\n", SHADER_VERTEX_FILENAME, SHADER_FRAGMENT_FILENAME);
+            std::exit(EXIT_FAILURE);
+        }
+        fprintf(stderr, "WARNING: Mantendo o programa de GPU anterior.\n");
+        return;
+    }
+
+    InstallGpuProgram(program_id);
+}
+
+// Lê e compila os shaders de SHADER_VERTEX_FILENAME e SHADER_FRAGMENT_FILENAME.
+// Retorna o programa de GPU, ou 0 em caso de erro (já impresso no terminal).
+// Não altera g_GpuProgramID, podendo ser chamada por outra thread com um
+// contexto OpenGL compartilhado (veja "shaderReload.cpp").
+GLuint CreateGpuProgramFromFiles()
+{
+    std::string vertex_source, fragment_source;
+    if ( !TryReadShaderFile(SHADER_VERTEX_FILENAME, &vertex_source) || !TryReadShaderFile(SHADER_FRAGMENT_FILENAME, &fragment_source) )
+        return 0;
+
+    // Se os arquivos não mudaram desde a última execução, o programa já
+    // linkado é carregado do cache de shaders, sem nova compilação.
+    GLuint program_id = ShaderCache_CreateProgram("main", SHADER_VERTEX_FILENAME, vertex_source, SHADER_FRAGMENT_FILENAME, fragment_source);
+
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    if ( linked_ok == GL_FALSE )
+    {
+        glDeleteProgram(program_id);
+        return 0;
+    }
+
+    return program_id;
+}
+
+// Passa a utilizar "program_id" como programa de GPU da cena, liberando o
+// anterior e buscando as localizações de suas variáveis "uniform".
+void InstallGpuProgram(GLuint program_id)
+{
     // Deletamos o programa de GPU anterior, caso ele exista.
     if ( g_GpuProgramID != 0 )
         glDeleteProgram(g_GpuProgramID);
 
-    // Criamos um programa de GPU utilizando os shaders carregados acima.
-    g_GpuProgramID = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+    g_GpuProgramID = program_id;
 
     // Buscamos o endereço das variáveis definidas dentro do Vertex Shader.
     // Utilizaremos estas variáveis para enviar dados para a placa de vídeo
@@ -250,6 +349,11 @@ void LoadShadersFromFiles()
     g_object_id_uniform  = glGetUniformLocation(g_GpuProgramID, "object_id"); // Variável "object_id" em shader_fragment.glsl
     g_bbox_min_uniform   = glGetUniformLocation(g_GpuProgramID, "bbox_min");
     g_bbox_max_uniform   = glGetUniformLocation(g_GpuProgramID, "bbox_max");
+    g_texture_layer_uniform = glGetUniformLocation(g_GpuProgramID, "texture_layer"); // Camada das texturas GL_TEXTURE_2D_ARRAY
+    g_lamp_uniform[CIRCUIT_WIRE_LAMP] = glGetUniformLocation(g_GpuProgramID, "u_wireLampOn"); // Estado das lâmpadas em shader_fragment.glsl
+    g_lamp_uniform[CIRCUIT_NOT_LAMP]  = glGetUniformLocation(g_GpuProgramID, "u_notLampOn");
+    g_lamp_uniform[CIRCUIT_AND_LAMP]  = glGetUniformLocation(g_GpuProgramID, "u_andLampOn");
+    g_lamp_uniform[CIRCUIT_OR_LAMP]   = glGetUniformLocation(g_GpuProgramID, "u_orLampOn");
 
     // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
     glUseProgram(g_GpuProgramID);
@@ -259,31 +363,51 @@ void LoadShadersFromFiles()
     glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureTable"), 3);
     glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureWire"), 4);
     glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureDisplay"), 5);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureDigit0"), 6);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureDigit1"), 7);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TexturePlaneWire"), 8);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TexturePlaneNot"), 9);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureBlocks"), 10);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureSphere"), 11);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TexturePlaneAnd"), 12);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureFloor"), 13);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TexturePlaneOr"), 14);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureSky"), 15);
-    
-    // Variáveis em "shader_fragment.glsl" para controle de texturas dos dígitos
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "u_andIsInput1Digit0"), andIsInput1Digit0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "u_andIsInput2Digit0"), andIsInput2Digit0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "u_orIsInput1Digit0"), orIsInput1Digit0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "u_orIsInput2Digit0"), orIsInput2Digit0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "u_notIsInputDigit0"), notIsInputDigit0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "u_wireIsInputDigit0"), wireIsInputDigit0);
-    
+    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureDigits"), 6); // GL_TEXTURE_2D_ARRAY
+    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureBoards"), 7); // GL_TEXTURE_2D_ARRAY
+    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureBlocks"), 8);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureSphere"), 9);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureFloor"), 10);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureSky"), 11);
     glUseProgram(0);
+
+    // O programa novo começa com todas as lâmpadas apagadas.
+    CircuitView_MarkAllChanged(&g_CircuitView);
+    UpdateCircuitUniforms();
+}
+
+// Envia as lâmpadas dos circuitos que mudaram desde o último envio (veja
+// "circuitView.h") para "shader_fragment.glsl". Chamada quando a simulação
+// muda alguma lâmpada ou display, no lugar de recarregar os shaders. Os
+// dígitos dos displays não têm uniform próprio: a camada da textura é
+// escolhida a cada desenho a partir de g_CircuitView (veja main()).
+// Chamada no meio do quadro, então restaura o programa que estava em uso.
+void UpdateCircuitUniforms()
+{
+    GLint previous_program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+    glUseProgram(g_GpuProgramID);
+    for (size_t i = 0; i < g_CircuitView.changed.size(); ++i)
+    {
+        const CircuitViewAttribute& attribute = g_CircuitView.attributes[g_CircuitView.changed[i]];
+        if ( attribute.kind == CIRCUITVIEW_LAMP )
+            glUniform1i(g_lamp_uniform[attribute.index], attribute.value);
+    }
+    glUseProgram(previous_program);
+    CircuitView_ClearChanged(&g_CircuitView);
 }
 
 // Função que carrega uma imagem para ser utilizada como textura
 void LoadTextureImage(const char* filename)
 {
+    // Nas imagens de referência, texturas fora do repositório são trocadas
+    // por substitutas (veja "golden.h").
+    filename = Golden_TexturePath(filename);
+
+    TRACE_SCOPE("LoadTextureImage");
+    Trace_AddArg("file", filename);
+    Trace_AddFileRead(filename);
+
     printf("Carregando imagem \"%s\"... ", filename);
 
     // Primeiro fazemos a leitura da imagem do disco
@@ -325,6 +449,7 @@ void LoadTextureImage(const char* filename)
     glActiveTexture(GL_TEXTURE0 + textureunit);
     glBindTexture(GL_TEXTURE_2D, texture_id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    Trace_AddArg("bytes_uploaded", 3.0 * width * height);
     glGenerateMipmap(GL_TEXTURE_2D);
     glBindSampler(textureunit, sampler_id);
 
@@ -333,19 +458,181 @@ void LoadTextureImage(const char* filename)
     g_NumLoadedTextures += 1;
 }
 
+// Reamostra (bilinear) uma imagem RGB de 8 bits para o tamanho dst_width x
+// dst_height. Utilizada por LoadTextureArray(), pois todas as camadas de uma
+// GL_TEXTURE_2D_ARRAY precisam ter as mesmas dimensões.
+static std::vector<unsigned char> ResizeImageRGB(const unsigned char* src, int src_width, int src_height, int dst_width, int dst_height)
+{
+    std::vector<unsigned char> dst(3 * dst_width * dst_height);
+
+    const float scale_x = (float)src_width / dst_width;
+    const float scale_y = (float)src_height / dst_height;
+
+    for (int y = 0; y < dst_height; ++y)
+    {
+        float sy = std::max(0.0f, (y + 0.5f) * scale_y - 0.5f);
+        int y0 = std::min((int)sy, src_height - 1);
+        int y1 = std::min(y0 + 1, src_height - 1);
+        float fy = sy - y0;
+
+        for (int x = 0; x < dst_width; ++x)
+        {
+            float sx = std::max(0.0f, (x + 0.5f) * scale_x - 0.5f);
+            int x0 = std::min((int)sx, src_width - 1);
+            int x1 = std::min(x0 + 1, src_width - 1);
+            float fx = sx - x0;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                float top    = src[3*(y0*src_width + x0) + c] * (1.0f - fx) + src[3*(y0*src_width + x1) + c] * fx;
+                float bottom = src[3*(y1*src_width + x0) + c] * (1.0f - fx) + src[3*(y1*src_width + x1) + c] * fx;
+                dst[3*(y*dst_width + x) + c] = (unsigned char)(top * (1.0f - fy) + bottom * fy + 0.5f);
+            }
+        }
+    }
+
+    return dst;
+}
+
+// Função que carrega várias imagens em uma única textura GL_TEXTURE_2D_ARRAY,
+// onde a imagem filenames[i] é armazenada na camada (layer) i. Assim, objetos
+// que diferem apenas pela imagem (dígitos dos displays, placas dos circuitos)
+// compartilham uma única unidade de textura, e a imagem é escolhida no shader
+// pelo uniform "texture_layer", sem trocar a textura ligada entre desenhos.
+// As dimensões da textura são as da primeira imagem; as demais imagens são
+// reamostradas caso tenham tamanho diferente.
+void LoadTextureArray(const char** filenames, int count)
+{
+    TRACE_SCOPE("LoadTextureArray");
+    Trace_AddArg("file", filenames[0]);
+    Trace_AddArg("layers", (double)count);
+
+    stbi_set_flip_vertically_on_load(true);
+
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> layers;
+
+    for (int layer = 0; layer < count; ++layer)
+    {
+        printf("Carregando imagem \"%s\" (camada %d)... ", filenames[layer], layer);
+
+        int layer_width;
+        int layer_height;
+        int channels;
+        unsigned char *data = stbi_load(filenames[layer], &layer_width, &layer_height, &channels, 3);
+        Trace_AddFileRead(filenames[layer]);
+
+        if ( data == NULL )
+        {
+            fprintf(stderr, "ERROR: Cannot open image file \"%s\".\n", filenames[layer]);
+            std::exit(EXIT_FAILURE);
+        }
+
+        if ( layer == 0 )
+        {
+            width = layer_width;
+            height = layer_height;
+            layers.resize((size_t)3 * width * height * count);
+        }
+
+        unsigned char* dst = &layers[(size_t)3 * width * height * layer];
+
+        if ( layer_width == width && layer_height == height )
+        {
+            std::copy(data, data + 3 * width * height, dst);
+            printf("OK (%dx%d).\n", layer_width, layer_height);
+        }
+        else
+        {
+            std::vector<unsigned char> resized = ResizeImageRGB(data, layer_width, layer_height, width, height);
+            std::copy(resized.begin(), resized.end(), dst);
+            printf("OK (%dx%d, reamostrada para %dx%d).\n", layer_width, layer_height, width, height);
+        }
+
+        stbi_image_free(data);
+    }
+
+    GLuint texture_id;
+    GLuint sampler_id;
+    glGenTextures(1, &texture_id);
+    glGenSamplers(1, &sampler_id);
+
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+    // Todas as camadas são enviadas para a GPU em uma única chamada
+    GLuint textureunit = g_NumLoadedTextures;
+    glActiveTexture(GL_TEXTURE0 + textureunit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_id);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_SRGB8, width, height, count, 0, GL_RGB, GL_UNSIGNED_BYTE, layers.data());
+    Trace_AddArg("bytes_uploaded", (double)layers.size());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glBindSampler(textureunit, sampler_id);
+
+    g_NumLoadedTextures += 1;
+}
+
 // Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
 // dos objetos na função BuildTrianglesAndAddToVirtualScene().
 void DrawVirtualObject(const char* object_name)
+{
+    DrawVirtualObjectLOD(object_name, 0);
+}
+
+// Limiares, em pixels, do raio projetado na tela abaixo dos quais passamos
+// para o nível de detalhe seguinte. A histerese evita que um objeto próximo
+// de um limiar alterne de nível a cada quadro.
+static const float LOD_SCREEN_RADIUS[MAX_LODS - 1] = { 150.0f, 60.0f, 25.0f };
+static const float LOD_HYSTERESIS = 0.15f;
+
+int SelectLOD(const char* object_name, const glm::mat4& model, int current_lod)
+{
+    const SceneObject& object = Assets_GetObject(object_name);
+    if ( object.num_lods <= 1 )
+        return 0;
+
+    // Esfera envolvente da AABB do objeto, transformada pela matriz "model".
+    glm::vec4 center = model * glm::vec4(0.5f * (object.bbox_min + object.bbox_max), 1.0f);
+    float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    float radius = 0.5f * glm::length(object.bbox_max - object.bbox_min) * scale;
+
+    // Raio projetado em pixels (altura da janela), considerando a projeção
+    // perspectiva: r * P[1][1] / w (na ortográfica, w = 1).
+    glm::vec4 clip = g_ProjectionMatrix * g_ViewMatrix * center;
+    float w = std::max(std::fabs(clip.w), 1e-4f);
+    float pixels = radius * std::fabs(g_ProjectionMatrix[1][1]) / w * 0.5f * g_ScreenHeight;
+
+    int lod = std::min(std::max(current_lod, 0), object.num_lods - 1);
+    while ( lod + 1 < object.num_lods && pixels < LOD_SCREEN_RADIUS[lod] * (1.0f - LOD_HYSTERESIS) )
+        lod += 1;
+    while ( lod > 0 && pixels > LOD_SCREEN_RADIUS[lod - 1] * (1.0f + LOD_HYSTERESIS) )
+        lod -= 1;
+
+    return lod;
+}
+
+// Desenha um nível de detalhe específico de um objeto. O nível 0 é a malha original.
+void DrawVirtualObjectLOD(const char* object_name, int lod)
 {
     // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
     // vértices apontados pelo VAO criado pela função BuildTrianglesAndAddToVirtualScene(). Veja
     // comentários detalhados dentro da definição de BuildTrianglesAndAddToVirtualScene().
-    glBindVertexArray(g_VirtualScene[object_name].vertex_array_object_id);
+    const SceneObject& object = Assets_GetObject(object_name);
+    lod = std::min(std::max(lod, 0), object.num_lods - 1);
+    glBindVertexArray(object.vertex_array_object_id);
 
     // Setamos as variáveis "bbox_min" e "bbox_max" do fragment shader
     // com os parâmetros da axis-aligned bounding box (AABB) do modelo.
-    glm::vec3 bbox_min = g_VirtualScene[object_name].bbox_min;
-    glm::vec3 bbox_max = g_VirtualScene[object_name].bbox_max;
+    glm::vec3 bbox_min = object.bbox_min;
+    glm::vec3 bbox_max = object.bbox_max;
     glUniform4f(g_bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
     glUniform4f(g_bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
 
@@ -355,10 +642,10 @@ void DrawVirtualObject(const char* object_name)
     // a documentação da função glDrawElements() em
     // http://docs.gl/gl3/glDrawElements.
     glDrawElements(
-        g_VirtualScene[object_name].rendering_mode,
-        g_VirtualScene[object_name].num_indices,
+        object.rendering_mode,
+        object.lod_num_indices[lod],
         GL_UNSIGNED_INT,
-        (void*)(g_VirtualScene[object_name].first_index * sizeof(GLuint))
+        (void*)(object.lod_first_index[lod] * sizeof(GLuint))
     );
 
     // "Desligamos" o VAO, evitando assim que operações posteriores venham a
@@ -398,20 +685,40 @@ GLuint LoadShader_Fragment(const char* filename)
 // um arquivo GLSL e faz sua compilação.
 void LoadShader(const char* filename, GLuint shader_id)
 {
-    // Lemos o arquivo de texto indicado pela variável "filename"
-    // e colocamos seu conteúdo em memória, apontado pela variável
-    // "shader_string".
+    CompileShaderSource(ReadShaderFile(filename), filename, shader_id);
+}
+
+// Lê o arquivo de texto indicado pela variável "filename" e retorna seu conteúdo.
+std::string ReadShaderFile(const char* filename)
+{
+    std::string source;
+    if ( !TryReadShaderFile(filename, &source) )
+        std::exit(EXIT_FAILURE);
+    return source;
+}
+
+// Como ReadShaderFile(), mas retorna false (após imprimir o erro) em vez de
+// encerrar o programa se o arquivo não puder ser aberto.
+bool TryReadShaderFile(const char* filename, std::string* source)
+{
     std::ifstream file;
     try {
         file.exceptions(std::ifstream::failbit);
         file.open(filename);
     } catch ( std::exception& e ) {
         fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
-        std::exit(EXIT_FAILURE);
+        return false;
     }
     std::stringstream shader;
     shader << file.rdbuf();
-    std::string str = shader.str();
+    *source = shader.str();
+    return true;
+}
+
+// Compila o código GLSL "str" no shader "shader_id". O nome "filename" é
+// utilizado somente nas mensagens de erro.
+void CompileShaderSource(const std::string& str, const char* filename, GLuint shader_id)
+{
     const GLchar* shader_string = str.c_str();
     const GLint   shader_string_length = static_cast<GLint>( str.length() );
 
@@ -475,7 +782,9 @@ GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
     glAttachShader(program_id, vertex_shader_id);
     glAttachShader(program_id, fragment_shader_id);
 
-    // Linkagem dos shaders acima ao programa
+    // Linkagem dos shaders acima ao programa, pedindo ao driver que mantenha o
+    // binário resultante disponível para o cache de shaders.
+    ShaderCache_MarkRetrievable(program_id);
     glLinkProgram(program_id);
 
     // Verificamos se ocorreu algum erro durante a linkagem
@@ -684,10 +993,22 @@ void PrintObjModelInfo(ObjModel* model)
   }
 }
 
-void buildModel(const char* filename) {
-    ObjModel planemodel(filename);
-    ComputeNormals(&planemodel);
-    BuildTrianglesAndAddToVirtualScene(&planemodel);
+void buildModel(const char* filename, const char* data, size_t size) {
+    TRACE_SCOPE("buildModel");
+    Trace_AddArg("file", filename);
+
+    double start = getTime();
+
+    // O ObjModel só existe durante a construção: após o envio para a GPU,
+    // a CPU guarda apenas o SceneObject (bounding box, usada nas colisões).
+    {
+        ObjModel planemodel(filename, NULL, true, false, data, size);
+        ComputeNormals(&planemodel);
+        BuildTrianglesAndAddToVirtualScene(&planemodel);
+    }
+
+    printf("Modelo \"%s\" carregado em %.1f ms (pico de memória do processo: %.1f MB).\n",
+           filename, 1000.0 * (getTime() - start), GetPeakResidentMemory() / (1024.0 * 1024.0));
 }
 
 void reLoadShaders() {
@@ -0,0 +1,234 @@
+#include "parallelsim.h"
+
+#include <cstdio>
+#include <chrono>
+
+static void EvaluateRange(ParallelSim* sim, uint32_t begin, uint32_t end)
+{
+    const Netlist* netlist = sim->netlist;
+    const uint32_t* order = sim->order.data();
+    const uint32_t* gate_output = netlist->gate_output.data();
+    uint8_t* value = sim->netlist->net_value.data();
+
+    for (uint32_t i = begin; i < end; ++i)
+        value[gate_output[order[i]]] = Netlist_EvaluateGate(netlist, order[i]);
+}
+
+// Retira um pedaço da própria fila ou, se ela está vazia, do fim da fila de
+// outra thread, e o avalia. Retorna false se não havia trabalho.
+static bool WorkOnce(ParallelSim* sim, int self)
+{
+    uint32_t chunk = 0;
+    bool found = false;
+    for (int k = 0; k < sim->num_threads && !found; ++k)
+    {
+        ParallelSimQueue& queue = sim->queues[(self + k) % sim->num_threads];
+        if ( queue.size.load(std::memory_order_relaxed) == 0 )
+            continue;
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if ( queue.chunks.empty() )
+            continue;
+        if ( k == 0 )
+        {
+            chunk = queue.chunks.front();
+            queue.chunks.pop_front();
+        }
+        else
+        {
+            chunk = queue.chunks.back();
+            queue.chunks.pop_back();
+            sim->steals.fetch_add(1, std::memory_order_relaxed);
+        }
+        queue.size.store((int)queue.chunks.size(), std::memory_order_relaxed);
+        found = true;
+    }
+    if ( !found )
+        return false;
+
+    uint32_t level_end = sim->level_end.load(std::memory_order_relaxed);
+    EvaluateRange(sim, chunk, chunk + PARALLELSIM_CHUNK < level_end ? chunk + PARALLELSIM_CHUNK : level_end);
+
+    // "release": quem vê o contador zerado também vê os valores escritos.
+    sim->remaining.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+static void WorkerThread(ParallelSim* sim, int self)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(sim->mutex);
+            sim->wake.wait(lock, [sim] { return sim->running.load() || sim->quit; });
+            if ( sim->quit )
+                return;
+        }
+        while ( sim->running.load(std::memory_order_acquire) )
+            if ( !WorkOnce(sim, self) )
+                std::this_thread::yield();
+    }
+}
+
+bool ParallelSim_Init(ParallelSim* sim, Netlist* netlist, int num_threads)
+{
+    if ( !Netlist_Levelize(netlist, &sim->order, &sim->level_begin) )
+        return false;
+
+    if ( num_threads <= 0 )
+        num_threads = (int)std::thread::hardware_concurrency();
+    if ( num_threads <= 0 )
+        num_threads = 1;
+
+    sim->netlist = netlist;
+    sim->num_threads = num_threads;
+    sim->level_end = 0;
+    sim->remaining = 0;
+    sim->running = false;
+    sim->quit = false;
+    sim->steals = 0;
+    sim->runs = 0;
+    sim->seconds = 0.0;
+
+    sim->queues.clear();
+    for (int t = 0; t < num_threads; ++t)
+    {
+        sim->queues.emplace_back();
+        sim->queues.back().size = 0;
+    }
+    sim->threads.clear();
+    for (int t = 1; t < num_threads; ++t)
+        sim->threads.push_back(std::thread(WorkerThread, sim, t));
+    return true;
+}
+
+void ParallelSim_Shutdown(ParallelSim* sim)
+{
+    {
+        std::lock_guard<std::mutex> lock(sim->mutex);
+        sim->quit = true;
+    }
+    sim->wake.notify_all();
+    for (size_t t = 0; t < sim->threads.size(); ++t)
+        sim->threads[t].join();
+    sim->threads.clear();
+}
+
+void ParallelSim_Run(ParallelSim* sim)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    bool parallel = sim->num_threads > 1;
+    if ( parallel )
+    {
+        {
+            std::lock_guard<std::mutex> lock(sim->mutex);
+            sim->running = true;
+        }
+        sim->wake.notify_all();
+    }
+
+    size_t num_levels = sim->level_begin.size() - 1;
+    for (size_t l = 0; l < num_levels; ++l)
+    {
+        uint32_t begin = sim->level_begin[l];
+        uint32_t end = sim->level_begin[l + 1];
+        if ( !parallel || end - begin < 2 * PARALLELSIM_CHUNK )
+        {
+            EvaluateRange(sim, begin, end);
+            continue;
+        }
+
+        // Os pedaços são distribuídos em rodízio; o mutex de cada fila
+        // também publica os valores dos níveis anteriores para quem os retirar.
+        uint32_t num_chunks = (end - begin + PARALLELSIM_CHUNK - 1) / PARALLELSIM_CHUNK;
+        sim->level_end.store(end, std::memory_order_relaxed);
+        sim->remaining.store((int)num_chunks, std::memory_order_relaxed);
+        for (int t = 0; t < sim->num_threads; ++t)
+        {
+            ParallelSimQueue& queue = sim->queues[t];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            for (uint32_t c = t; c < num_chunks; c += sim->num_threads)
+                queue.chunks.push_back(begin + c * PARALLELSIM_CHUNK);
+            queue.size.store((int)queue.chunks.size(), std::memory_order_relaxed);
+        }
+
+        // Barreira: esta thread também trabalha até o nível terminar.
+        while ( sim->remaining.load(std::memory_order_acquire) > 0 )
+            if ( !WorkOnce(sim, 0) )
+                std::this_thread::yield();
+    }
+
+    if ( parallel )
+        sim->running.store(false, std::memory_order_release);
+
+    sim->runs += 1;
+    sim->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Gerador pseudoaleatório (xorshift) das entradas.
+static uint32_t NextRandom(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+void ParallelSim_Benchmark(const Netlist* netlist, int max_threads)
+{
+    if ( max_threads <= 0 )
+        max_threads = (int)std::thread::hardware_concurrency();
+    if ( max_threads <= 0 )
+        max_threads = 1;
+
+    printf("  paralelo (%d núcleos disponíveis, pedaços de %d portas):\n",
+           (int)std::thread::hardware_concurrency(), PARALLELSIM_CHUNK);
+    printf("  %7s  %12s  %7s  %8s\n", "threads", "tempo (ms)", "ganho", "roubos");
+
+    double single_ms = 0.0;
+    for (int threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+    {
+        Netlist copy = *netlist;
+        ParallelSim sim;
+        if ( !ParallelSim_Init(&sim, &copy, threads) )
+            return;
+
+        // Apaga as nets internas para que a conferência dependa da execução.
+        for (uint32_t n = 0; n < Netlist_NumNets(&copy); ++n)
+            if ( copy.net_driver[n] != NETLIST_NONE )
+                copy.net_value[n] = 0;
+        ParallelSim_Run(&sim);
+        for (uint32_t n = 0; n < Netlist_NumNets(&copy); ++n)
+        {
+            if ( copy.net_value[n] != netlist->net_value[n] )
+            {
+                fprintf(stderr, "ERROR: Parallel simulation with %d threads disagrees with the event-driven simulation on net \"%s\".\n",
+                        threads, Netlist_NetName(netlist, n));
+                ParallelSim_Shutdown(&sim);
+                return;
+            }
+        }
+
+        uint32_t seed = 777;
+        sim.runs = 0;
+        sim.seconds = 0.0;
+        sim.steals = 0;
+        while ( sim.runs < 3 || sim.seconds < 0.3 )
+        {
+            for (size_t i = 0; i < copy.inputs.size(); ++i)
+                Netlist_SetInput(&copy, (int)i, NextRandom(&seed) & 1);
+            ParallelSim_Run(&sim);
+        }
+        ParallelSim_Shutdown(&sim);
+
+        double ms = 1000.0 * sim.seconds / sim.runs;
+        if ( threads == 1 )
+            single_ms = ms;
+        printf("  %7d  %12.3f  %6.2fx  %8.1f\n", threads, ms, single_ms / ms, (double)sim.steals / sim.runs);
+
+        if ( threads == max_threads )
+            break;
+    }
+}
@@ -0,0 +1,338 @@
+#include "profiler.h"
+
+#include <glad/glad.h>
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+
+struct ProfileEvent
+{
+    const char* name;
+    uint64_t    start_ns;
+    uint64_t    end_ns;
+};
+
+// Buffer circular de uma thread. Só a thread dona escreve; "head" conta todos
+// os eventos já escritos, e o evento i fica na posição i % PROFILER_BUFFER_EVENTS.
+struct ProfileBuffer
+{
+    int                   tid;
+    const char*           thread_name;
+    std::atomic<uint64_t> head;
+    ProfileEvent          events[PROFILER_BUFFER_EVENTS];
+};
+
+// A lista só é alterada quando uma thread cria seu buffer. Os buffers nunca são
+// liberados, para que os eventos de threads que já terminaram continuem
+// disponíveis.
+static std::mutex                  g_ProfileMutex;
+static std::vector<ProfileBuffer*> g_ProfileBuffers;
+
+static thread_local ProfileBuffer* t_ProfileBuffer = NULL;
+
+static inline uint64_t NowNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static ProfileBuffer* NewBuffer(const char* thread_name)
+{
+    ProfileBuffer* buffer = new ProfileBuffer;
+    buffer->thread_name = thread_name;
+    buffer->head = 0;
+
+    std::lock_guard<std::mutex> lock(g_ProfileMutex);
+    buffer->tid = (int)g_ProfileBuffers.size();
+    g_ProfileBuffers.push_back(buffer);
+    return buffer;
+}
+
+static ProfileBuffer* ThreadBuffer()
+{
+    if ( t_ProfileBuffer == NULL )
+        t_ProfileBuffer = NewBuffer(NULL);
+    return t_ProfileBuffer;
+}
+
+// Só pode ser chamada pela única thread que escreve em "buffer".
+static void WriteEvent(ProfileBuffer* buffer, const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+    uint64_t index = buffer->head.load(std::memory_order_relaxed);
+
+    ProfileEvent& event = buffer->events[index & (PROFILER_BUFFER_EVENTS - 1)];
+    event.name = name;
+    event.start_ns = start_ns;
+    event.end_ns = end_ns;
+
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+ProfileZone::ProfileZone(const char* name)
+    : name(name)
+    , start_ns(NowNanoseconds())
+{
+}
+
+void ProfileZone::End()
+{
+    WriteEvent(ThreadBuffer(), name, start_ns, NowNanoseconds());
+    name = NULL;
+}
+
+void Profiler_SetThreadName(const char* name)
+{
+    ThreadBuffer()->thread_name = name;
+}
+
+// Copia os eventos de "buffer" que terminaram depois de "since_ns". Pode ser
+// chamada por qualquer thread enquanto a dona continua escrevendo: eventos
+// sobrescritos durante a cópia são descartados.
+static void CopyEvents(const ProfileBuffer* buffer, uint64_t since_ns, std::vector<ProfileEvent>* events)
+{
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t first = head > PROFILER_BUFFER_EVENTS ? head - PROFILER_BUFFER_EVENTS : 0;
+
+    // Os eventos estão em ordem de término; procuramos o primeiro que interessa.
+    uint64_t lo = first, hi = head;
+    while ( lo < hi )
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if ( buffer->events[mid & (PROFILER_BUFFER_EVENTS - 1)].end_ns < since_ns )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    size_t offset = events->size();
+    for (uint64_t i = lo; i < head; ++i)
+        events->push_back(buffer->events[i & (PROFILER_BUFFER_EVENTS - 1)]);
+
+    uint64_t new_head = buffer->head.load(std::memory_order_acquire);
+    if ( new_head > lo + PROFILER_BUFFER_EVENTS )
+    {
+        uint64_t overwritten = std::min(new_head - PROFILER_BUFFER_EVENTS - lo, head - lo);
+        events->erase(events->begin() + offset, events->begin() + offset + overwritten);
+    }
+}
+
+// Compara nomes de zonas pelo conteúdo: a mesma string literal pode ter
+// endereços diferentes em arquivos diferentes.
+struct ZoneNameLess
+{
+    bool operator()(const char* a, const char* b) const { return strcmp(a, b) < 0; }
+};
+
+struct ZoneDurations
+{
+    uint64_t            first_start_ns;
+    std::vector<double> ms;
+};
+
+static int ZoneStats(const ProfileBuffer* buffer, ProfileZoneStats* stats, int max_zones, double seconds)
+{
+    std::vector<ProfileEvent> events;
+    CopyEvents(buffer, NowNanoseconds() - (uint64_t)(seconds * 1e9), &events);
+
+    std::map<const char*, ZoneDurations, ZoneNameLess> zones;
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        ZoneDurations& zone = zones[events[i].name];
+        if ( zone.ms.empty() || events[i].start_ns < zone.first_start_ns )
+            zone.first_start_ns = events[i].start_ns;
+        zone.ms.push_back((events[i].end_ns - events[i].start_ns) / 1e6);
+    }
+
+    // Zonas externas (ex: o quadro inteiro) começam antes das internas.
+    std::vector<std::pair<uint64_t, const char*> > order;
+    for (std::map<const char*, ZoneDurations, ZoneNameLess>::const_iterator it = zones.begin(); it != zones.end(); ++it)
+        order.push_back(std::make_pair(it->second.first_start_ns, it->first));
+    std::sort(order.begin(), order.end());
+
+    int num_zones = 0;
+    for (size_t i = 0; i < order.size() && num_zones < max_zones; ++i)
+    {
+        std::vector<double>& d = zones[order[i].second].ms;
+        std::sort(d.begin(), d.end());
+
+        double sum = 0.0;
+        for (size_t j = 0; j < d.size(); ++j)
+            sum += d[j];
+
+        ProfileZoneStats& s = stats[num_zones++];
+        s.name    = order[i].second;
+        s.count   = (int)d.size();
+        s.mean_ms = sum / d.size();
+        s.p99_ms  = d[std::min(d.size() - 1, (size_t)(0.99 * d.size()))];
+        s.max_ms  = d.back();
+    }
+    return num_zones;
+}
+
+int Profiler_GetZoneStats(ProfileZoneStats* stats, int max_zones, double seconds)
+{
+    return ZoneStats(ThreadBuffer(), stats, max_zones, seconds);
+}
+
+bool Profiler_Dump(const char* filename, double seconds)
+{
+    std::vector<ProfileBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_ProfileMutex);
+        buffers = g_ProfileBuffers;
+    }
+
+    uint64_t now_ns = NowNanoseconds();
+    uint64_t since_ns = now_ns - (uint64_t)(seconds * 1e9);
+
+    FILE* file = fopen(filename, "w");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "WARNING: Não foi possível escrever o trace \"%s\".\n", filename);
+        return false;
+    }
+
+    // Nomes de zonas e threads são strings literais do programa, sem
+    // caracteres que precisem de escape em JSON.
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    size_t num_events = 0;
+    for (size_t b = 0; b < buffers.size(); ++b)
+    {
+        std::vector<ProfileEvent> events;
+        CopyEvents(buffers[b], since_ns, &events);
+
+        const char* thread_name = buffers[b]->thread_name ? buffers[b]->thread_name : "thread";
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                b == 0 ? "" : ",\n", buffers[b]->tid, thread_name);
+
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            // Tempos relativos ao início da janela gravada, em microssegundos.
+            double ts = events[i].start_ns > since_ns ? (events[i].start_ns - since_ns) / 1e3 : -((since_ns - events[i].start_ns) / 1e3);
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    events[i].name, buffers[b]->tid, ts, (events[i].end_ns - events[i].start_ns) / 1e3);
+        }
+        num_events += events.size();
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Trace dos últimos %.0f segundos escrito em \"%s\" (%lu eventos).\n", seconds, filename, (unsigned long)num_events);
+    fflush(stdout);
+    return true;
+}
+
+// Consultas de um quadro: zona i começa em queries[2*i] e termina em queries[2*i+1].
+struct GpuProfileFrame
+{
+    GLuint      queries[2 * GPU_PROFILER_MAX_ZONES];
+    const char* names[GPU_PROFILER_MAX_ZONES];
+    int         num_zones;
+    GLuint      last_query; // Última consulta enviada; zonas aninhadas terminam fora de ordem
+};
+
+static bool            g_GpuProfilerEnabled = false;
+static GpuProfileFrame g_GpuFrames[GPU_PROFILER_FRAMES];
+static int             g_GpuFrameIndex = 0;
+static int64_t         g_GpuClockOffset = 0;  // Relógio da CPU menos relógio da GPU, em ns
+static ProfileBuffer*  g_GpuBuffer = NULL;    // Escrito apenas pela thread do contexto OpenGL
+static unsigned long   g_GpuFramesDropped = 0;
+
+void Profiler_GpuInit()
+{
+    // Consultas GL_TIMESTAMP fazem parte do OpenGL 3.3, mas alguns drivers
+    // informam zero bits de precisão quando não as implementam.
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    if ( bits == 0 )
+    {
+        fprintf(stderr, "WARNING: Driver sem suporte a GL_TIMESTAMP; profiler de GPU desabilitado.\n");
+        return;
+    }
+
+    for (int i = 0; i < GPU_PROFILER_FRAMES; ++i)
+    {
+        glGenQueries(2 * GPU_PROFILER_MAX_ZONES, g_GpuFrames[i].queries);
+        g_GpuFrames[i].num_zones = 0;
+    }
+
+    g_GpuBuffer = NewBuffer("GPU");
+    g_GpuProfilerEnabled = true;
+}
+
+void Profiler_GpuFrameBegin()
+{
+    if ( !g_GpuProfilerEnabled )
+        return;
+
+    // Sincronizamos os relógios a cada quadro; glGetInteger64v(GL_TIMESTAMP)
+    // não espera os comandos pendentes.
+    GLint64 gpu_now = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+    g_GpuClockOffset = (int64_t)NowNanoseconds() - (int64_t)gpu_now;
+
+    // Reutilizamos as consultas de GPU_PROFILER_FRAMES quadros atrás.
+    g_GpuFrameIndex = (g_GpuFrameIndex + 1) % GPU_PROFILER_FRAMES;
+    GpuProfileFrame& frame = g_GpuFrames[g_GpuFrameIndex];
+
+    if ( frame.num_zones > 0 )
+    {
+        // A GPU executa as consultas em ordem; se a última está pronta, todas estão.
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.last_query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if ( available )
+        {
+            for (int i = 0; i < frame.num_zones; ++i)
+            {
+                GLuint64 start = 0, end = 0;
+                glGetQueryObjectui64v(frame.queries[2*i + 0], GL_QUERY_RESULT, &start);
+                glGetQueryObjectui64v(frame.queries[2*i + 1], GL_QUERY_RESULT, &end);
+                WriteEvent(g_GpuBuffer, frame.names[i], start + g_GpuClockOffset, end + g_GpuClockOffset);
+            }
+        }
+        else if ( g_GpuFramesDropped++ == 0 )
+        {
+            // A GPU está mais de GPU_PROFILER_FRAMES quadros atrás da CPU:
+            // descartamos o quadro em vez de esperar.
+            fprintf(stderr, "WARNING: Medições de GPU descartadas; a GPU está %d quadros atrás da CPU.\n", GPU_PROFILER_FRAMES);
+        }
+    }
+
+    frame.num_zones = 0;
+}
+
+GpuProfileZone::GpuProfileZone(const char* name)
+{
+    index = -1;
+    if ( !g_GpuProfilerEnabled )
+        return;
+
+    GpuProfileFrame& frame = g_GpuFrames[g_GpuFrameIndex];
+    if ( frame.num_zones == GPU_PROFILER_MAX_ZONES )
+        return;
+
+    index = frame.num_zones++;
+    frame.names[index] = name;
+    glQueryCounter(frame.queries[2*index + 0], GL_TIMESTAMP);
+}
+
+void GpuProfileZone::End()
+{
+    GpuProfileFrame& frame = g_GpuFrames[g_GpuFrameIndex];
+    frame.last_query = frame.queries[2*index + 1];
+    glQueryCounter(frame.last_query, GL_TIMESTAMP);
+    index = -1;
+}
+
+int Profiler_GetGpuZoneStats(ProfileZoneStats* stats, int max_zones, double seconds)
+{
+    if ( g_GpuBuffer == NULL )
+        return 0;
+    return ZoneStats(g_GpuBuffer, stats, max_zones, seconds);
+}
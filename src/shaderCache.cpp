@@ -0,0 +1,209 @@
+#include "shaderCache.h"
+#include "objects.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// As funções de binário de programa não fazem parte do OpenGL 3.3 carregado
+// pela GLAD, então buscamos seus endereços em ShaderCache_Init().
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS      0x87FE
+
+typedef void (APIENTRYP PFN_GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFN_ProgramBinary)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFN_ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+
+static PFN_GetProgramBinary  g_GetProgramBinary  = NULL;
+static PFN_ProgramBinary     g_ProgramBinary     = NULL;
+static PFN_ProgramParameteri g_ProgramParameteri = NULL;
+static bool                  g_ShaderCacheEnabled = false;
+static std::string           g_DriverString; // Fabricante, renderizador e versão do driver
+
+#define SHADER_CACHE_DIR     "shader_cache"
+#define SHADER_CACHE_MAGIC   0x53474346u // "FCGS"
+#define SHADER_CACHE_VERSION 1u
+
+// Cabeçalho dos arquivos do cache, seguido de "length" bytes do binário.
+struct ShaderCacheHeader
+{
+    unsigned int       magic;
+    unsigned int       version;
+    unsigned long long hash;
+    unsigned int       format;
+    unsigned int       length;
+};
+
+static unsigned long long HashBytes(unsigned long long h, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void ShaderCache_Init(GLADloadproc load)
+{
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+    bool supported = (major > 4) || (major == 4 && minor >= 1);
+    if ( !supported )
+    {
+        GLint num_extensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+        for (GLint i = 0; i < num_extensions && !supported; ++i)
+            supported = strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_get_program_binary") == 0;
+    }
+
+    GLint num_formats = 0;
+    if ( supported )
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+
+    if ( supported && num_formats > 0 )
+    {
+        g_GetProgramBinary  = (PFN_GetProgramBinary)  load("glGetProgramBinary");
+        g_ProgramBinary     = (PFN_ProgramBinary)     load("glProgramBinary");
+        g_ProgramParameteri = (PFN_ProgramParameteri) load("glProgramParameteri");
+    }
+
+    g_ShaderCacheEnabled = g_GetProgramBinary && g_ProgramBinary && g_ProgramParameteri;
+    if ( !g_ShaderCacheEnabled )
+    {
+        printf("Cache de shaders desabilitado: driver não suporta binários de programa.\n");
+        return;
+    }
+
+    g_DriverString  = (const char*)glGetString(GL_VENDOR);
+    g_DriverString += '\n';
+    g_DriverString += (const char*)glGetString(GL_RENDERER);
+    g_DriverString += '\n';
+    g_DriverString += (const char*)glGetString(GL_VERSION);
+
+#ifdef _WIN32
+    _mkdir(SHADER_CACHE_DIR);
+#else
+    mkdir(SHADER_CACHE_DIR, 0755);
+#endif
+}
+
+void ShaderCache_MarkRetrievable(GLuint program_id)
+{
+    if ( g_ShaderCacheEnabled )
+        g_ProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+// Tenta criar o programa a partir do binário salvo. Retorna 0 se não houver
+// binário para este hash ou se o driver o rejeitar.
+static GLuint LoadProgramBinary(const std::string& path, unsigned long long hash)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if ( file == NULL )
+        return 0;
+
+    ShaderCacheHeader header;
+    std::vector<char> binary;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1
+           && header.magic == SHADER_CACHE_MAGIC
+           && header.version == SHADER_CACHE_VERSION
+           && header.hash == hash
+           && header.length > 0;
+    if ( ok )
+    {
+        binary.resize(header.length);
+        ok = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    if ( !ok )
+        return 0;
+
+    GLuint program_id = glCreateProgram();
+    g_ProgramBinary(program_id, header.format, binary.data(), (GLsizei)binary.size());
+
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    if ( linked_ok == GL_FALSE )
+    {
+        glDeleteProgram(program_id);
+        return 0;
+    }
+
+    return program_id;
+}
+
+static void SaveProgramBinary(const std::string& path, unsigned long long hash, GLuint program_id)
+{
+    GLint length = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if ( length <= 0 )
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    g_GetProgramBinary(program_id, length, &length, &format, binary.data());
+
+    ShaderCacheHeader header;
+    header.magic   = SHADER_CACHE_MAGIC;
+    header.version = SHADER_CACHE_VERSION;
+    header.hash    = hash;
+    header.format  = format;
+    header.length  = (unsigned int)length;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "WARNING: Não foi possível escrever o cache de shaders \"%s\".\n", path.c_str());
+        return;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(binary.data(), 1, length, file);
+    fclose(file);
+}
+
+GLuint ShaderCache_CreateProgram(const char* name,
+                                 const char* vertex_label,   const std::string& vertex_source,
+                                 const char* fragment_label, const std::string& fragment_source)
+{
+    std::string path = std::string(SHADER_CACHE_DIR "/") + name + ".bin";
+    unsigned long long hash = 14695981039346656037ULL;
+
+    if ( g_ShaderCacheEnabled )
+    {
+        // O '\0' separa as partes, para que conteúdos diferentes não resultem
+        // na mesma sequência de bytes.
+        hash = HashBytes(hash, vertex_source.c_str(), vertex_source.size() + 1);
+        hash = HashBytes(hash, fragment_source.c_str(), fragment_source.size() + 1);
+        hash = HashBytes(hash, g_DriverString.c_str(), g_DriverString.size() + 1);
+
+        GLuint program_id = LoadProgramBinary(path, hash);
+        if ( program_id != 0 )
+            return program_id;
+    }
+
+    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+    CompileShaderSource(vertex_source, vertex_label, vertex_shader_id);
+
+    GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+    CompileShaderSource(fragment_source, fragment_label, fragment_shader_id);
+
+    GLuint program_id = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    if ( g_ShaderCacheEnabled && linked_ok == GL_TRUE )
+        SaveProgramBinary(path, hash, program_id);
+
+    return program_id;
+}
@@ -0,0 +1,254 @@
+#include "shaderReload.h"
+#include "objects.h"
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Diretório observado; deve conter SHADER_VERTEX_FILENAME e SHADER_FRAGMENT_FILENAME.
+#define SHADER_DIRECTORY "../../src"
+
+// GL_KHR_parallel_shader_compile: permite que o driver utilize várias threads
+// para compilar. Não faz parte do OpenGL 3.3 carregado pela GLAD.
+typedef void (APIENTRYP PFN_MaxShaderCompilerThreadsKHR)(GLuint count);
+
+static GLFWwindow*             g_ReloadContext = NULL; // Janela invisível, dona do contexto compartilhado
+static std::thread             g_WatcherThread;
+static std::thread             g_CompilerThread;
+static std::mutex              g_ReloadMutex;
+static std::condition_variable g_ReloadCondition;
+static bool                    g_ReloadRequested = false; // Protegida por g_ReloadMutex
+static GLuint                  g_ReadyProgram = 0;        // Programa linkado aguardando ShaderReload_Poll(), protegido por g_ReloadMutex
+static std::atomic<bool>       g_ReloadQuit(false);
+
+static bool HasExtension(const char* name)
+{
+    GLint num_extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+    for (GLint i = 0; i < num_extensions; ++i)
+        if ( strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0 )
+            return true;
+    return false;
+}
+
+static void CompilerThread()
+{
+    glfwMakeContextCurrent(g_ReloadContext);
+
+    if ( HasExtension("GL_KHR_parallel_shader_compile") )
+    {
+        PFN_MaxShaderCompilerThreadsKHR max_threads = (PFN_MaxShaderCompilerThreadsKHR) glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+        if ( max_threads )
+            max_threads(0xFFFFFFFFu); // Quantas threads o driver quiser
+    }
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(g_ReloadMutex);
+            g_ReloadCondition.wait(lock, []() { return g_ReloadRequested || g_ReloadQuit; });
+            if ( g_ReloadQuit )
+                break;
+            g_ReloadRequested = false;
+        }
+
+        double start = glfwGetTime();
+        GLuint program_id = CreateGpuProgramFromFiles();
+
+        // Garantimos que o programa está completo antes de entregá-lo ao
+        // contexto principal.
+        glFinish();
+
+        if ( program_id == 0 )
+        {
+            fprintf(stderr, "WARNING: Shaders com erro; mantendo o programa de GPU anterior.\n");
+            continue;
+        }
+
+        printf("Shaders recompilados em segundo plano em %.1f ms.\n", 1000.0 * (glfwGetTime() - start));
+        fflush(stdout);
+
+        std::lock_guard<std::mutex> lock(g_ReloadMutex);
+        if ( g_ReadyProgram != 0 )
+            glDeleteProgram(g_ReadyProgram); // Substituído antes de ser instalado
+        g_ReadyProgram = program_id;
+    }
+
+    glfwMakeContextCurrent(NULL);
+}
+
+#ifdef __linux__
+
+static bool EndsWith(const char* name, const char* suffix)
+{
+    size_t n = strlen(name), m = strlen(suffix);
+    return n >= m && strcmp(name + n - m, suffix) == 0;
+}
+
+// Retorna true se algum evento lido de "fd" se refere a um arquivo ".glsl".
+static bool ReadShaderEvents(int fd)
+{
+    bool changed = false;
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ( (length = read(fd, buffer, sizeof(buffer))) > 0 )
+    {
+        for (char* p = buffer; p < buffer + length; )
+        {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if ( event->len > 0 && EndsWith(event->name, ".glsl") )
+                changed = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+static void WatcherThread()
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if ( fd < 0 || inotify_add_watch(fd, SHADER_DIRECTORY, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0 )
+    {
+        fprintf(stderr, "WARNING: Não foi possível observar \"%s\"; use a tecla R para recarregar os shaders.\n", SHADER_DIRECTORY);
+        if ( fd >= 0 )
+            close(fd);
+        return;
+    }
+
+    while ( !g_ReloadQuit )
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if ( poll(&pfd, 1, 200) <= 0 )
+            continue;
+
+        if ( !ReadShaderEvents(fd) )
+            continue;
+
+        // Editores costumam gerar vários eventos por gravação; esperamos um
+        // pouco e descartamos os eventos seguintes.
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ReadShaderEvents(fd);
+
+        ShaderReload_Request();
+    }
+
+    close(fd);
+}
+
+#else // Sem inotify: verificamos a data de modificação dos shaders da cena.
+
+static time_t ShaderModificationTime()
+{
+    const char* files[] = { SHADER_VERTEX_FILENAME, SHADER_FRAGMENT_FILENAME };
+    time_t newest = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+        struct stat st;
+        if ( stat(files[i], &st) == 0 && st.st_mtime > newest )
+            newest = st.st_mtime;
+    }
+    return newest;
+}
+
+static void WatcherThread()
+{
+    time_t last = ShaderModificationTime();
+    while ( !g_ReloadQuit )
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        time_t now = ShaderModificationTime();
+        if ( now != last )
+        {
+            last = now;
+            ShaderReload_Request();
+        }
+    }
+}
+
+#endif
+
+void ShaderReload_Init(GLFWwindow* window)
+{
+    // O contexto compartilhado precisa de uma janela própria; ela nunca é
+    // mostrada. As demais "hints" (versão do OpenGL, perfil) são as mesmas
+    // definidas em configureGLFW().
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    g_ReloadContext = glfwCreateWindow(1, 1, "", NULL, window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if ( g_ReloadContext == NULL )
+    {
+        fprintf(stderr, "WARNING: Não foi possível criar o contexto OpenGL para recompilar shaders em segundo plano.\n");
+        return;
+    }
+
+    g_ReloadQuit = false;
+    g_CompilerThread = std::thread(CompilerThread);
+    g_WatcherThread = std::thread(WatcherThread);
+}
+
+void ShaderReload_Request()
+{
+    // Sem o contexto compartilhado, recarregamos na própria thread principal.
+    if ( g_ReloadContext == NULL )
+    {
+        reLoadShaders();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_ReloadMutex);
+    g_ReloadRequested = true;
+    g_ReloadCondition.notify_one();
+}
+
+void ShaderReload_Poll()
+{
+    GLuint program_id;
+    {
+        std::lock_guard<std::mutex> lock(g_ReloadMutex);
+        program_id = g_ReadyProgram;
+        g_ReadyProgram = 0;
+    }
+
+    if ( program_id != 0 )
+    {
+        InstallGpuProgram(program_id);
+        fprintf(stdout, "Shaders recarregados!\n");
+        fflush(stdout);
+    }
+}
+
+void ShaderReload_Shutdown()
+{
+    if ( g_ReloadContext == NULL )
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(g_ReloadMutex);
+        g_ReloadQuit = true;
+        g_ReloadCondition.notify_one();
+    }
+    g_WatcherThread.join();
+    g_CompilerThread.join();
+
+    if ( g_ReadyProgram != 0 )
+        glDeleteProgram(g_ReadyProgram);
+    g_ReadyProgram = 0;
+
+    glfwDestroyWindow(g_ReloadContext);
+    g_ReloadContext = NULL;
+}
@@ -57,23 +57,24 @@ uniform sampler2D TextureLightbulbOFF;
 uniform sampler2D TextureLightbulbON;
 uniform sampler2D TextureTable;
 uniform sampler2D TextureDisplay;
-uniform sampler2D TextureDigit0;
-uniform sampler2D TextureDigit1;
-uniform sampler2D TexturePlaneWire;
-uniform sampler2D TexturePlaneNot;
 uniform sampler2D TextureSphere;
-uniform sampler2D TexturePlaneAnd;
 uniform sampler2D TextureBlocks;
 uniform sampler2D TextureFloor;
-uniform sampler2D TexturePlaneOr;
 uniform sampler2D TextureSky;
 
-uniform bool u_andIsInput1Digit0;
-uniform bool u_andIsInput2Digit0;
-uniform bool u_orIsInput1Digit0;
-uniform bool u_orIsInput2Digit0;
-uniform bool u_notIsInputDigit0;
-uniform bool u_wireIsInputDigit0;
+// Texturas com várias camadas (GL_TEXTURE_2D_ARRAY): dígitos dos displays e
+// placas dos circuitos. A camada é escolhida por desenho em "texture_layer".
+// Veja a função LoadTextureArray() em "objects.cpp".
+uniform sampler2DArray TextureDigits;
+uniform sampler2DArray TextureBoards;
+uniform int texture_layer;
+
+// Estado das lâmpadas, calculado na CPU pela simulação dos circuitos. Veja
+// a função UpdateCircuitUniforms() em "objects.cpp".
+uniform bool u_wireLampOn;
+uniform bool u_notLampOn;
+uniform bool u_andLampOn;
+uniform bool u_orLampOn;
 
 // O valor de saída ("out") de um Fragment Shader é a cor final do fragmento.
 out vec4 color;
@@ -189,7 +190,7 @@ void main()
     }
     else if ( object_id == LIGHTBULB_WIRE ) // ON=Blinn-Phong, OFF=Diffuse, Phong shading
     {
-        if (!u_wireIsInputDigit0) {
+        if (u_wireLampOn) {
             Kd = texture(TextureLightbulbON, texcoords).rgb;
             lambertDiffuseTerm = Kd * I * lambert;
             color.rgb = lambertDiffuseTerm + ambientTerm + specularTerm; // Blinn-Phong
@@ -202,7 +203,7 @@ void main()
     }
     else if ( object_id == LIGHTBULB_NOT ) // ON=Blinn-Phong e Phong shading, OFF=Diffuse e Gouraud shading
     {
-        if (u_notIsInputDigit0) {
+        if (u_notLampOn) {
             Kd = texture(TextureLightbulbON, texcoords).rgb;
             lambertDiffuseTerm = Kd * I * lambert;
             color.rgb = lambertDiffuseTerm + ambientTerm + specularTerm; // Blinn-Phong
@@ -215,7 +216,7 @@ void main()
     }
     else if ( object_id == LIGHTBULB_AND ) // ON=Blinn-Phong e Phong shading, OFF=Diffuse e Gouraud shading
     {
-        if (!u_andIsInput1Digit0 && !u_andIsInput2Digit0) {
+        if (u_andLampOn) {
             Kd = texture(TextureLightbulbON, texcoords).rgb;
             lambertDiffuseTerm = Kd * I * lambert;
             color.rgb = lambertDiffuseTerm + ambientTerm + specularTerm; // Blinn-Phong
@@ -228,7 +229,7 @@ void main()
     }
     else if ( object_id == LIGHTBULB_OR ) // ON=Blinn-Phong e Phong shading, OFF=Diffuse e Gouraud shading
     {
-        if (!u_orIsInput1Digit0 || !u_orIsInput2Digit0) {
+        if (u_orLampOn) {
             Kd = texture(TextureLightbulbON, texcoords).rgb;
             lambertDiffuseTerm = Kd * I * lambert;
             color.rgb = lambertDiffuseTerm + ambientTerm + specularTerm; // Blinn-Phong
@@ -265,89 +266,22 @@ void main()
         lambertDiffuseTerm = Kd * I * lambert;
         color.rgb = lambertDiffuseTerm + ambientTerm; // Blinn-Phong
     }
-    else if (object_id == AND_INPUT1_DIGIT) // Diffuse e Phong shading
-    {
-        if (u_andIsInput1Digit0)
-            Kd = texture(TextureDigit0, texcoords).rgb;
-        else
-            Kd = texture(TextureDigit1, texcoords).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == AND_INPUT2_DIGIT) // Diffuse e Phong shading
-    {
-        if (u_andIsInput2Digit0)
-            Kd = texture(TextureDigit0, texcoords).rgb;
-        else
-            Kd = texture(TextureDigit1, texcoords).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == OR_INPUT1_DIGIT) // Diffuse e Phong shading
-    {
-        if (u_orIsInput1Digit0)
-            Kd = texture(TextureDigit0, texcoords).rgb;
-        else
-            Kd = texture(TextureDigit1, texcoords).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == OR_INPUT2_DIGIT) // Diffuse e Phong shading
-    {
-        if (u_orIsInput2Digit0)
-            Kd = texture(TextureDigit0, texcoords).rgb;
-        else
-            Kd = texture(TextureDigit1, texcoords).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == NOT_INPUT1_DIGIT) // Diffuse e Phong shading
+    else if (object_id == AND_INPUT1_DIGIT || object_id == AND_INPUT2_DIGIT
+          || object_id == OR_INPUT1_DIGIT  || object_id == OR_INPUT2_DIGIT
+          || object_id == NOT_INPUT1_DIGIT || object_id == WIRE_INPUT1_DIGIT) // Diffuse e Phong shading
     {
-        if (u_notIsInputDigit0)
-            Kd = texture(TextureDigit0, texcoords).rgb;
-        else
-            Kd = texture(TextureDigit1, texcoords).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == WIRE_INPUT1_DIGIT) // Diffuse e Phong shading
-    {
-        if (u_wireIsInputDigit0)
-            Kd = texture(TextureDigit0, texcoords).rgb;
-        else
-            Kd = texture(TextureDigit1, texcoords).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == PLANE_WIRE) // Diffuse e Phong shading
-    {
-        U = texcoords.x;
-        V = texcoords.y;
-        Kd = texture(TexturePlaneWire, vec2(U,V)).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == PLANE_NOT) // Diffuse e Phong shading
-    {
-        U = texcoords.x;
-        V = texcoords.y;
-        Kd = texture(TexturePlaneNot, vec2(U,V)).rgb;
-        lambertDiffuseTerm = Kd * I * lambert;
-        color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
-    }
-    else if (object_id == PLANE_AND) // Diffuse e Phong shading
-    {
-        U = texcoords.x;
-        V = texcoords.y;
-        Kd = texture(TexturePlaneAnd, vec2(U,V)).rgb;
+        // A camada (dígito 0 ou 1) é definida pelo código C++ de acordo com
+        // o estado do input de cada display.
+        Kd = texture(TextureDigits, vec3(texcoords, texture_layer)).rgb;
         lambertDiffuseTerm = Kd * I * lambert;
         color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
     }
-    else if (object_id == PLANE_OR) // Diffuse e Phong shading
+    else if (object_id == PLANE_WIRE || object_id == PLANE_NOT
+          || object_id == PLANE_AND  || object_id == PLANE_OR) // Diffuse e Phong shading
     {
         U = texcoords.x;
         V = texcoords.y;
-        Kd = texture(TexturePlaneOr, vec2(U,V)).rgb;
+        Kd = texture(TextureBoards, vec3(U, V, texture_layer)).rgb;
         lambertDiffuseTerm = Kd * I * lambert;
         color.rgb = lambertDiffuseTerm + ambientTerm; // Diffuse
     }
@@ -0,0 +1,383 @@
+#include "simulator.h"
+#include "bitsim.h"
+#include "compiledsim.h"
+#include "nativesim.h"
+#include "parallelsim.h"
+
+#include <cstdio>
+#include <chrono>
+
+void Simulator_Init(Simulator* sim, Netlist* netlist)
+{
+    uint32_t num_gates = Netlist_NumGates(netlist);
+    uint32_t num_nets = Netlist_NumNets(netlist);
+
+    sim->netlist = netlist;
+    sim->changed.clear();
+    sim->next_changed.clear();
+    sim->gates.clear();
+    sim->dirty.clear();
+    sim->changed.reserve(num_nets);
+    sim->next_changed.reserve(num_nets);
+    sim->dirty.reserve(num_nets);
+    sim->gates.reserve(num_gates);
+    sim->gate_queued.assign(num_gates, 0);
+    sim->net_queued.assign(num_nets, 0);
+    sim->new_value.assign(num_gates, 0);
+    sim->net_dirty.assign(num_nets, 0);
+
+    sim->events = 0;
+    sim->evaluations = 0;
+    sim->waves = 0;
+    sim->cycles = 0;
+    sim->seconds = 0.0;
+    sim->oscillating = false;
+
+    // Os clocks começam em 0 e os registradores com seu valor inicial.
+    sim->rising_flops.clear();
+    sim->falling_flops.clear();
+    sim->latches.clear();
+    for (size_t i = 0; i < netlist->clocks.size(); ++i)
+        netlist->net_value[netlist->clocks[i]] = 0;
+    for (uint32_t r = 0; r < Netlist_NumRegisters(netlist); ++r)
+    {
+        netlist->net_value[netlist->reg_q[r]] = netlist->reg_init[r];
+        if ( netlist->reg_type[r] == REG_DFF_RISING )
+            sim->rising_flops.push_back(r);
+        else if ( netlist->reg_type[r] == REG_DFF_FALLING )
+            sim->falling_flops.push_back(r);
+        else
+            sim->latches.push_back(r);
+    }
+    sim->sample.assign(sim->rising_flops.size() > sim->falling_flops.size() ? sim->rising_flops.size() : sim->falling_flops.size(), 0);
+
+    // Os valores das nets internas ainda não correspondem às entradas: a
+    // primeira onda avalia todas as portas. As saídas dos latches também são
+    // propagadas, caso não haja portas.
+    for (uint32_t g = 0; g < num_gates; ++g)
+    {
+        sim->gates.push_back(g);
+        sim->gate_queued[g] = 1;
+    }
+    for (size_t i = 0; i < sim->latches.size(); ++i)
+    {
+        uint32_t q = netlist->reg_q[sim->latches[i]];
+        sim->net_queued[q] = 1;
+        sim->changed.push_back(q);
+    }
+    Simulator_Run(sim);
+
+    // Quem mostra o circuito lê todas as nets uma vez depois da
+    // inicialização; daqui em diante, só as que mudarem.
+    Simulator_ClearDirty(sim);
+}
+
+// Acrescenta "net" a "dirty", se ainda não está lá.
+static inline void MarkDirty(Simulator* sim, uint32_t net)
+{
+    if ( !sim->net_dirty[net] )
+    {
+        sim->net_dirty[net] = 1;
+        sim->dirty.push_back(net);
+    }
+}
+
+void Simulator_ClearDirty(Simulator* sim)
+{
+    for (size_t i = 0; i < sim->dirty.size(); ++i)
+        sim->net_dirty[sim->dirty[i]] = 0;
+    sim->dirty.clear();
+}
+
+// Altera uma net sem porta (entrada, clock ou saída de registrador) e a
+// coloca na fila de mudanças.
+static void SetNet(Simulator* sim, uint32_t net, uint8_t value)
+{
+    uint8_t& current = sim->netlist->net_value[net];
+    if ( current == value )
+        return;
+
+    current = value;
+    MarkDirty(sim, net);
+    if ( !sim->net_queued[net] )
+    {
+        sim->net_queued[net] = 1;
+        sim->changed.push_back(net);
+    }
+}
+
+void Simulator_SetInput(Simulator* sim, int input, bool value)
+{
+    if ( input < 0 || input >= (int)sim->netlist->inputs.size() )
+        return;
+
+    // Alterar uma entrada que é um clock é uma borda de todos os clocks.
+    uint32_t net = sim->netlist->inputs[input];
+    for (size_t i = 0; i < sim->netlist->clocks.size(); ++i)
+    {
+        if ( sim->netlist->clocks[i] == net )
+        {
+            if ( sim->netlist->net_value[net] != (value ? 1 : 0) )
+                Simulator_ClockEdge(sim, value);
+            return;
+        }
+    }
+    SetNet(sim, net, value ? 1 : 0);
+}
+
+void Simulator_ToggleInput(Simulator* sim, int input)
+{
+    Simulator_SetInput(sim, input, !Netlist_GetInput(sim->netlist, input));
+}
+
+bool Simulator_HasPendingEvents(const Simulator* sim)
+{
+    return !sim->changed.empty() || !sim->gates.empty();
+}
+
+// Imprime algumas das nets que continuam mudando depois do limite de ondas.
+static void ReportOscillation(const Simulator* sim, const std::vector<uint32_t>& nets, bool through_latches)
+{
+    if ( through_latches )
+        fprintf(stderr, "WARNING: Os latches não estabilizaram após %zu passadas; o circuito tem um laço através de latches transparentes. Nets:",
+                sim->latches.size() + 1);
+    else
+        fprintf(stderr, "WARNING: A simulação não estabilizou após %u ondas; o circuito tem um laço que oscila. Nets:",
+                Netlist_NumGates(sim->netlist) + 1);
+    for (size_t i = 0; i < nets.size() && i < 8; ++i)
+        fprintf(stderr, " %s", Netlist_NetName(sim->netlist, nets[i]));
+    fprintf(stderr, nets.size() > 8 ? " ...\n" : "\n");
+}
+
+// Copia "d" para "q" nos latches transparentes. Retorna true se algum mudou.
+static bool UpdateLatches(Simulator* sim)
+{
+    const Netlist* netlist = sim->netlist;
+    const uint8_t* value = netlist->net_value.data();
+    bool changed = false;
+    for (size_t i = 0; i < sim->latches.size(); ++i)
+    {
+        uint32_t r = sim->latches[i];
+        uint8_t active = netlist->reg_type[r] == REG_LATCH_HIGH ? 1 : 0;
+        uint32_t q = netlist->reg_q[r];
+        if ( value[netlist->reg_clock[r]] == active && value[q] != value[netlist->reg_d[r]] )
+        {
+            SetNet(sim, q, value[netlist->reg_d[r]]);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+uint64_t Simulator_Run(Simulator* sim)
+{
+    if ( !Simulator_HasPendingEvents(sim) )
+        return 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Netlist* netlist = sim->netlist;
+    const uint32_t* fanout_begin = netlist->net_fanout_begin.data();
+    const uint32_t* fanout = netlist->net_fanout.data();
+    const uint32_t* gate_output = netlist->gate_output.data();
+    uint8_t* value = netlist->net_value.data();
+
+    uint64_t max_waves = (uint64_t)Netlist_NumGates(netlist) + 1;
+    uint64_t wave = 0;
+    uint64_t wave_limit = max_waves;
+    uint64_t events = 0;
+    size_t latch_passes = 0;
+    sim->oscillating = false;
+
+    for (;;)
+    {
+        // Portas do fan-out das nets que mudaram, sem repetições.
+        for (size_t i = 0; i < sim->changed.size(); ++i)
+        {
+            uint32_t net = sim->changed[i];
+            sim->net_queued[net] = 0;
+            for (uint32_t k = fanout_begin[net]; k < fanout_begin[net + 1]; ++k)
+            {
+                uint32_t gate = fanout[k];
+                if ( !sim->gate_queued[gate] )
+                {
+                    sim->gate_queued[gate] = 1;
+                    sim->gates.push_back(gate);
+                }
+            }
+        }
+        events += sim->changed.size();
+        sim->changed.clear();
+
+        if ( sim->gates.empty() )
+        {
+            // Lógica estável: os latches transparentes podem mudar e
+            // recomeçar a propagação, que tem então um novo limite de ondas.
+            if ( sim->latches.empty() || !UpdateLatches(sim) )
+                break;
+            if ( ++latch_passes > sim->latches.size() )
+            {
+                ReportOscillation(sim, sim->changed, true);
+                for (size_t i = 0; i < sim->changed.size(); ++i)
+                    sim->net_queued[sim->changed[i]] = 0;
+                sim->changed.clear();
+                sim->oscillating = true;
+                break;
+            }
+            wave_limit = wave + max_waves;
+            continue;
+        }
+        wave += 1;
+
+        // Todas as portas da onda são avaliadas antes que qualquer saída
+        // mude, para que a ordem de avaliação não altere o resultado.
+        size_t num_gates = sim->gates.size();
+        for (size_t i = 0; i < num_gates; ++i)
+            sim->new_value[i] = Netlist_EvaluateGate(netlist, sim->gates[i]);
+        sim->evaluations += num_gates;
+
+        for (size_t i = 0; i < num_gates; ++i)
+        {
+            uint32_t gate = sim->gates[i];
+            uint32_t net = gate_output[gate];
+            sim->gate_queued[gate] = 0;
+            if ( value[net] != sim->new_value[i] )
+            {
+                value[net] = sim->new_value[i];
+                sim->next_changed.push_back(net);
+                MarkDirty(sim, net);
+            }
+        }
+        sim->gates.clear();
+        sim->changed.swap(sim->next_changed);
+
+        if ( wave >= wave_limit && !sim->changed.empty() )
+        {
+            ReportOscillation(sim, sim->changed, false);
+            sim->changed.clear();
+            sim->oscillating = true;
+            break;
+        }
+    }
+
+    sim->events += events;
+    sim->waves += wave;
+    sim->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return events;
+}
+
+void Simulator_ClockEdge(Simulator* sim, bool level)
+{
+    // As mudanças pendentes são propagadas antes da borda, e então os
+    // flip-flops da borda amostram "d" antes que qualquer saída mude.
+    Simulator_Run(sim);
+
+    Netlist* netlist = sim->netlist;
+    const std::vector<uint32_t>& flops = level ? sim->rising_flops : sim->falling_flops;
+    for (size_t i = 0; i < flops.size(); ++i)
+        sim->sample[i] = netlist->net_value[netlist->reg_d[flops[i]]];
+    for (size_t i = 0; i < netlist->clocks.size(); ++i)
+        SetNet(sim, netlist->clocks[i], level ? 1 : 0);
+    for (size_t i = 0; i < flops.size(); ++i)
+        SetNet(sim, netlist->reg_q[flops[i]], sim->sample[i]);
+    Simulator_Run(sim);
+
+    if ( !level )
+        sim->cycles += 1;
+}
+
+void Simulator_Cycle(Simulator* sim)
+{
+    Simulator_ClockEdge(sim, true);
+    Simulator_ClockEdge(sim, false);
+}
+
+// Gerador pseudoaleatório (xorshift), para que o netlist do benchmark seja
+// sempre o mesmo.
+static uint32_t NextRandom(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+void Simulator_Benchmark(uint32_t num_gates, int max_threads, bool native)
+{
+    uint32_t seed = 12345;
+    uint32_t num_inputs = num_gates / 32 > 16 ? num_gates / 32 : 16;
+    char name[32];
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Cada porta lê nets já existentes, metade das vezes entre as 1024 mais
+    // recentes (caminhos longos) e metade entre quaisquer (fan-out grande),
+    // então o netlist não tem laços.
+    Netlist netlist;
+    netlist.net_value.reserve(num_inputs + num_gates);
+    netlist.net_name_offset.reserve(num_inputs + num_gates);
+    for (uint32_t i = 0; i < num_inputs; ++i)
+    {
+        snprintf(name, sizeof(name), "in%u", i);
+        Netlist_AddInput(&netlist, name);
+    }
+    static const int types[] = { GATE_AND, GATE_OR, GATE_NAND, GATE_NOR, GATE_XOR, GATE_NOT };
+    for (uint32_t g = 0; g < num_gates; ++g)
+    {
+        int type = types[NextRandom(&seed) % 6];
+        int num_pins = type == GATE_NOT ? 1 : 2;
+        uint32_t num_nets = Netlist_NumNets(&netlist);
+        uint32_t pins[2];
+        for (int p = 0; p < num_pins; ++p)
+        {
+            uint32_t r = NextRandom(&seed);
+            if ( (r & 1) && num_nets > 1024 )
+                pins[p] = num_nets - 1 - (r >> 1) % 1024;
+            else
+                pins[p] = (r >> 1) % num_nets;
+        }
+        snprintf(name, sizeof(name), "n%u", g);
+        uint32_t output = Netlist_AddNet(&netlist, name);
+        Netlist_AddGate(&netlist, type, pins, num_pins, output);
+    }
+    if ( !Netlist_Finalize(&netlist) )
+        return;
+
+    double build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Simulator sim;
+    Simulator_Init(&sim, &netlist);
+
+    printf("Benchmark da simulação: %u portas, %u nets, %u entradas (construção em %.1f ms).\n",
+           num_gates, Netlist_NumNets(&netlist), num_inputs, 1000.0 * build_seconds);
+    printf("  avaliação completa  %8.2f ms  %6.1f M avaliações/s\n",
+           1000.0 * sim.seconds, sim.evaluations / sim.seconds / 1e6);
+
+    const int toggles = 10000;
+    sim.events = 0;
+    sim.evaluations = 0;
+    sim.waves = 0;
+    sim.seconds = 0.0;
+    for (int i = 0; i < toggles; ++i)
+    {
+        Simulator_ToggleInput(&sim, NextRandom(&seed) % num_inputs);
+        Simulator_Run(&sim);
+    }
+
+    printf("  trocas de entradas  %8.2f ms  %6.1f M eventos/s, %.1f M avaliações/s (%.0f eventos e %.1f ondas por troca)\n",
+           1000.0 * sim.seconds,
+           sim.events / sim.seconds / 1e6, sim.evaluations / sim.seconds / 1e6,
+           (double)sim.events / toggles, (double)sim.waves / toggles);
+
+    // O netlist está estável após a última troca (e continua estável após
+    // CompiledSim_Benchmark(), que também usa "sim"): serve de referência
+    // para as outras simulações.
+    BitSim_Benchmark(&netlist);
+    CompiledSim_Benchmark(&netlist, &sim);
+    if ( native || num_gates <= NATIVESIM_BENCHMARK_MAX_GATES )
+        NativeSim_Benchmark(&netlist);
+    else
+        printf("  código nativo: omitido acima de %d portas (use --sim-native)\n", NATIVESIM_BENCHMARK_MAX_GATES);
+    ParallelSim_Benchmark(&netlist, max_threads);
+}
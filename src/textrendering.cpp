@@ -2,8 +2,10 @@
 //   and on https://github.com/rougier/freetype-gl
 
 #include "textrendering.h"
-
-GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Função definida em main.cpp
+#include "shaderCache.h"
+#include "profiler.h"
+#include "glStats.h"
+#include "window.h"
 
 const GLchar* const textvertexshader_source = ""
 "#version 330\n"
@@ -27,53 +29,6 @@ const GLchar* const textfragmentshader_source = ""
 "}\n"
 "\0";
 
-void TextRendering_LoadShader(const GLchar* const shader_string, GLuint shader_id)
-{
-    // Define o código do shader, contido na string "shader_string"
-    glShaderSource(shader_id, 1, &shader_string, NULL);
-
-    // Compila o código do shader (em tempo de execução)
-    glCompileShader(shader_id);
-
-    // Verificamos se ocorreu algum erro ou "warning" durante a compilação
-    GLint compiled_ok;
-    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compiled_ok);
-
-    GLint log_length = 0;
-    glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &log_length);
-
-    // Alocamos memória para guardar o log de compilação.
-    // A chamada "new" em C++ é equivalente ao "malloc()" do C.
-    GLchar* log = new GLchar[log_length];
-    glGetShaderInfoLog(shader_id, log_length, &log_length, log);
-
-    // Imprime no terminal qualquer erro ou "warning" de compilação
-    if ( log_length != 0 )
-    {
-        std::string  output;
-
-        if ( !compiled_ok )
-        {
-            output += "ERROR: OpenGL compilation failed.\n";
-            output += "== Start of compilation log\n";
-            output += log;
-            output += "== End of compilation log\n";
-        }
-        else
-        {
-            output += "ERROR: OpenGL compilation failed.\n";
-            output += "== Start of compilation log\n";
-            output += log;
-            output += "== End of compilation log\n";
-        }
-
-        fprintf(stderr, "%s", output.c_str());
-    }
-
-    // A chamada "delete" em C++ é equivalente ao "free()" do C
-    delete [] log;
-}
-
 GLuint textVAO;
 GLuint textVBO;
 GLuint textprogram_id;
@@ -93,16 +48,8 @@ void TextRendering_Init()
     glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glCheckError();
 
-    GLuint textvertexshader_id = glCreateShader(GL_VERTEX_SHADER);
-    TextRendering_LoadShader(textvertexshader_source, textvertexshader_id);
-    glCheckError();
-
-    GLuint textfragmentshader_id = glCreateShader(GL_FRAGMENT_SHADER);
-    TextRendering_LoadShader(textfragmentshader_source, textfragmentshader_id);
-    glCheckError();
-
-    textprogram_id = CreateGpuProgram(textvertexshader_id, textfragmentshader_id);
-    glLinkProgram(textprogram_id);
+    textprogram_id = ShaderCache_CreateProgram("text", "text vertex shader", textvertexshader_source,
+                                               "text fragment shader", textfragmentshader_source);
     glCheckError();
 
     GLuint texttex_uniform;
@@ -140,7 +87,7 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
 {
     scale *= textscale;
     int width, height;
-    glfwGetWindowSize(window, &width, &height);
+    getWindowSize(window, &width, &height);
     float sx = scale / width;
     float sy = scale / height;
 
@@ -206,14 +153,14 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
 float TextRendering_LineHeight(GLFWwindow* window)
 {
     int width, height;
-    glfwGetWindowSize(window, &width, &height);
+    getWindowSize(window, &width, &height);
     return dejavufont.height / height * textscale;
 }
 
 float TextRendering_CharWidth(GLFWwindow* window)
 {
     int width, height;
-    glfwGetWindowSize(window, &width, &height);
+    getWindowSize(window, &width, &height);
     return dejavufont.glyphs[32].advance_x / width * textscale;
 }
 
@@ -337,7 +284,7 @@ void TextRendering_ShowModelViewProjection(
     TextRendering_PrintMatrixVectorProductDivW(window, projection, p_camera, -1.0f, 1.0f-18*pad, 1.0f);
 
     int width, height;
-    glfwGetFramebufferSize(window, &width, &height);
+    getFramebufferSize(window, &width, &height);
 
     glm::vec2 a = glm::vec2(-1, -1);
     glm::vec2 b = glm::vec2(+1, +1);
@@ -411,7 +358,7 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
 
     // Variáveis estáticas (static) mantém seus valores entre chamadas
     // subsequentes da função!
-    static float old_seconds = (float)glfwGetTime();
+    static float old_seconds = (float)getTime();
     static int   ellapsed_frames = 0;
     static char  buffer[20] = "?? fps";
     static int   numchars = 7;
@@ -419,7 +366,7 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     ellapsed_frames += 1;
 
     // Recuperamos o número de segundos que passou desde a execução do programa
-    float seconds = (float)glfwGetTime();
+    float seconds = (float)getTime();
 
     // Número de segundos desde o último cálculo do fps
     float ellapsed_seconds = seconds - old_seconds;
@@ -436,4 +383,64 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     float charwidth = TextRendering_CharWidth(window);
 
     TextRendering_PrintString(window, buffer, 1.0f-(numchars + 1)*charwidth, 1.0f-lineheight, 1.0f);
-}
\ No newline at end of file
+}
+
+// Escrevemos na tela, para cada zona do profiler de CPU e de GPU (veja
+// "profiler.h"), a duração média, o percentil 99 e a máxima no último
+// segundo, em ms. Se compilado com GL_STATS, mostramos também as chamadas
+// OpenGL do último quadro (veja "glStats.h").
+void TextRendering_ShowProfiler(GLFWwindow* window)
+{
+    if ( !g_ShowProfiler )
+        return;
+
+    // Ordenar as durações de todas as zonas a cada quadro custaria mais que as
+    // próprias zonas; recalculamos o resumo duas vezes por segundo.
+    static double      last_update = -1.0;
+    static std::string lines[40];
+    static int         numlines = 0;
+
+    double seconds = getTime();
+    if ( seconds - last_update > 0.5 )
+    {
+        ProfileZoneStats stats[15];
+        char buffer[80];
+        numlines = 0;
+
+        for (int gpu = 0; gpu < 2; ++gpu)
+        {
+            int num_zones = gpu ? Profiler_GetGpuZoneStats(stats, 15, PROFILER_STATS_SECONDS)
+                                : Profiler_GetZoneStats(stats, 15, PROFILER_STATS_SECONDS);
+            if ( num_zones == 0 )
+                continue;
+
+            snprintf(buffer, 80, "%-12s %7s %7s %7s", gpu ? "GPU (ms)" : "CPU (ms)", "mean", "p99", "max");
+            lines[numlines++] = buffer;
+            for (int i = 0; i < num_zones; ++i)
+            {
+                snprintf(buffer, 80, "%-12.12s %7.3f %7.3f %7.3f", stats[i].name, stats[i].mean_ms, stats[i].p99_ms, stats[i].max_ms);
+                lines[numlines++] = buffer;
+            }
+        }
+
+        if ( GLStats_Enabled() )
+        {
+            const GLStats& gl = GLStats_LastFrame();
+            snprintf(buffer, 80, "GL: %lu draws, %lu tris, %lu uniforms",
+                     gl.draw_calls, gl.triangles, gl.uniform_uploads);
+            lines[numlines++] = buffer;
+            snprintf(buffer, 80, "    %lu programs, %lu VAOs, %lu textures",
+                     gl.program_switches, gl.vao_binds, gl.texture_binds);
+            lines[numlines++] = buffer;
+            snprintf(buffer, 80, "    %lu buffer uploads (%lu bytes)",
+                     gl.buffer_uploads, gl.buffer_bytes);
+            lines[numlines++] = buffer;
+        }
+        last_update = seconds;
+    }
+
+    float lineheight = TextRendering_LineHeight(window);
+
+    for (int i = 0; i < numlines; ++i)
+        TextRendering_PrintString(window, lines[i], -1.0f+lineheight/10, 1.0f-(i + 1)*lineheight, 1.0f);
+}
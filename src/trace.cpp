@@ -0,0 +1,241 @@
+#include "trace.h"
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/stat.h>
+#endif
+
+// Evento "complete" (ph = "X") do formato trace_event.
+struct TraceEvent
+{
+    std::string                        name;
+    int                                tid;
+    double                             start_us;
+    double                             duration_us;  // < 0 enquanto o escopo está aberto
+    double                             cpu_start_ms;
+    double                             cpu_ms;
+    std::map<std::string, double>      numbers;
+    std::map<std::string, std::string> strings;
+};
+
+static std::atomic<bool>          g_TraceEnabled(false);
+static std::mutex                 g_TraceMutex;
+static std::vector<TraceEvent>    g_TraceEvents;
+static std::map<int, std::string> g_TraceThreadNames;
+static std::string                g_TraceFilename;
+static std::chrono::steady_clock::time_point g_TraceStart;
+static std::atomic<int>           g_TraceNextThreadId(0);
+
+static thread_local int              t_TraceThreadId = -1;
+static thread_local std::vector<int> t_TraceScopes; // Escopos abertos nesta thread
+
+static int ThreadId()
+{
+    if ( t_TraceThreadId < 0 )
+        t_TraceThreadId = g_TraceNextThreadId++;
+    return t_TraceThreadId;
+}
+
+static double NowMicroseconds()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - g_TraceStart).count();
+}
+
+// Tempo de CPU consumido pela thread atual, em milissegundos.
+static double ThreadCpuMilliseconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if ( !GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user) )
+        return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) / 10000.0; // Unidades de 100 ns
+#else
+    struct timespec ts;
+    if ( clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0 )
+        return 0.0;
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+void Trace_Begin(const char* filename)
+{
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    g_TraceFilename = filename;
+    g_TraceStart = std::chrono::steady_clock::now();
+    g_TraceEvents.clear();
+    g_TraceThreadNames.clear();
+    g_TraceThreadNames[ThreadId()] = "main";
+    g_TraceEnabled = true;
+}
+
+bool Trace_IsEnabled()
+{
+    return g_TraceEnabled;
+}
+
+void Trace_SetThreadName(const char* name)
+{
+    if ( !g_TraceEnabled )
+        return;
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    g_TraceThreadNames[ThreadId()] = name;
+}
+
+TraceScope::TraceScope(const char* name)
+{
+    active = g_TraceEnabled;
+    index = -1;
+    if ( !active )
+        return;
+
+    TraceEvent event;
+    event.name = name;
+    event.tid = ThreadId();
+    event.duration_us = -1.0;
+    event.cpu_start_ms = ThreadCpuMilliseconds();
+    event.cpu_ms = 0.0;
+
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    event.start_us = NowMicroseconds();
+    index = (int)g_TraceEvents.size();
+    g_TraceEvents.push_back(event);
+    t_TraceScopes.push_back(index);
+}
+
+TraceScope::~TraceScope()
+{
+    if ( !active )
+        return;
+
+    double cpu_end_ms = ThreadCpuMilliseconds();
+
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    t_TraceScopes.pop_back();
+
+    // O trace pode ter sido encerrado (e reiniciado) com o escopo aberto.
+    if ( index >= (int)g_TraceEvents.size() || g_TraceEvents[index].tid != ThreadId() )
+        return;
+
+    TraceEvent& event = g_TraceEvents[index];
+    event.duration_us = NowMicroseconds() - event.start_us;
+    event.cpu_ms = cpu_end_ms - event.cpu_start_ms;
+}
+
+void Trace_AddArg(const char* key, double value)
+{
+    if ( !g_TraceEnabled || t_TraceScopes.empty() )
+        return;
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    g_TraceEvents[t_TraceScopes.back()].numbers[key] += value;
+}
+
+void Trace_AddArg(const char* key, const char* value)
+{
+    if ( !g_TraceEnabled || t_TraceScopes.empty() )
+        return;
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    g_TraceEvents[t_TraceScopes.back()].strings[key] = value;
+}
+
+void Trace_AddFileRead(const char* filename)
+{
+    if ( !g_TraceEnabled )
+        return;
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if ( GetFileAttributesExA(filename, GetFileExInfoStandard, &data) )
+        Trace_AddArg("bytes_read", (double)data.nFileSizeHigh * 4294967296.0 + data.nFileSizeLow);
+#else
+    struct stat st;
+    if ( stat(filename, &st) == 0 )
+        Trace_AddArg("bytes_read", (double)st.st_size);
+#endif
+}
+
+static void WriteJsonString(FILE* file, const std::string& s)
+{
+    fputc('"', file);
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        unsigned char c = (unsigned char)s[i];
+        if ( c == '"' || c == '\\' )
+            fprintf(file, "\\%c", c);
+        else if ( c < 0x20 )
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+void Trace_End()
+{
+    if ( !g_TraceEnabled )
+        return;
+
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    g_TraceEnabled = false;
+
+    FILE* file = fopen(g_TraceFilename.c_str(), "w");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "WARNING: Não foi possível escrever o trace \"%s\".\n", g_TraceFilename.c_str());
+        return;
+    }
+
+    double now_us = NowMicroseconds();
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (std::map<int, std::string>::const_iterator it = g_TraceThreadNames.begin(); it != g_TraceThreadNames.end(); ++it)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", it->first);
+        WriteJsonString(file, it->second);
+        fprintf(file, "}}");
+        first = false;
+    }
+    for (size_t i = 0; i < g_TraceEvents.size(); ++i)
+    {
+        const TraceEvent& event = g_TraceEvents[i];
+
+        // Escopos ainda abertos (ex: o primeiro quadro) terminam agora.
+        double duration_us = event.duration_us >= 0.0 ? event.duration_us : now_us - event.start_us;
+
+        fprintf(file, "%s{\"name\":", first ? "" : ",\n");
+        WriteJsonString(file, event.name);
+        fprintf(file, ",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"thread_cpu_ms\":%.3f",
+                event.tid, event.start_us, duration_us, event.cpu_ms);
+        for (std::map<std::string, double>::const_iterator it = event.numbers.begin(); it != event.numbers.end(); ++it)
+        {
+            fputc(',', file);
+            WriteJsonString(file, it->first);
+            fprintf(file, ":%.0f", it->second);
+        }
+        for (std::map<std::string, std::string>::const_iterator it = event.strings.begin(); it != event.strings.end(); ++it)
+        {
+            fputc(',', file);
+            WriteJsonString(file, it->first);
+            fputc(':', file);
+            WriteJsonString(file, it->second);
+        }
+        fprintf(file, "}}");
+        first = false;
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Trace da inicialização escrito em \"%s\" (%lu eventos).\n", g_TraceFilename.c_str(), (unsigned long)g_TraceEvents.size());
+}
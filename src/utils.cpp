@@ -0,0 +1,30 @@
+#include "utils.h"
+
+// A <windows.h> fica restrita a este arquivo: incluída em "utils.h", ela
+// chegaria a todo o projeto via "globals.h", e suas macros min e max
+// quebrariam std::min(), std::max() e std::numeric_limits<>::max().
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+size_t GetPeakResidentMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if ( GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) )
+        return (size_t)counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if ( getrusage(RUSAGE_SELF, &usage) != 0 )
+        return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;         // Em bytes no macOS
+#else
+    return (size_t)usage.ru_maxrss * 1024;  // Em kilobytes no Linux
+#endif
+#endif
+}
@@ -1,4 +1,27 @@
 #include "window.h"
+#include "shaderCache.h"
+#include "glStats.h"
+
+#include <chrono>
+#include <cstring>
+
+#ifdef HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static EGLDisplay g_EglDisplay = EGL_NO_DISPLAY;
+static EGLContext g_EglContext = EGL_NO_CONTEXT;
+static GLuint     g_HeadlessFramebuffer = 0;
+static GLuint     g_HeadlessColorBuffer = 0;
+static GLuint     g_HeadlessDepthBuffer = 0;
+#endif
+
+// Estado do modo sem janela. Veja createHeadlessContext().
+static bool   g_Headless = false;
+static bool   g_HeadlessShouldClose = false;
+static int    g_HeadlessWidth = 0;
+static int    g_HeadlessHeight = 0;
+static std::chrono::steady_clock::time_point g_HeadlessStart;
 
 void initializeGLFW() {
     // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
@@ -51,6 +74,8 @@ void setCallbacks(GLFWwindow* window) {
     // Carregamento de todas funções definidas por OpenGL 3.3, utilizando a
     // biblioteca GLAD.
     gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+    ShaderCache_Init((GLADloadproc) glfwGetProcAddress);
+    GLStats_Init();
 
     // Definimos a função de callback que será chamada sempre que a janela for
     // redimensionada, por consequência alterando o tamanho do "framebuffer"
@@ -66,4 +91,184 @@ void printGPUinfo() {
     const GLubyte *glslversion = glGetString(GL_SHADING_LANGUAGE_VERSION);
     
     printf("GPU: %s, %s, OpenGL %s, GLSL %s\n", vendor, renderer, glversion, glslversion);
-}
\ No newline at end of file
+}
+
+#ifdef HEADLESS
+
+// Display EGL que não depende de um servidor gráfico. No Mesa, a plataforma
+// "surfaceless" funciona mesmo sem /dev/dri, utilizando o llvmpipe.
+static EGLDisplay GetHeadlessDisplay()
+{
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if ( extensions != NULL && strstr(extensions, "EGL_MESA_platform_surfaceless") != NULL )
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if ( get_platform_display )
+            return get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+void createHeadlessContext(int width, int height) {
+    g_HeadlessStart = std::chrono::steady_clock::now();
+
+    g_EglDisplay = GetHeadlessDisplay();
+    if ( g_EglDisplay == EGL_NO_DISPLAY || !eglInitialize(g_EglDisplay, NULL, NULL) )
+    {
+        fprintf(stderr, "ERROR: eglInitialize() failed (0x%x).\n", eglGetError());
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Mesma versão e perfil pedidos à GLFW em configureGLFW(). Como não há
+    // superfície, qualquer configuração que suporte OpenGL serve (o padrão de
+    // EGL_SURFACE_TYPE exigiria suporte a janelas).
+    EGLint config_attribs[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE,    0,
+        EGL_NONE
+    };
+    EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION,       3,
+        EGL_CONTEXT_MINOR_VERSION,       3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint num_configs = 0;
+    if ( !eglBindAPI(EGL_OPENGL_API)
+      || !eglChooseConfig(g_EglDisplay, config_attribs, &config, 1, &num_configs) || num_configs == 0 )
+    {
+        fprintf(stderr, "ERROR: EGL: no OpenGL config available (0x%x).\n", eglGetError());
+        std::exit(EXIT_FAILURE);
+    }
+
+    g_EglContext = eglCreateContext(g_EglDisplay, config, EGL_NO_CONTEXT, context_attribs);
+    if ( g_EglContext == EGL_NO_CONTEXT
+      || !eglMakeCurrent(g_EglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, g_EglContext) )
+    {
+        fprintf(stderr, "ERROR: EGL: failed to create an OpenGL 3.3 core context (0x%x).\n", eglGetError());
+        std::exit(EXIT_FAILURE);
+    }
+
+    gladLoadGLLoader((GLADloadproc) eglGetProcAddress);
+    ShaderCache_Init((GLADloadproc) eglGetProcAddress);
+    GLStats_Init();
+
+    // Sem superfície não existe o framebuffer padrão: criamos um FBO com
+    // cores RGBA8 e Z-buffer de 24 bits, que fica ativo durante toda a
+    // execução, e as chamadas de desenho da cena não precisam saber disso.
+    glGenRenderbuffers(1, &g_HeadlessColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_HeadlessColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &g_HeadlessDepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_HeadlessDepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    glGenFramebuffers(1, &g_HeadlessFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_HeadlessFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_HeadlessColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, g_HeadlessDepthBuffer);
+
+    if ( glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE )
+    {
+        fprintf(stderr, "ERROR: headless framebuffer of %dx%d pixels is incomplete.\n", width, height);
+        std::exit(EXIT_FAILURE);
+    }
+
+    g_Headless = true;
+    g_HeadlessWidth = width;
+    g_HeadlessHeight = height;
+
+    FramebufferSizeCallback(NULL, width, height);
+}
+
+#else
+
+void createHeadlessContext(int width, int height) {
+    fprintf(stderr, "ERROR: --headless requires building with \"cmake -DHEADLESS=ON\".\n");
+    std::exit(EXIT_FAILURE);
+}
+
+#endif // HEADLESS
+
+bool isHeadless() {
+    return g_Headless;
+}
+
+double getTime() {
+    if ( !g_Headless )
+        return glfwGetTime();
+
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - g_HeadlessStart;
+    return seconds.count();
+}
+
+void getWindowSize(GLFWwindow* window, int* width, int* height) {
+    if ( !g_Headless )
+    {
+        glfwGetWindowSize(window, width, height);
+        return;
+    }
+
+    *width = g_HeadlessWidth;
+    *height = g_HeadlessHeight;
+}
+
+void getFramebufferSize(GLFWwindow* window, int* width, int* height) {
+    if ( !g_Headless )
+    {
+        glfwGetFramebufferSize(window, width, height);
+        return;
+    }
+
+    *width = g_HeadlessWidth;
+    *height = g_HeadlessHeight;
+}
+
+bool windowShouldClose(GLFWwindow* window) {
+    if ( !g_Headless )
+        return glfwWindowShouldClose(window);
+    return g_HeadlessShouldClose;
+}
+
+void setWindowShouldClose(GLFWwindow* window) {
+    if ( !g_Headless )
+        glfwSetWindowShouldClose(window, GL_TRUE);
+    else
+        g_HeadlessShouldClose = true;
+}
+
+void swapBuffers(GLFWwindow* window) {
+    // Não há o que mostrar; esperamos o fim da renderização para que o tempo
+    // de cada quadro inclua o trabalho da GPU (ou do llvmpipe), como acontece
+    // quando a troca de buffers espera a GPU.
+    if ( g_Headless )
+        glFinish();
+    else
+        glfwSwapBuffers(window);
+}
+
+void pollEvents() {
+    if ( !g_Headless )
+        glfwPollEvents();
+}
+
+void terminateWindow() {
+#ifdef HEADLESS
+    if ( g_Headless )
+    {
+        glDeleteFramebuffers(1, &g_HeadlessFramebuffer);
+        glDeleteRenderbuffers(1, &g_HeadlessColorBuffer);
+        glDeleteRenderbuffers(1, &g_HeadlessDepthBuffer);
+
+        eglMakeCurrent(g_EglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(g_EglDisplay, g_EglContext);
+        eglTerminate(g_EglDisplay);
+        return;
+    }
+#endif
+    glfwTerminate();
+}